@@ -6,165 +6,765 @@
  */
 
 #include "benchMarker.hpp"
-#include <fstream>
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <climits>
 #include <random>
 #include <string>
 #include <stdexcept>
 #include <vector>
-#include <cstdio>
 #include <iostream>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <iterator>
+#include <numeric>
+#include <optional>
+#include <type_traits>
 #include "performance-analyzer/performance-analyzer.hpp"
+#include "perfCounters.hpp"
+#include "numaTopology.hpp"
+#include "searchFunctions/threadPool.hpp"
 
-BenchMarker::BenchMarker(std::vector<std::function<int(std::string&, std::string&)>>& singleReturn,
-                std::vector<std::function<std::vector<int>(std::string&, std::string&)>>& multiReturn,
+namespace {
+
+/*
+ * result of a sink function as seen by runFunctions(): the buffer it wrote into,
+ * compared by content so the check does not copy the occurrences
+ */
+struct SinkResult {
+    const std::vector<MatchOffset>* buffer = nullptr;
+
+    bool operator==(const SinkResult& other) const {
+        return buffer && other.buffer ? *buffer == *other.buffer : buffer == other.buffer;
+    }
+};
+
+/*
+ * restores the calling thread's CPU affinity when it goes out of scope
+ */
+class AffinityGuard {
+public:
+    AffinityGuard() : m_cpus(ThreadPool::currentAffinity()) {}
+    ~AffinityGuard() { ThreadPool::pinCurrentThread(m_cpus); }
+
+    AffinityGuard(const AffinityGuard&) = delete;
+    AffinityGuard& operator=(const AffinityGuard&) = delete;
+
+private:
+    std::vector<unsigned> m_cpus;
+};
+
+// share of random positions matching the needle above which the approximate test is skipped
+constexpr double maxRandomHitDensity = 1e-4;
+
+/**
+ * @brief Estimates the share of positions of `data` that match `needle` with at most `maxMismatches` mismatches by chance.
+ *
+ * Needle byte j matches a text byte with the frequency of needle[j] in a sample of
+ * `data`. Treating the bytes as independent, the distribution of the mismatch count up
+ * to `maxMismatches` is built one needle byte at a time. Edit-distance matches are
+ * somewhat more frequent than this Hamming estimate.
+ */
+double randomHitDensity(std::string_view data, std::string_view needle, int maxMismatches) {
+    std::string_view sample = data.substr(0, std::size_t(1) << 20);
+    if (sample.empty()) {
+        return 0;
+    }
+    std::array<double, 256> frequency {};
+    for (unsigned char c: sample) {
+        frequency[c]++;
+    }
+
+    // mismatches[i]: probability of exactly i mismatches in the needle bytes so far
+    std::vector<double> mismatches(maxMismatches + 1, 0.0);
+    mismatches[0] = 1;
+    for (unsigned char c: needle) {
+        double match = frequency[c] / sample.size();
+        for (int i = maxMismatches; i > 0; i--) {
+            mismatches[i] = mismatches[i] * match + mismatches[i - 1] * (1 - match);
+        }
+        mismatches[0] *= match;
+    }
+    return std::accumulate(mismatches.begin(), mismatches.end(), 0.0);
+}
+
+} // namespace
+
+BenchMarker::BenchMarker(std::vector<SingleReturnFunction>& singleReturn,
+                std::vector<MultiReturnFunction>& multiReturn,
                 std::vector<unsigned int> testSizes)
-:m_singleReturnVec(singleReturn), m_multiReturnVec(multiReturn), m_testSizes(testSizes), m_testDataFileName("testData.txt"){};
+:m_singleReturnVec(singleReturn), m_multiReturnVec(multiReturn), m_testSizes(testSizes), m_testDataFileName("testData.txt"),
+ m_distribution(ByteDistribution::Uniform), m_alphabetSize(95), m_seed(0), m_hasMatrix(false),
+ m_warmupIterations(1), m_measuredIterations(5),
+ m_maxDistance(0), m_mutatedCopies(0), m_indexBenchmark(false), m_maxIndexSizeMB(0),
+ m_perfCounters(false), m_scalingSizeMB(0), m_streamArrayBytes(0){};
+
+/**
+ * @brief Sets how often every function is run per input.
+ *
+ * @param warmupIterations Unmeasured runs per function and input.
+ * @param measuredIterations Measured runs per function and input.
+ *
+ * @throws std::invalid_argument if `measuredIterations` is 0.
+ */
+void BenchMarker::setIterations(unsigned int warmupIterations, unsigned int measuredIterations) {
+    if (measuredIterations == 0) {
+        throw std::invalid_argument("At least one measured iteration is required.");
+    }
+    m_warmupIterations = warmupIterations;
+    m_measuredIterations = measuredIterations;
+}
+
+/**
+ * @brief Enables the count-only test.
+ *
+ * @param count Functions returning the number of occurrences given a string and a substring.
+ */
+void BenchMarker::setCountFunctions(std::vector<CountFunction>& count) {
+    m_countVec = count;
+}
+
+/**
+ * @brief Enables the result-sink test.
+ *
+ * @param sink Functions writing the occurrences into a VectorSink given a string and a substring.
+ */
+void BenchMarker::setSinkFunctions(std::vector<SinkFunction>& sink) {
+    m_sinkVec = sink;
+}
+
+/**
+ * @brief Enables the multi-pattern sweep.
+ *
+ * @param multiPattern Vector of functions that return (pattern id, offset) pairs given a string and a pattern set.
+ * @param patternCounts Numbers of patterns to sweep.
+ */
+void BenchMarker::setMultiPatternFunctions(std::vector<MultiPatternFunction>& multiPattern,
+                                           std::vector<unsigned int> patternCounts) {
+    m_multiPatternVec = multiPattern;
+    m_patternCounts = patternCounts;
+}
+
+/**
+ * @brief Enables the approximate-matching test.
+ *
+ * @param hamming Functions returning (offset, mismatches) pairs, summary group "hamming".
+ * @param edit Functions returning (offset, edits) pairs, summary group "edit".
+ * @param maxDistance Largest distance searched for and planted; must be below the needle length.
+ * @param mutatedCopies Number of copies planted per kind of mutation.
+ */
+void BenchMarker::setApproximateFunctions(std::vector<ApproximateFunction>& hamming,
+                                          std::vector<ApproximateFunction>& edit,
+                                          int maxDistance, unsigned int mutatedCopies) {
+    m_hammingVec = hamming;
+    m_editVec = edit;
+    m_maxDistance = maxDistance;
+    m_mutatedCopies = mutatedCopies;
+}
+
+/**
+ * @brief Enables the FM-index mode.
+ *
+ * @param options Sampling rates of the index.
+ * @param maxFileSizeMB Largest test size to index; building takes about 9 bytes of memory per text byte.
+ */
+void BenchMarker::setIndexBenchmark(const FmIndexOptions& options, unsigned int maxFileSizeMB) {
+    m_indexBenchmark = true;
+    m_indexOptions = options;
+    m_maxIndexSizeMB = maxFileSizeMB;
+}
+
+/**
+ * @brief Enables the core-scaling sweep.
+ *
+ * @param functions Find-all functions running on ThreadPool::Get(), e.g. parallelFindAll.
+ * @param threadCounts Thread counts to sweep; 1 is added as the efficiency baseline and
+ *                     each node's CPU count is always swept.
+ * @param sizeMB Test size the sweep runs on; it only runs if this is one of the test sizes.
+ * @param streamArrayBytes Size of each STREAM array, several times the last-level cache.
+ */
+void BenchMarker::setScalingSweep(std::vector<MultiReturnFunction>& functions, std::vector<unsigned int> threadCounts,
+                                  unsigned int sizeMB, std::size_t streamArrayBytes) {
+    threadCounts.push_back(1);
+    std::erase(threadCounts, 0u);
+    std::sort(threadCounts.begin(), threadCounts.end());
+    threadCounts.erase(std::unique(threadCounts.begin(), threadCounts.end()), threadCounts.end());
 
-BenchMarker::~BenchMarker() {
-    std::remove(m_testDataFileName.c_str()); // delete file
- 
-    if (std::ifstream{m_testDataFileName}) // uses operator! of temporary stream object
-    {
-        std::cerr << "Error deleted file test file" << std::endl;
+    m_scalingVec = functions;
+    m_scalingThreadCounts = threadCounts;
+    m_scalingSizeMB = sizeMB;
+    m_streamArrayBytes = streamArrayBytes;
+}
+
+/**
+ * @brief Sets the shape of the generated test data.
+ *
+ * @param distribution Byte distribution of the corpus.
+ * @param alphabetSize Number of symbols used by ByteDistribution::Uniform.
+ * @param seed Seed of the generator.
+ */
+void BenchMarker::setCorpusShape(ByteDistribution distribution, unsigned int alphabetSize, std::uint64_t seed) {
+    m_distribution = distribution;
+    m_alphabetSize = alphabetSize;
+    m_seed = seed;
+}
+
+/**
+ * @brief Replaces the fixed test needle with a matrix of benchmark cases.
+ *
+ * @param matrix Axes of the benchmark.
+ *
+ * @throws std::invalid_argument if a case plants more needle bytes than its corpus holds.
+ */
+void BenchMarker::setMatrix(const BenchmarkMatrix& matrix) {
+    m_matrix = matrix;
+    m_hasMatrix = true;
+    // expand once, so an infeasible case fails here rather than halfway through the run
+    benchmarkCases();
+}
+
+/**
+ * @brief Returns the cases runBenchmark() runs: the matrix, or one per test size without one.
+ *
+ * @throws std::invalid_argument if a case plants more needle bytes than its corpus holds.
+ */
+std::vector<BenchmarkCase> BenchMarker::benchmarkCases() const {
+    AlphabetSpec shape{m_distribution, m_alphabetSize};
+    if (!m_hasMatrix) {
+        std::vector<BenchmarkCase> cases;
+        for (auto size: m_testSizes) {
+            cases.push_back({size, shape, "akdl;jfksjft", 10, std::to_string(size) + "MB"});
+        }
+        return cases;
+    }
+
+    BenchmarkMatrix matrix = m_matrix;
+    if (matrix.sizesMB.empty()) {
+        matrix.sizesMB = m_testSizes;
+    }
+    if (matrix.alphabets.empty()) {
+        matrix.alphabets = {shape};
+    }
+    if (matrix.needleLengths.empty()) {
+        matrix.needleLengths = {12};
+    }
+    if (matrix.densities.empty()) {
+        matrix.densities = {1};
     }
+    return matrix.cases(m_seed);
+}
+
+/**
+ * @brief Enables the hardware counter mode.
+ *
+ * @param enabled Whether to collect counters.
+ */
+void BenchMarker::setPerfCounters(bool enabled) {
+    m_perfCounters = enabled;
 }
 
 /**
  * @brief Runs the benchmark tests.
  *
- * For each file size specified in m_testSizes, this function generates a test file with random data
- * and inserted substring occurrences, loads the file content, and then runs the functions in both
- * m_singleReturnVec and m_multiReturnVec while profiling their performance.
- * The profiling results are written to a JSON file named using the provided prefix and file size.
+ * For each benchmark case (one per test size unless a matrix is set), this function generates (or reuses
+ * a cached) test file with random data and inserted substring occurrences, memory-maps the file, and then
+ * runs the functions in both m_singleReturnVec and m_multiReturnVec while profiling their performance.
+ * The profiling results are written to `<outputFilePrefix>_<case>.json`, and every record of the case is
+ * tagged with it. The approximate test is skipped for needles no longer than its distance.
+ * Per-function statistics (min, median, p90, p99, stddev, CV and GB/s) of all cases are written
+ * to `<outputFilePrefix>_summary.json` and `<outputFilePrefix>_summary.csv`.
  *
  * @param outputFilePrefix Prefix for the output JSON file containing benchmark results.
- * @param testDataFileName Name of the file used for test data generation and reading.
+ * @param testDataFileName Prefix of the cached test data files.
  * @return true if the benchmark completes successfully.
  */
 bool BenchMarker::runBenchmark(std::string& outputFilePrefix, std::string& testDataFileName) {
     m_testDataFileName = testDataFileName;    
+    m_records.clear();
 
-    std::string substring = "akdl;jfksjft";
-    for(auto size: m_testSizes) {
-        std::cout << "Running test with file size: " << size << "MB" << std::endl;
-        generateFile(size, substring, 10);
+    std::vector<BenchmarkCase> cases = benchmarkCases();
+    for (std::size_t c = 0; c < cases.size(); c++) {
+        const BenchmarkCase& benchCase = cases[c];
+        std::string substring = benchCase.needle;
+        auto size = benchCase.sizeMB;
+        // the needle-independent sweeps run once per size
+        bool firstOfSize = c == 0 || cases[c - 1].sizeMB != size;
 
-        std::string data = loadStringFromFile(m_testDataFileName);
+        std::cout << "Running test case: " << benchCase.name << std::endl;
+        std::string dataPath = generateFile(benchCase);
+        MappedFile data(dataPath);
 
-        std::string outputFileName = outputFilePrefix + "_" + std::to_string(size);
-        outputFileName += "MB.json";
+        std::string outputFileName = outputFilePrefix + "_" + benchCase.name + ".json";
 
         Profiler::Get().BeginSession("BenchMarker", outputFileName);
+        if (m_perfCounters) {
+            std::string countersFileName = outputFileName;
+            countersFileName.replace(countersFileName.size() - 5, 5, ".counters.json");
+            PerfCounters::Get().beginSession(countersFileName);
+        }
 
-        runFunctions(m_singleReturnVec, data, substring);
-        runFunctions(m_multiReturnVec, data, substring);
+        std::size_t firstRecord = m_records.size();
+        runFunctions(m_singleReturnVec, data.view(), substring, "single");
+        runFunctions(m_multiReturnVec, data.view(), substring, "multi");
+        runFunctions(m_countVec, data.view(), substring, "count");
+        runSinkTest(data.view(), substring);
+        if (m_indexBenchmark && size <= m_maxIndexSizeMB) {
+            runIndexBenchmark(data.view(), dataPath, substring);
+        }
+        if (firstOfSize) {
+            runMultiPatternSweep(data);
+        }
+        runApproximateTest(data, substring);
+        if (!m_scalingVec.empty() && size == m_scalingSizeMB && firstOfSize) {
+            runScalingSweep(data.view(), substring);
+        }
 
+        PerfCounters::Get().endSession();
         Profiler::Get().EndSession();
+
+        for (std::size_t i = firstRecord; i < m_records.size(); i++) {
+            m_records[i].caseName = benchCase.name;
+            m_records[i].alphabet = benchCase.alphabet.name();
+            m_records[i].needleLength = substring.size();
+            m_records[i].occurrences = benchCase.occurrences;
+        }
         
-        std::cout << "Finished test with file size: " << size << "MB\n";
+        std::cout << "Finished test case: " << benchCase.name << "\n";
+        writeSummaryTable({m_records.begin() + firstRecord, m_records.end()}, std::cout);
         std::cout << "Results from test outputed into " << outputFileName << "\n" << std::endl; 
     }
 
+    writeSummaryJson(m_records, outputFilePrefix + "_summary.json");
+    writeSummaryCsv(m_records, outputFilePrefix + "_summary.csv");
+    std::cout << "Summary outputed into " << outputFilePrefix << "_summary.json and .csv" << std::endl;
+
     return true;
 }
 
 
 /**
- * @brief Loads the entire content of a file into a string.
+ * @brief Generates a test file with random data and specific substring occurrences.
+ *
+ * Builds a CorpusSpec from the case and the configured seed and hands it to
+ * CorpusGenerator::getOrGenerate(), so a file generated by an earlier run with the
+ * same parameters is reused instead of being generated again.
  *
- * Opens the specified file in text mode, reads its entire content, and returns it as a std::string.
+ * @param benchCase Size, alphabet, needle and occurrence count of the file.
+ * @return The path of the generated or cached file.
  *
- * @param fileName Name of the file to read.
- * @return A std::string containing the contents of the file.
+ * @throws std::invalid_argument if the substring is empty or if the file size is insufficient to contain the specified number of substring occurrences.
+ * @throws std::runtime_error if the file cannot be opened for writing.
  */
-std::string BenchMarker::loadStringFromFile(std::string& fileName) {
-    std::ifstream t(fileName);
-    std::stringstream buffer;
-    buffer << t.rdbuf();
-    return (buffer.str());
+std::string BenchMarker::generateFile(const BenchmarkCase& benchCase) {
+    CorpusSpec spec;
+    // Convert file size from MB to bytes
+    spec.sizeBytes = std::uint64_t(benchCase.sizeMB) * 1024 * 1024;
+    spec.distribution = benchCase.alphabet.distribution;
+    spec.alphabetSize = benchCase.alphabet.alphabetSize;
+    spec.seed = m_seed;
+    spec.needle = benchCase.needle;
+    spec.occurrences = benchCase.occurrences;
+
+    return CorpusGenerator::getOrGenerate(spec, m_testDataFileName);
 }
 
+/**
+ * @brief Runs the multi-pattern functions for every configured pattern count.
+ *
+ * Generates `count` random printable patterns of 8 to 16 bytes, plants each one once
+ * in `data`, and runs m_multiPatternVec through runFunctions(). The patterns are drawn
+ * from a fixed seed, so every file size sees the same pattern sets.
+ *
+ * @param data The mapped test data; patterns are written into its copy-on-write pages.
+ */
+void BenchMarker::runMultiPatternSweep(MappedFile& data) {
+    if (m_multiPatternVec.empty()) {
+        return;
+    }
+
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> charDist(32, 126);
+    std::uniform_int_distribution<std::size_t> lengthDist(8, 16);
+
+    for (auto count: m_patternCounts) {
+        std::vector<std::string> patterns(count);
+        for (auto& pattern: patterns) {
+            pattern.resize(lengthDist(gen));
+            for (auto& c: pattern) {
+                c = static_cast<char>(charDist(gen));
+            }
+            if (pattern.size() <= data.size()) {
+                std::uniform_int_distribution<std::size_t> positionDist(0, data.size() - pattern.size());
+                std::copy(pattern.begin(), pattern.end(), data.data() + positionDist(gen));
+            }
+        }
+
+        std::cout << "Running multi-pattern test with " << count << " patterns" << std::endl;
+        std::string scopeName = "Patterns: " + std::to_string(count);
+        PROFILE_SCOPE(scopeName.c_str());
+        runFunctions(m_multiPatternVec, data.view(), patterns, "patterns:" + std::to_string(count));
+    }
+}
 
 /**
- * @brief Generates a test file with random data and specific substring occurrences.
+ * @brief Runs the sink functions through runFunctions(), each into a buffer of its own.
  *
- * Generates a file with the specified size (in MB) filled with random printable ASCII characters.
- * Inserts a given substring a specified number of times at random positions within the file.
- * The resulting content is written to the file specified by m_testDataFileName.
+ * The buffers live for the whole test and are only cleared between calls, so the
+ * timed calls measure the search and the writes into already reserved memory.
  *
- * @param fileSizeMB Size of the file to generate in megabytes.
- * @param substring The substring to insert into the file.
- * @param occurrences The number of times the substring should appear in the file.
- * @return true if the file is generated and written successfully.
+ * @param data The test data.
+ * @param substring The needle to search for.
  *
- * @throws std::invalid_argument if the substring is empty or if the file size is insufficient to contain the specified number of substring occurrences.
- * @throws std::runtime_error if the file cannot be opened for writing.
+ * @throws std::runtime_error if a function's occurrences differ from the first one's.
  */
-bool BenchMarker::generateFile(unsigned int fileSizeMB, std::string& substring, unsigned int occurrences) {
-    // Convert file size from MB to bytes
-    unsigned int fileSize = fileSizeMB * 1024 * 1024;
+void BenchMarker::runSinkTest(std::string_view data, std::string& substring) {
+    if (m_sinkVec.empty()) {
+        return;
+    }
+
+    std::vector<std::vector<MatchOffset>> buffers(m_sinkVec.size());
+    std::vector<BenchmarkFunction<SinkResult(std::string_view, std::string_view)>> bound;
+    for (size_t i = 0; i < m_sinkVec.size(); ++i) {
+        bound.push_back({m_sinkVec[i].name, [&function = m_sinkVec[i], &buffer = buffers[i]](std::string_view str, std::string_view pattern) {
+            buffer.clear();
+            VectorSink sink(buffer);
+            function.function(str, pattern, sink);
+            return SinkResult{&buffer};
+        }, m_sinkVec[i].offloaded});
+    }
+
+    runFunctions(bound, data, substring, "sink");
+}
+
+/**
+ * @brief Runs the core-scaling sweep over every NUMA node and thread count.
+ *
+ * Each node runs the thread counts below its CPU count and then all of its CPUs. The
+ * pinned pools are created per thread count and installed with ScopedThreadPool, so the
+ * functions run unchanged; the calling thread's affinity is restored at the end.
+ *
+ * @param data The test data; it is copied onto each node.
+ * @param substring The needle to search for.
+ *
+ * @throws std::runtime_error if a function disagrees with the first one.
+ */
+void BenchMarker::runScalingSweep(std::string_view data, std::string& substring) {
+    PROFILE_SCOPE("Scaling Sweep");
+    AffinityGuard affinity;
+    std::vector<NumaNode> nodes = numaNodes();
+    std::cout << "Running scaling sweep on " << nodes.size()
+              << (numaAvailable() ? " NUMA node(s)" : " node (no NUMA support)") << std::endl;
+
+    for (const NumaNode& node: nodes) {
+        std::string nodeName = node.id >= 0 ? "node " + std::to_string(node.id) : "all CPUs";
+
+        // copied by threads of the node, so the first touch places the pages there
+        NodeBuffer corpus(data.size(), node);
+        {
+            ThreadPool nodePool(node.cpus);
+            ThreadPool::pinCurrentThread({node.cpus.front()});
+            const std::size_t chunk = 4 * 1024 * 1024;
+            nodePool.parallelFor((data.size() + chunk - 1) / chunk, [&](std::size_t i) {
+                std::size_t begin = i * chunk;
+                std::copy_n(data.data() + begin, std::min(chunk, data.size() - begin), corpus.data() + begin);
+            });
+        }
+        std::string_view local(corpus.data(), data.size());
+
+        // median seconds of each function on one thread, the efficiency baseline
+        std::vector<double> baseline(m_scalingVec.size(), 0);
+        std::vector<unsigned int> threadCounts;
+        std::copy_if(m_scalingThreadCounts.begin(), m_scalingThreadCounts.end(), std::back_inserter(threadCounts),
+                     [&](unsigned int threads) { return threads < node.cpus.size(); });
+        threadCounts.push_back(node.cpus.size());
+        for (unsigned int threads: threadCounts) {
+            std::vector<unsigned> cpus(node.cpus.begin(), node.cpus.begin() + threads);
+            ThreadPool pool(cpus);
+            ScopedThreadPool scope(pool);
+            ThreadPool::pinCurrentThread({cpus.front()});
+
+            double streamGBs = streamTriadGBs(pool, node, m_streamArrayBytes / sizeof(double), 5);
+            std::cout << nodeName << ", " << threads << " threads: STREAM triad " << streamGBs << " GB/s" << std::endl;
 
-    // checks
-    if (substring.empty()) {
-        throw std::invalid_argument("Substring cannot be empty.");
+            std::size_t first = m_records.size();
+            runFunctions(m_scalingVec, local, substring, "scaling");
+            for (std::size_t i = 0; i < m_scalingVec.size(); i++) {
+                BenchmarkRecord& record = m_records[first + i];
+                record.threads = threads;
+                record.numaNode = node.id;
+                record.streamGBs = streamGBs;
+                if (threads == 1) {
+                    baseline[i] = record.seconds.median;
+                }
+                if (baseline[i] > 0 && record.seconds.median > 0) {
+                    record.parallelEfficiency = baseline[i] / (threads * record.seconds.median);
+                }
+                std::cout << "  " << record.function << ": " << record.throughputGBs() << " GB/s, efficiency "
+                          << record.parallelEfficiency << std::endl;
+            }
+        }
     }
+}
 
-    if (fileSize < substring.size() * occurrences) {
-        throw std::invalid_argument("File size is too small to accommodate all occurrences of the substring.");
+/**
+ * @brief Plants mutated copies of `substring` and runs the approximate functions.
+ *
+ * The copies are drawn from a fixed seed, so every file size sees the same mutations.
+ * Substitutions always change the byte, and inserted or substituted bytes are
+ * printable ASCII like the generated data.
+ *
+ * @param data The mapped test data; copies are written into its copy-on-write pages.
+ * @param substring The needle to mutate and search for.
+ *
+ * @throws std::runtime_error if a planted copy is not found or the backends disagree.
+ */
+void BenchMarker::runApproximateTest(MappedFile& data, std::string& substring) {
+    if ((m_hammingVec.empty() && m_editVec.empty()) || m_mutatedCopies == 0) {
+        return;
     }
 
-    // Prepare a buffer to hold the file content
-    std::string buffer(fileSize, '\0');
+    // otherwise random text matches so often that the groups mostly measure writing out results
+    double density = randomHitDensity(data.view(), substring, m_maxDistance);
+    if (density > maxRandomHitDensity) {
+        std::cout << "Skipping the approximate test: a " << substring.size() << "-byte needle within "
+                  << m_maxDistance << " mutations matches about " << density * 100
+                  << "% of random positions" << std::endl;
+        return;
+    }
 
-    // Random engine and distribution
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    //  printable ASCII characters roughly in the range [32, 126]
-    std::uniform_int_distribution<int> dist(32, 126);
+    std::mt19937 gen(0);
+    std::uniform_int_distribution<int> charDist(32, 126);
+    auto randomIndex = [&](std::size_t size) {
+        return std::uniform_int_distribution<std::size_t>(0, size - 1)(gen);
+    };
+    auto substitute = [&](char c) {
+        char replacement;
+        do {
+            replacement = static_cast<char>(charDist(gen));
+        } while (replacement == c);
+        return replacement;
+    };
 
-    // fill the entire buffer with random characters
-    for (std::size_t i = 0; i < fileSize; ++i) {
-        buffer[i] = static_cast<char>(dist(gen));
+    // every copy gets its own slot of the data, so no copy overwrites another
+    std::size_t slotSize = data.size() / (2 * m_mutatedCopies);
+    if (slotSize < substring.size() + m_maxDistance) {
+        return;
     }
 
-    // insert the substring occurrences at random positions
-    // choose positions such that each substring fits entirely
-    std::uniform_int_distribution<std::size_t> positionDist(0, fileSize - substring.size());
+    // (offset, mutation count) of every planted copy
+    using Planted = std::vector<std::pair<std::size_t, int>>;
+    auto plant = [&](std::size_t firstSlot, bool editsAllowed) {
+        Planted planted;
+        for (unsigned int i = 0; i < m_mutatedCopies; i++) {
+            int mutations = i % (m_maxDistance + 1);
+            std::string copy = substring;
+            for (int e = 0; e < mutations; e++) {
+                int kind = editsAllowed ? std::uniform_int_distribution<int>(0, 2)(gen) : 0;
+                if (kind == 0 || copy.size() <= 1) {
+                    std::size_t position = randomIndex(copy.size());
+                    copy[position] = substitute(copy[position]);
+                } else if (kind == 1) {
+                    copy.insert(copy.begin() + randomIndex(copy.size() + 1), static_cast<char>(charDist(gen)));
+                } else {
+                    copy.erase(copy.begin() + randomIndex(copy.size()));
+                }
+            }
+            std::size_t offset = (firstSlot + i) * slotSize + randomIndex(slotSize - copy.size() + 1);
+            std::copy(copy.begin(), copy.end(), data.data() + offset);
+            planted.emplace_back(offset, mutations);
+        }
+        return planted;
+    };
+    Planted substituted = plant(0, false);
+    Planted edited = plant(m_mutatedCopies, true);
+
+    auto run = [&](const std::vector<ApproximateFunction>& functions, const Planted& planted,
+                   std::size_t slack, const std::string& group) {
+        if (functions.empty()) {
+            return;
+        }
 
-    for (std::size_t i = 0; i < occurrences; ++i) {
-        std::size_t pos = positionDist(gen);
-        // Copy substring into the buffer
-        for (std::size_t j = 0; j < substring.size(); ++j) {
-            buffer[pos + j] = substring[j];
+        std::vector<BenchmarkFunction<std::vector<ApproximateMatch>(std::string_view, std::string_view)>> bound;
+        for (const auto& function: functions) {
+            bound.push_back({function.name, [&function, this](std::string_view str, std::string_view pattern) {
+                return function.function(str, pattern, m_maxDistance);
+            }, function.offloaded});
         }
-    }
 
-    // write the buffer to the specified file
-    std::ofstream outFile(m_testDataFileName, std::ios::binary);
-    if (!outFile) {
-        throw std::runtime_error("Failed to open file: " + m_testDataFileName);
+        std::vector<ApproximateMatch> matches = bound.front().function(data.view(), substring);
+        for (const auto& [offset, mutations]: planted) {
+            auto first = std::lower_bound(matches.begin(), matches.end(),
+                                          ApproximateMatch{static_cast<int>(offset > slack ? offset - slack : 0), 0});
+            auto last = std::upper_bound(first, matches.end(),
+                                         ApproximateMatch{static_cast<int>(offset + slack), INT_MAX});
+            bool found = std::any_of(first, last, [mutations](const ApproximateMatch& match) {
+                return match.distance <= mutations;
+            });
+            if (!found) {
+                throw std::runtime_error(bound.front().name + " missed the copy with " + std::to_string(mutations) +
+                                         " mutations planted at offset " + std::to_string(offset));
+            }
+        }
+
+        std::cout << "Running " << group << " test with " << m_maxDistance << " mutations, "
+                  << matches.size() << " matches" << std::endl;
+        std::string scopeName = "Approximate: " + group;
+        PROFILE_SCOPE(scopeName.c_str());
+        runFunctions(bound, data.view(), substring, group);
+    };
+
+    run(m_hammingVec, substituted, 0, "hamming");
+    run(m_editVec, edited, 2 * m_maxDistance, "edit");
+}
+
+/**
+ * @brief Builds, saves and reloads an FM-index of `data` and times queries for `substring`.
+ *
+ * Runs before the multi-pattern sweep, which plants patterns into the mapped data.
+ *
+ * @param data The test data.
+ * @param dataPath Path of the test data; the index is written to `dataPath + ".fmi"` and removed afterwards.
+ * @param substring The needle to query.
+ *
+ * @throws std::runtime_error if locate() disagrees with the first multi-return function.
+ */
+void BenchMarker::runIndexBenchmark(std::string_view data, const std::string& dataPath, std::string& substring) {
+    PROFILE_SCOPE("FM-index");
+    auto seconds = [](auto start, auto stop) {
+        return std::chrono::duration<double>(stop - start).count();
+    };
+    auto addRecord = [&](const std::string& function, unsigned int warmup, std::vector<double> samples) {
+        BenchmarkRecord record;
+        record.group = "index";
+        record.function = function;
+        record.sizeBytes = data.size();
+        // queries are reported at the throughput of a scan that would give the same answer
+        record.bytesProcessed = data.size();
+        record.warmupIterations = warmup;
+        record.seconds = SampleStats::fromSamples(std::move(samples));
+        m_records.push_back(record);
+        return record.seconds.median;
+    };
+
+    auto start = std::chrono::steady_clock::now();
+    FmIndex built = FmIndex::build(data, m_indexOptions);
+    auto stop = std::chrono::steady_clock::now();
+    double buildSeconds = addRecord("fmIndexBuild", 0, {seconds(start, stop)});
+
+    std::string indexPath = dataPath + ".fmi";
+    built.save(indexPath);
+    start = std::chrono::steady_clock::now();
+    FmIndex index = FmIndex::load(indexPath);
+    stop = std::chrono::steady_clock::now();
+    addRecord("fmIndexLoad", 0, {seconds(start, stop)});
+    std::cout << "FM-index: " << index.sizeBytes() / (1024 * 1024) << "MB, built in " << buildSeconds << "s" << std::endl;
+
+    if (!m_multiReturnVec.empty() && index.locate(substring) != m_multiReturnVec.front().function(data, substring)) {
+        throw std::runtime_error("Inconsistent return value detected for fmIndexLocate");
     }
-    outFile.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
-    outFile.close();
 
-    return true;
+    auto timeQueries = [&](const std::string& function, const auto& query) {
+        for (unsigned int w = 0; w < m_warmupIterations; ++w) {
+            query();
+        }
+        std::vector<double> samples;
+        for (unsigned int m = 0; m < m_measuredIterations; ++m) {
+            auto queryStart = std::chrono::steady_clock::now();
+            query();
+            samples.push_back(seconds(queryStart, std::chrono::steady_clock::now()));
+        }
+        return addRecord(function, m_warmupIterations, std::move(samples));
+    };
+    timeQueries("fmIndexCount", [&] { return index.count(substring); });
+    double locateSeconds = timeQueries("fmIndexLocate", [&] { return index.locate(substring); });
+
+    std::filesystem::remove(indexPath);
+
+    // fastest full scan of this size, from the multi-return group
+    const BenchmarkRecord* fastest = nullptr;
+    for (const auto& record: m_records) {
+        if (record.group == "multi" && record.sizeBytes == data.size() &&
+            (!fastest || record.seconds.median < fastest->seconds.median)) {
+            fastest = &record;
+        }
+    }
+    if (fastest && fastest->seconds.median > locateSeconds) {
+        double breakEven = std::ceil(buildSeconds / (fastest->seconds.median - locateSeconds));
+        std::cout << "FM-index break-even against " << fastest->function << ": " << breakEven << " queries" << std::endl;
+    }
 }
 
-template<typename T>
-void BenchMarker::runFunctions(const std::vector<T>& vec, std::string& data, std::string& substring) {
-    // Assume the return type is std::vector<int>
-    if (!vec.empty()) {
-        // Call the first function and store its return value.
-        auto expected = vec.front()(data, substring);
-        
-        // Iterate through the remaining functions.
-        for (size_t i = 1; i < vec.size(); ++i) {
-            auto result = vec[i](data, substring);
-            if (result != expected) {
-                throw std::runtime_error("Inconsistent return value detected at function index " + std::to_string(i));
+template<typename T, typename Needle>
+void BenchMarker::runFunctions(const std::vector<T>& vec, std::string_view data, Needle& substring, const std::string& group) {
+    // result of the first function, every other function must match it
+    decltype(vec.front().function(data, substring)) expected{};
+
+    for (size_t i = 0; i < vec.size(); ++i) {
+        auto check = [&](const auto& result) {
+            if (i == 0) {
+                expected = result;
+            } else if (result != expected) {
+                throw std::runtime_error("Inconsistent return value detected at function index " + std::to_string(i) + " (" + vec[i].name + ")");
+            }
+        };
+
+        if (m_warmupIterations > 0) {
+            PROFILE_SCOPE("Warmup");
+            for (unsigned int w = 0; w < m_warmupIterations; ++w) {
+                auto result = vec[i].function(data, substring);
+                if (w == 0) {
+                    check(result);
+                }
             }
         }
+
+        // bytes a call has to read, known once `expected` is set
+        auto bytesProcessed = [&]() -> std::uint64_t {
+            if constexpr (std::is_same_v<decltype(expected), int>) {
+                // a first-match search only has to read up to the end of the first occurrence
+                if (group == "single" && expected >= 0) {
+                    return std::min<std::uint64_t>(data.size(), expected + substring.size());
+                }
+            }
+            return data.size();
+        };
+
+        std::vector<double> samples;
+        samples.reserve(m_measuredIterations);
+        std::vector<PerfSample> counterSamples;
+        for (unsigned int m = 0; m < m_measuredIterations; ++m) {
+            // the counters would only see the host side of an offloaded function, so it is not counted
+            std::optional<CounterScope> counters;
+            if (!vec[i].offloaded) {
+                counters.emplace(group + "/" + vec[i].name);
+            }
+            auto start = std::chrono::steady_clock::now();
+            auto result = vec[i].function(data, substring);
+            auto stop = std::chrono::steady_clock::now();
+            if (counters) {
+                counters->stop();
+            }
+            samples.push_back(std::chrono::duration<double>(stop - start).count());
+            if (m == 0 && m_warmupIterations == 0) {
+                check(result);
+            }
+            if (counters) {
+                counters->setBytes(bytesProcessed());
+                if (counters->sample().any()) {
+                    counterSamples.push_back(counters->sample());
+                }
+            }
+        }
+
+        BenchmarkRecord record;
+        record.group = group;
+        record.function = vec[i].name;
+        record.sizeBytes = data.size();
+        record.bytesProcessed = bytesProcessed();
+        record.counters = PerfSample::mean(counterSamples);
+        record.warmupIterations = m_warmupIterations;
+        record.seconds = SampleStats::fromSamples(std::move(samples));
+        m_records.push_back(std::move(record));
     }
 }
-
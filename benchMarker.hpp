@@ -7,92 +7,360 @@
 #ifndef BENCHMARKER_HPP
 #define BENCHMARKER_HPP
 #include <string>
+#include <string_view>
 #include <functional>
 #include <vector>
+#include "benchMatrix.hpp"
+#include "benchStats.hpp"
+#include "corpusGenerator.hpp"
+#include "mappedFile.hpp"
+#include "searchFunctions/approximateFunctions.hpp"
+#include "searchFunctions/fmIndex.hpp"
+#include "searchFunctions/multiPattern.hpp"
+#include "searchFunctions/resultSink.hpp"
+
+/**
+ * @brief A benchmarked function and the name it is reported under in the summary.
+ */
+template<typename Signature>
+struct BenchmarkFunction {
+    std::string name;
+    std::function<Signature> function;
+    // runs part of its work on a device or on driver threads, which hardware counters cannot see
+    bool offloaded = false;
+};
+
+using SingleReturnFunction = BenchmarkFunction<int(std::string_view, std::string_view)>;
+using MultiReturnFunction = BenchmarkFunction<std::vector<int>(std::string_view, std::string_view)>;
+using MultiPatternFunction = BenchmarkFunction<std::vector<PatternMatch>(std::string_view, const std::vector<std::string>&)>;
+using ApproximateFunction = BenchmarkFunction<std::vector<ApproximateMatch>(std::string_view, std::string_view, int)>;
+// returns the number of occurrences, summary group "count"
+using CountFunction = BenchmarkFunction<int(std::string_view, std::string_view)>;
+// writes every occurrence into a caller-owned buffer, summary group "sink"
+using SinkFunction = BenchmarkFunction<void(std::string_view, std::string_view, VectorSink&)>;
 
 class BenchMarker {
 public:
     /**
     * @brief Constructs a BenchMarker instance.
     *
-    * Initializes the BenchMaker with vectors of function objects for single and multiple integer returns,
+    * Initializes the BenchMaker with vectors of named function objects for single and multiple integer returns,
     * a vector of test file sizes (in MB), and sets the default test data file name.
     *
-    * @param singleReturn Vector of functions that return an integer given two strings.
-    * @param multiReturn Vector of functions that return a vector of integers given two strings.
+    * @param singleReturn Vector of functions that return an integer given two string views.
+    * @param multiReturn Vector of functions that return a vector of integers given two string views.
     * @param testSizes Vector of test file sizes (in megabytes) to be used during benchmarking.
     */
-    BenchMarker(std::vector<std::function<int(std::string&, std::string&)>>& singleReturn,
-                std::vector<std::function<std::vector<int>(std::string&, std::string&)>>& multiReturn,
+    BenchMarker(std::vector<SingleReturnFunction>& singleReturn,
+                std::vector<MultiReturnFunction>& multiReturn,
                 std::vector<unsigned int> testSizes);
 
-    ~BenchMarker();
+    /**
+    * @brief Sets how often every function is run per input.
+    *
+    * Each function first runs `warmupIterations` times unmeasured (in a "Warmup" profiler
+    * scope), which absorbs page faults, frequency ramp-up and one-time costs such as
+    * OpenCL program builds. It then runs `measuredIterations` times, each call timed
+    * end to end, host-side input to host-side result, so CPU and device backends are
+    * measured at the same boundary. Defaults to 1 warmup and 5 measured iterations.
+    *
+    * @param warmupIterations Unmeasured runs per function and input.
+    * @param measuredIterations Measured runs per function and input.
+    *
+    * @throws std::invalid_argument if `measuredIterations` is 0.
+    */
+    void setIterations(unsigned int warmupIterations, unsigned int measuredIterations);
+
+    /**
+    * @brief Sets the shape of the generated test data.
+    *
+    * Test data defaults to uniform printable ASCII with seed 0. Since the generated
+    * corpus only depends on these parameters, the file size and the planted substring,
+    * every corpus is cached on disk and reused by later runs.
+    *
+    * @param distribution Byte distribution of the corpus.
+    * @param alphabetSize Number of symbols used by ByteDistribution::Uniform.
+    * @param seed Seed of the generator.
+    */
+    void setCorpusShape(ByteDistribution distribution, unsigned int alphabetSize, std::uint64_t seed);
+
+    /**
+    * @brief Replaces the fixed test needle with a matrix of benchmark cases.
+    *
+    * Without a matrix, runBenchmark() runs one case per test size, with the needle
+    * "akdl;jfksjft" planted 10 times in the configured corpus shape. With one, it runs
+    * the cross-product of the matrix axes; an empty axis falls back to the test sizes,
+    * the corpus shape, a 12-byte needle or a density of 1 occurrence per MB. Needles
+    * are drawn from each case's alphabet with the corpus seed.
+    *
+    * @param matrix Axes of the benchmark.
+    *
+    * @throws std::invalid_argument if a case plants more needle bytes than its corpus holds.
+    */
+    void setMatrix(const BenchmarkMatrix& matrix);
+
+    /**
+    * @brief Enables the count-only test.
+    *
+    * After the multi-return functions, runBenchmark() runs every function in `count`
+    * on the same needle, checked against the first one, in summary group "count".
+    *
+    * @param count Functions returning the number of occurrences given a string and a substring.
+    */
+    void setCountFunctions(std::vector<CountFunction>& count);
+
+    /**
+    * @brief Enables the result-sink test.
+    *
+    * After the count-only test, runBenchmark() runs every function in `sink` on the same
+    * needle in summary group "sink". Each function gets one buffer for the whole run,
+    * cleared before every call, so once it has grown to the result size the measured
+    * calls allocate nothing for their results. Results are checked against the first one.
+    *
+    * @param sink Functions writing the occurrences into a VectorSink given a string and a substring.
+    */
+    void setSinkFunctions(std::vector<SinkFunction>& sink);
+
+    /**
+    * @brief Enables the multi-pattern sweep.
+    *
+    * After the single- and multi-return functions, runBenchmark() runs every function in
+    * `multiPattern` once per entry of `patternCounts`, each time with that many random
+    * patterns planted in the test data. Each run is profiled in a scope named after the
+    * pattern count.
+    *
+    * @param multiPattern Vector of functions that return (pattern id, offset) pairs given a string and a pattern set.
+    * @param patternCounts Numbers of patterns to sweep.
+    */
+    void setMultiPatternFunctions(std::vector<MultiPatternFunction>& multiPattern,
+                                  std::vector<unsigned int> patternCounts);
+
+    /**
+    * @brief Enables the approximate-matching test.
+    *
+    * After the multi-pattern sweep, runBenchmark() plants `mutatedCopies` copies of the
+    * needle with substitutions and as many with substitutions, insertions and deletions,
+    * each copy with up to `maxDistance` mutations. It then runs `hamming` with
+    * `maxDistance` mismatches and `edit` with `maxDistance` edits through runFunctions(),
+    * so every backend is checked against the first one of its group, and checks that the
+    * first one finds every planted copy. The test is skipped, with a note, when the needle
+    * would match more than one random position in 10,000 within `maxDistance`
+    * mismatches, estimated from the byte frequencies of the test data.
+    *
+    * @param hamming Functions returning (offset, mismatches) pairs, summary group "hamming".
+    * @param edit Functions returning (offset, edits) pairs, summary group "edit".
+    * @param maxDistance Largest distance searched for and planted.
+    * @param mutatedCopies Number of copies planted per kind of mutation.
+    */
+    void setApproximateFunctions(std::vector<ApproximateFunction>& hamming,
+                                 std::vector<ApproximateFunction>& edit,
+                                 int maxDistance, unsigned int mutatedCopies);
+
+    /**
+    * @brief Enables the FM-index mode.
+    *
+    * For every test size up to `maxFileSizeMB`, runBenchmark() also builds an FmIndex
+    * over the test data, saves it next to the test data and maps it back, and times
+    * count() and locate() for the needle. Build and load run once; queries run the
+    * configured iterations. The results go to group "index" of the summary, next to
+    * the scans, and the break-even query count is printed: how many queries it takes
+    * for one build plus that many index queries to beat rescanning with the fastest
+    * multi-return function.
+    *
+    * @param options Sampling rates of the index.
+    * @param maxFileSizeMB Largest test size to index; building takes about 9 bytes of memory per text byte.
+    */
+    void setIndexBenchmark(const FmIndexOptions& options, unsigned int maxFileSizeMB);
+
+    /**
+    * @brief Enables the hardware counter mode.
+    *
+    * runBenchmark() then opens a PerfCounters session per test size, written to
+    * `<outputFilePrefix>_<size>MB.counters.json` next to the Profiler trace, and every
+    * measured call of runFunctions() is counted in a CounterScope named
+    * `<group>/<function>`. The per-call means (cycles, instructions, L1D and LLC misses,
+    * branch misses, IPC and bytes per cycle) are added to the summary. Counters cover
+    * the calling thread and every ThreadPool worker. Offloaded functions are not
+    * counted, as most of their work runs where the counters cannot see it, and their
+    * counter columns stay empty. Without perf_event access the run continues untouched.
+    *
+    * @param enabled Whether to collect counters.
+    */
+    void setPerfCounters(bool enabled);
+
+    /**
+    * @brief Enables the core-scaling sweep.
+    *
+    * On the test size `sizeMB`, runBenchmark() copies the test data onto every NUMA node
+    * (first touched by threads of that node, bound with libnuma where available) and,
+    * for every entry of `threadCounts` below the node's CPU count and for that count
+    * itself, runs `functions` on a ThreadPool of that many threads pinned to the node's
+    * first CPUs, installed as ThreadPool::Get() with the calling thread pinned to the
+    * first of them. Before the
+    * functions, a STREAM triad over three arrays of `streamArrayBytes` runs on the same
+    * threads. The records go to group "scaling" with the thread count, the node, the
+    * parallel efficiency T(1) / (n * T(n)) and the STREAM bandwidth, so the summary
+    * shows where a backend stops scaling and how close it gets to the memory wall.
+    * Without NUMA support the machine is swept as one node and the data stays wherever
+    * the first touch puts it.
+    *
+    * @param functions Find-all functions running on ThreadPool::Get(), e.g. parallelFindAll.
+    * @param threadCounts Thread counts to sweep; 1 is added as the efficiency baseline and
+    *                     each node's CPU count is always swept.
+    * @param sizeMB Test size the sweep runs on; it only runs if this is one of the test sizes.
+    * @param streamArrayBytes Size of each STREAM array, several times the last-level cache.
+    */
+    void setScalingSweep(std::vector<MultiReturnFunction>& functions, std::vector<unsigned int> threadCounts,
+                         unsigned int sizeMB, std::size_t streamArrayBytes = 256 * 1024 * 1024);
 
     /**
     * @brief Runs the benchmark tests.
     *
-    * For each file size specified in m_testSizes, this function generates a test file with random data
-    * and inserted substring occurrences, loads the file content, and then runs the functions in both
-    * m_singleReturnVec and m_multiReturnVec while profiling their performance.
-    * The profiling results are written to a JSON file named using the provided prefix and file size.
+    * For each benchmark case (one per test size unless a matrix is set), this function generates (or reuses
+    * a cached) test file with random data and inserted substring occurrences, memory-maps the file, and then
+    * runs the functions in both m_singleReturnVec and m_multiReturnVec while profiling their performance.
+    * The profiling results are written to `<outputFilePrefix>_<case>.json`, e.g. `bench_100MB.json`, and a
+    * table of the case's results is printed. The multi-pattern and scaling sweeps do not depend on the
+    * needle and run on the first case of each size only.
+    * Per-function statistics (min, median, p90, p99, stddev, CV and GB/s) of all cases are written
+    * to `<outputFilePrefix>_summary.json` and `<outputFilePrefix>_summary.csv`.
     *
     * @param outputFilePrefix Prefix for the output JSON file containing benchmark results.
-    * @param testDataFileName Name of the file used for test data generation and reading.
+    * @param testDataFileName Prefix of the cached test data files.
     * @return true if the benchmark completes successfully.
     */
     bool runBenchmark(std::string& outputFilePrefix, std::string& testDataFileName);
 
 private:
     /**
-    * @brief Loads the entire content of a file into a string.
+    * @brief Returns the cases runBenchmark() runs: the matrix, or one per test size without one.
     *
-    * Opens the specified file in text mode, reads its entire content, and returns it as a std::string.
-    *
-    * @param fileName Name of the file to read.
-    * @return A std::string containing the contents of the file.
+    * @throws std::invalid_argument if a case plants more needle bytes than its corpus holds.
     */
-    std::string loadStringFromFile(std::string& fileName);
+    std::vector<BenchmarkCase> benchmarkCases() const;
 
     /**
     * @brief Generates a test file with random data and specific substring occurrences.
     *
-    * Generates a file with the specified size (in MB) filled with random printable ASCII characters.
-    * Inserts a given substring a specified number of times at random positions within the file.
-    * The resulting content is written to the file specified by m_testDataFileName.
+    * Builds a CorpusSpec from the case and the configured seed and hands it to
+    * CorpusGenerator::getOrGenerate(), so a file generated by an earlier run with the
+    * same parameters is reused instead of being generated again.
     *
-    * @param fileSizeMB Size of the file to generate in megabytes.
-    * @param substring The substring to insert into the file.
-    * @param occurrences The number of times the substring should appear in the file.
-    * @return true if the file is generated and written successfully.
+    * @param benchCase Size, alphabet, needle and occurrence count of the file.
+    * @return The path of the generated or cached file.
     *
     * @throws std::invalid_argument if the substring is empty or if the file size is insufficient to contain the specified number of substring occurrences.
     * @throws std::runtime_error if the file cannot be opened for writing.
     */
-    bool generateFile(unsigned int fileSizeMB, std::string& substring, unsigned int occurances); 
+    std::string generateFile(const BenchmarkCase& benchCase);
+
+    /**
+    * @brief Runs the multi-pattern functions for every configured pattern count.
+    *
+    * Generates `count` random printable patterns of 8 to 16 bytes, plants each one once
+    * in `data`, and runs m_multiPatternVec through runFunctions().
+    *
+    * @param data The mapped test data; patterns are written into its copy-on-write pages.
+    */
+    void runMultiPatternSweep(MappedFile& data);
+
+    /**
+    * @brief Runs the sink functions through runFunctions(), each into a buffer of its own.
+    *
+    * @param data The test data.
+    * @param substring The needle to search for.
+    *
+    * @throws std::runtime_error if a function's occurrences differ from the first one's.
+    */
+    void runSinkTest(std::string_view data, std::string& substring);
+
+    /**
+    * @brief Plants mutated copies of `substring` and runs the approximate functions.
+    *
+    * Copy i gets i % (maxDistance + 1) mutations at random positions. The first
+    * function of each group must report a match within the copy's mutation count at
+    * the copy's offset (Hamming) or within 2 * maxDistance bytes of it (edit, where
+    * insertions and deletions can move the best alignment's start).
+    *
+    * @param data The mapped test data; copies are written into its copy-on-write pages.
+    * @param substring The needle to mutate and search for.
+    *
+    * @throws std::runtime_error if a planted copy is not found or the backends disagree.
+    */
+    void runApproximateTest(MappedFile& data, std::string& substring);
+
+    /**
+    * @brief Builds, saves and reloads an FM-index of `data` and times queries for `substring`.
+    *
+    * @param data The test data.
+    * @param dataPath Path of the test data; the index is written to `dataPath + ".fmi"` and removed afterwards.
+    * @param substring The needle to query.
+    *
+    * @throws std::runtime_error if locate() disagrees with the first multi-return function.
+    */
+    void runIndexBenchmark(std::string_view data, const std::string& dataPath, std::string& substring);
+
+    /**
+    * @brief Runs the core-scaling sweep over every NUMA node and thread count.
+    *
+    * @param data The test data; it is copied onto each node.
+    * @param substring The needle to search for.
+    *
+    * @throws std::runtime_error if a function disagrees with the first one.
+    */
+    void runScalingSweep(std::string_view data, std::string& substring);
     
     /**
     * @brief Executes a set of functions with consistent output verification.
     *
-    * This templated function iterates over a vector of functions (which should all take two std::string references as input)
-    * and executes them on the given data and substring. It assumes that each function returns a result comparable with the
-    * result of the first function in the vector. If any subsequent function returns a different result, a std::runtime_error
-    * is thrown indicating inconsistent behavior.
+    * This templated function iterates over a vector of functions (which should all take the data and the needle(s) as input)
+    * and executes them on the given data and substring, m_warmupIterations unmeasured and m_measuredIterations timed times.
+    * It assumes that each function returns a result comparable with the result of the first function in the vector. If any
+    * subsequent function returns a different result, a std::runtime_error is thrown indicating inconsistent behavior.
+    * The timing statistics of every function are appended to m_records. Throughput of single-return functions
+    * only counts the bytes up to the end of the first occurrence, the part of the data they have to read.
     *
-    * @tparam T The type of function in the vector. It must be callable with (std::string&, std::string&) and return a comparable type.
+    * @tparam T The type of function in the vector. Its `function` must be callable with (std::string_view, Needle&) and return a comparable type.
+    * @tparam Needle The needle type, a single std::string or a set of patterns.
     * @param vec The vector of functions to execute.
-    * @param data The input data string to be processed.
-    * @param substring The substring used in processing the data.
+    * @param data The input data to be processed.
+    * @param substring The substring (or patterns) used in processing the data.
+    * @param group Name of the function group in the summary.
     *
     * @throws std::runtime_error if any function returns a result different from the first function's output.
     */
-    template<typename T>
-    void runFunctions(const std::vector<T>& vec, std::string& data, std::string& substring); 
+    template<typename T, typename Needle>
+    void runFunctions(const std::vector<T>& vec, std::string_view data, Needle& substring, const std::string& group);
 
 private:
-    std::vector<std::function<int(std::string&, std::string&)>>& m_singleReturnVec;
-    std::vector<std::function<std::vector<int>(std::string&, std::string&)>>& m_multiReturnVec;
+    std::vector<SingleReturnFunction>& m_singleReturnVec;
+    std::vector<MultiReturnFunction>& m_multiReturnVec;
+    std::vector<CountFunction> m_countVec;
+    std::vector<SinkFunction> m_sinkVec;
+    std::vector<MultiPatternFunction> m_multiPatternVec;
+    std::vector<unsigned int> m_patternCounts;
     std::vector<unsigned int> m_testSizes;
     std::string m_testDataFileName;
+    ByteDistribution m_distribution;
+    unsigned int m_alphabetSize;
+    std::uint64_t m_seed;
+    bool m_hasMatrix;
+    BenchmarkMatrix m_matrix;
+    unsigned int m_warmupIterations;
+    unsigned int m_measuredIterations;
+    std::vector<ApproximateFunction> m_hammingVec;
+    std::vector<ApproximateFunction> m_editVec;
+    int m_maxDistance;
+    unsigned int m_mutatedCopies;
+    bool m_indexBenchmark;
+    FmIndexOptions m_indexOptions;
+    unsigned int m_maxIndexSizeMB;
+    bool m_perfCounters;
+    std::vector<MultiReturnFunction> m_scalingVec;
+    std::vector<unsigned int> m_scalingThreadCounts;
+    unsigned int m_scalingSizeMB;
+    std::size_t m_streamArrayBytes;
+    std::vector<BenchmarkRecord> m_records;
 };
 
 #endif // BENCHMARKER_HPP
@@ -0,0 +1,208 @@
+/**
+ * @file benchMatrix.cpp
+ * @brief Parsing and expansion of the benchmark matrix.
+ */
+
+#include "benchMatrix.hpp"
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+
+std::string trim(const std::string& text) {
+    std::size_t begin = text.find_first_not_of(" \t\r");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    std::size_t end = text.find_last_not_of(" \t\r");
+    return text.substr(begin, end - begin + 1);
+}
+
+// the non-empty, trimmed fields of `text` between `separators`
+std::vector<std::string> split(const std::string& text, const char* separators) {
+    std::vector<std::string> fields;
+    std::size_t begin = 0;
+    while (begin <= text.size()) {
+        std::size_t end = text.find_first_of(separators, begin);
+        if (end == std::string::npos) {
+            end = text.size();
+        }
+        std::string field = trim(text.substr(begin, end - begin));
+        if (!field.empty()) {
+            fields.push_back(field);
+        }
+        begin = end + 1;
+    }
+    return fields;
+}
+
+// parses all of `text` as a number of type T
+template<typename T>
+T parseNumber(const std::string& text, const std::string& axis) {
+    std::istringstream in(text);
+    T value;
+    if (!(in >> value) || !(in >> std::ws).eof()) {
+        throw std::invalid_argument("Invalid value \"" + text + "\" for matrix axis " + axis + ".");
+    }
+    return value;
+}
+
+// shortest decimal form of a density, e.g. "0.5" or "1000"
+std::string formatDensity(double density) {
+    std::ostringstream out;
+    out << density;
+    return out.str();
+}
+
+} // namespace
+
+/**
+ * @brief Parses "uniform" (95 symbols), "uniform:N", "english" or "dna".
+ *
+ * @throws std::invalid_argument if `text` names no alphabet or N is outside [1, 256].
+ */
+AlphabetSpec AlphabetSpec::parse(const std::string& text) {
+    AlphabetSpec alphabet;
+    if (text == "english") {
+        alphabet.distribution = ByteDistribution::English;
+    } else if (text == "dna") {
+        alphabet.distribution = ByteDistribution::Dna;
+    } else if (text.starts_with("uniform:")) {
+        alphabet.alphabetSize = parseNumber<unsigned int>(text.substr(8), "alphabet");
+        if (alphabet.alphabetSize == 0 || alphabet.alphabetSize > 256) {
+            throw std::invalid_argument("Alphabet size must be between 1 and 256.");
+        }
+    } else if (text != "uniform") {
+        throw std::invalid_argument("Unknown alphabet \"" + text + "\", expected uniform[:N], english or dna.");
+    }
+    return alphabet;
+}
+
+/**
+ * @brief Returns the name used in case names and the summary, e.g. "uniform95" or "dna".
+ */
+std::string AlphabetSpec::name() const {
+    switch (distribution) {
+    case ByteDistribution::Uniform: return "uniform" + std::to_string(alphabetSize);
+    case ByteDistribution::English: return "english";
+    case ByteDistribution::Dna: return "dna";
+    }
+    return "unknown";
+}
+
+/**
+ * @brief Parses a matrix spec.
+ *
+ * @throws std::invalid_argument on an unknown axis, a malformed value, a size or needle
+ *         length of 0 or a negative density.
+ */
+BenchmarkMatrix BenchmarkMatrix::parse(const std::string& spec) {
+    // drop comments before splitting, a comment ends at the end of its line
+    std::string text;
+    std::istringstream lines(spec);
+    for (std::string line; std::getline(lines, line);) {
+        text += line.substr(0, line.find('#')) + '\n';
+    }
+
+    BenchmarkMatrix matrix;
+    for (const std::string& entry: split(text, ";\n")) {
+        std::size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Matrix entry \"" + entry + "\" is not of the form axis=values.");
+        }
+        std::string axis = trim(entry.substr(0, equals));
+        std::vector<std::string> values = split(entry.substr(equals + 1), ",");
+
+        for (const std::string& value: values) {
+            if (axis == "size") {
+                unsigned int sizeMB = parseNumber<unsigned int>(value, axis);
+                if (sizeMB == 0) {
+                    throw std::invalid_argument("Sizes must be at least 1 MB.");
+                }
+                matrix.sizesMB.push_back(sizeMB);
+            } else if (axis == "needle") {
+                unsigned int length = parseNumber<unsigned int>(value, axis);
+                if (length == 0) {
+                    throw std::invalid_argument("Needle lengths must be at least 1.");
+                }
+                matrix.needleLengths.push_back(length);
+            } else if (axis == "density") {
+                double density = parseNumber<double>(value, axis);
+                if (!(density >= 0)) {
+                    throw std::invalid_argument("Densities must not be negative.");
+                }
+                matrix.densities.push_back(density);
+            } else if (axis == "alphabet") {
+                matrix.alphabets.push_back(AlphabetSpec::parse(value));
+            } else {
+                throw std::invalid_argument("Unknown matrix axis \"" + axis + "\", expected size, needle, density or alphabet.");
+            }
+        }
+    }
+    return matrix;
+}
+
+/**
+ * @brief Parses the matrix spec in `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be read.
+ * @throws std::invalid_argument if the spec is malformed.
+ */
+BenchmarkMatrix BenchmarkMatrix::load(const std::string& fileName) {
+    std::ifstream in(fileName);
+    if (!in) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+    std::ostringstream spec;
+    spec << in.rdbuf();
+    return parse(spec.str());
+}
+
+/**
+ * @brief Returns the cross-product, ordered by size, alphabet, needle length and density.
+ *
+ * Each case plants round(density * size) needles.
+ *
+ * @param seed Seed of the corpora and needles.
+ *
+ * @throws std::invalid_argument if an axis is empty or a case's needle or planted needles
+ *         do not fit in its corpus.
+ */
+std::vector<BenchmarkCase> BenchmarkMatrix::cases(std::uint64_t seed) const {
+    if (sizesMB.empty() || needleLengths.empty() || densities.empty() || alphabets.empty()) {
+        throw std::invalid_argument("Every axis of the benchmark matrix needs at least one value.");
+    }
+
+    std::vector<BenchmarkCase> cases;
+    for (unsigned int sizeMB: sizesMB) {
+        for (const AlphabetSpec& alphabet: alphabets) {
+            CorpusSpec spec;
+            spec.distribution = alphabet.distribution;
+            spec.alphabetSize = alphabet.alphabetSize;
+            spec.seed = seed;
+
+            for (unsigned int length: needleLengths) {
+                std::string needle = CorpusGenerator::randomNeedle(spec, length);
+                for (double density: densities) {
+                    BenchmarkCase benchCase;
+                    benchCase.sizeMB = sizeMB;
+                    benchCase.alphabet = alphabet;
+                    benchCase.needle = needle;
+                    benchCase.occurrences = std::llround(density * sizeMB);
+                    benchCase.name = std::to_string(sizeMB) + "MB_" + alphabet.name() + "_n" + std::to_string(length) +
+                                     "_d" + formatDensity(density);
+                    if (length > std::uint64_t(sizeMB) * 1024 * 1024) {
+                        throw std::invalid_argument("Case " + benchCase.name + " has a needle longer than the corpus.");
+                    }
+                    if (benchCase.occurrences * length > std::uint64_t(sizeMB) * 1024 * 1024) {
+                        throw std::invalid_argument("Case " + benchCase.name + " plants more needle bytes than the corpus holds.");
+                    }
+                    cases.push_back(std::move(benchCase));
+                }
+            }
+        }
+    }
+    return cases;
+}
@@ -0,0 +1,93 @@
+/*
+ * benchMatrix.hpp declares the benchmark matrix: the axes (corpus size, needle length,
+ * match density, alphabet) BenchMarker sweeps, and the cases of their cross-product.
+ */
+
+#ifndef BENCHMATRIX_HPP
+#define BENCHMATRIX_HPP
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "corpusGenerator.hpp"
+
+/**
+ * @brief Byte distribution and alphabet size of a generated corpus.
+ */
+struct AlphabetSpec {
+    ByteDistribution distribution = ByteDistribution::Uniform;
+    // number of symbols for ByteDistribution::Uniform
+    unsigned int alphabetSize = 95;
+
+    /**
+    * @brief Parses "uniform" (95 symbols), "uniform:N", "english" or "dna".
+    *
+    * @throws std::invalid_argument if `text` names no alphabet or N is outside [1, 256].
+    */
+    static AlphabetSpec parse(const std::string& text);
+
+    /**
+    * @brief Returns the name used in case names and the summary, e.g. "uniform95" or "dna".
+    */
+    std::string name() const;
+};
+
+/**
+ * @brief One combination of the matrix, with its generated needle.
+ */
+struct BenchmarkCase {
+    unsigned int sizeMB = 0;
+    AlphabetSpec alphabet;
+    std::string needle;
+    // planted copies of the needle; the text may match it in more places
+    std::uint64_t occurrences = 0;
+    // names the trace file and the summary rows, e.g. "100MB" or "100MB_dna_n16_d10"
+    std::string name;
+};
+
+/**
+ * @brief Values of every axis of the benchmark; BenchMarker runs their cross-product.
+ *
+ * Parsed from a spec of `axis=value,value,...` entries separated by semicolons or
+ * newlines, with `#` starting a comment, e.g.
+ *
+ *     size=10,100; needle=4,16,64; density=0,1,1000; alphabet=uniform,dna
+ *
+ * `size` is in MB, `needle` in bytes and `density` in planted occurrences per MB.
+ * An axis that is left out keeps the BenchMarker's defaults.
+ */
+struct BenchmarkMatrix {
+    std::vector<unsigned int> sizesMB;
+    std::vector<unsigned int> needleLengths;
+    std::vector<double> densities;
+    std::vector<AlphabetSpec> alphabets;
+
+    /**
+    * @brief Parses a matrix spec.
+    *
+    * @throws std::invalid_argument on an unknown axis, a malformed value, a size or needle
+    *         length of 0 or a negative density.
+    */
+    static BenchmarkMatrix parse(const std::string& spec);
+
+    /**
+    * @brief Parses the matrix spec in `fileName`.
+    *
+    * @throws std::runtime_error if the file cannot be read.
+    * @throws std::invalid_argument if the spec is malformed.
+    */
+    static BenchmarkMatrix load(const std::string& fileName);
+
+    /**
+    * @brief Returns the cross-product, ordered by size, alphabet, needle length and density.
+    *
+    * Needles are drawn with CorpusGenerator::randomNeedle() from their case's alphabet.
+    *
+    * @param seed Seed of the corpora and needles.
+    *
+    * @throws std::invalid_argument if an axis is empty or a case's needle or planted needles
+    *         do not fit in its corpus.
+    */
+    std::vector<BenchmarkCase> cases(std::uint64_t seed) const;
+};
+
+#endif // BENCHMATRIX_HPP
@@ -0,0 +1,255 @@
+/**
+ * @file benchStats.cpp
+ * @brief Implementation of the benchmark statistics and summary writers.
+ */
+
+#include "benchStats.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+// nearest-rank percentile of sorted samples
+double percentile(const std::vector<double>& sorted, double p) {
+    std::size_t rank = static_cast<std::size_t>(std::ceil(p * sorted.size()));
+    return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+std::string csvEscape(const std::string& text) {
+    if (text.find_first_of(",\"") == std::string::npos) {
+        return text;
+    }
+    std::string escaped = "\"";
+    for (char c: text) {
+        if (c == '"') {
+            escaped += '"';
+        }
+        escaped += c;
+    }
+    return escaped + "\"";
+}
+
+// counter columns of a record, empty where counter mode was off or the event was not exposed
+std::vector<std::pair<std::string, std::optional<double>>> counterFields(const BenchmarkRecord& record) {
+    std::vector<std::pair<std::string, std::optional<double>>> fields;
+    const PerfSample& counters = record.counters;
+    for (std::size_t e = 0; e < PerfSample::EventCount; e++) {
+        auto event = static_cast<PerfSample::Event>(e);
+        fields.emplace_back(PerfSample::name(event),
+                            counters.valid[e] ? std::optional<double>(counters.values[e]) : std::nullopt);
+    }
+    bool ipc = counters.valid[PerfSample::Cycles] && counters.valid[PerfSample::Instructions];
+    fields.emplace_back("ipc", ipc ? std::optional<double>(counters.ipc()) : std::nullopt);
+    fields.emplace_back("bytesPerCycle", counters.valid[PerfSample::Cycles]
+                                             ? std::optional<double>(counters.bytesPerCycle(record.bytesProcessed))
+                                             : std::nullopt);
+    return fields;
+}
+
+// scaling columns of a record, empty outside the scaling sweep
+std::vector<std::pair<std::string, std::optional<double>>> scalingFields(const BenchmarkRecord& record) {
+    bool scaling = record.threads > 0;
+    auto field = [](bool valid, double value) { return valid ? std::optional<double>(value) : std::nullopt; };
+    return {
+        {"threads", field(scaling, record.threads)},
+        {"numaNode", field(scaling && record.numaNode >= 0, record.numaNode)},
+        {"parallelEfficiency", field(scaling && record.parallelEfficiency > 0, record.parallelEfficiency)},
+        {"streamGBs", field(scaling && record.streamGBs > 0, record.streamGBs)},
+        // share of the STREAM bandwidth the search reached; a read-only scan can exceed 1
+        {"streamFraction", field(scaling && record.streamGBs > 0, record.throughputGBs() / record.streamGBs)}
+    };
+}
+
+// every optional column of a record
+std::vector<std::pair<std::string, std::optional<double>>> optionalFields(const BenchmarkRecord& record) {
+    std::vector<std::pair<std::string, std::optional<double>>> fields = counterFields(record);
+    for (auto& field: scalingFields(record)) {
+        fields.push_back(std::move(field));
+    }
+    return fields;
+}
+
+} // namespace
+
+/**
+ * @brief Computes the statistics of `samples`.
+ *
+ * @param samples Timing samples in seconds.
+ * @return The statistics, all zero if `samples` is empty.
+ */
+SampleStats SampleStats::fromSamples(std::vector<double> samples) {
+    SampleStats stats;
+    if (samples.empty()) {
+        return stats;
+    }
+
+    std::sort(samples.begin(), samples.end());
+    std::size_t n = samples.size();
+
+    stats.count = n;
+    stats.min = samples.front();
+    stats.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats.p90 = percentile(samples, 0.90);
+    stats.p99 = percentile(samples, 0.99);
+    stats.mean = std::accumulate(samples.begin(), samples.end(), 0.0) / n;
+
+    if (n > 1) {
+        double squares = 0;
+        for (double sample: samples) {
+            squares += (sample - stats.mean) * (sample - stats.mean);
+        }
+        stats.stddev = std::sqrt(squares / (n - 1));
+    }
+    stats.cv = stats.mean > 0 ? stats.stddev / stats.mean : 0;
+
+    return stats;
+}
+
+/**
+ * @brief Returns bytesProcessed over the median iteration in GB/s (10^9 bytes per second).
+ */
+double BenchmarkRecord::throughputGBs() const {
+    return seconds.median > 0 ? bytesProcessed / seconds.median / 1e9 : 0;
+}
+
+/**
+ * @brief Writes `records` as a JSON array of objects to `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeSummaryJson(const std::vector<BenchmarkRecord>& records, const std::string& fileName) {
+    std::ofstream out(fileName);
+    if (!out) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+
+    out << std::setprecision(9) << "[\n";
+    for (std::size_t i = 0; i < records.size(); i++) {
+        const BenchmarkRecord& record = records[i];
+        out << "  {\"group\": \"" << jsonEscape(record.group) << "\""
+            << ", \"function\": \"" << jsonEscape(record.function) << "\""
+            << ", \"case\": \"" << jsonEscape(record.caseName) << "\""
+            << ", \"alphabet\": \"" << jsonEscape(record.alphabet) << "\""
+            << ", \"needleLength\": " << record.needleLength
+            << ", \"occurrences\": " << record.occurrences
+            << ", \"sizeBytes\": " << record.sizeBytes
+            << ", \"bytesProcessed\": " << record.bytesProcessed
+            << ", \"warmup\": " << record.warmupIterations
+            << ", \"iterations\": " << record.seconds.count
+            << ", \"minSeconds\": " << record.seconds.min
+            << ", \"medianSeconds\": " << record.seconds.median
+            << ", \"p90Seconds\": " << record.seconds.p90
+            << ", \"p99Seconds\": " << record.seconds.p99
+            << ", \"meanSeconds\": " << record.seconds.mean
+            << ", \"stddevSeconds\": " << record.seconds.stddev
+            << ", \"cv\": " << record.seconds.cv
+            << ", \"throughputGBs\": " << record.throughputGBs();
+        for (const auto& field: optionalFields(record)) {
+            out << ", \"" << field.first << "\": ";
+            if (field.second) {
+                out << *field.second;
+            } else {
+                out << "null";
+            }
+        }
+        out << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + fileName);
+    }
+}
+
+/**
+ * @brief Writes `records` as CSV with a header row to `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeSummaryCsv(const std::vector<BenchmarkRecord>& records, const std::string& fileName) {
+    std::ofstream out(fileName);
+    if (!out) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+
+    out << std::setprecision(9)
+        << "group,function,case,alphabet,needleLength,occurrences,sizeBytes,bytesProcessed,warmup,iterations,minSeconds,medianSeconds,p90Seconds,p99Seconds,"
+           "meanSeconds,stddevSeconds,cv,throughputGBs";
+    for (const auto& field: optionalFields(BenchmarkRecord{})) {
+        out << ',' << field.first;
+    }
+    out << '\n';
+    for (const BenchmarkRecord& record: records) {
+        out << csvEscape(record.group) << ','
+            << csvEscape(record.function) << ','
+            << csvEscape(record.caseName) << ','
+            << csvEscape(record.alphabet) << ','
+            << record.needleLength << ','
+            << record.occurrences << ','
+            << record.sizeBytes << ','
+            << record.bytesProcessed << ','
+            << record.warmupIterations << ','
+            << record.seconds.count << ','
+            << record.seconds.min << ','
+            << record.seconds.median << ','
+            << record.seconds.p90 << ','
+            << record.seconds.p99 << ','
+            << record.seconds.mean << ','
+            << record.seconds.stddev << ','
+            << record.seconds.cv << ','
+            << record.throughputGBs();
+        for (const auto& field: optionalFields(record)) {
+            out << ',';
+            if (field.second) {
+                out << *field.second;
+            }
+        }
+        out << '\n';
+    }
+
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + fileName);
+    }
+}
+
+/**
+ * @brief Writes `records` to `out` as an aligned table of group, function, median time and GB/s.
+ */
+void writeSummaryTable(const std::vector<BenchmarkRecord>& records, std::ostream& out) {
+    std::size_t groupWidth = 5;
+    std::size_t functionWidth = 8;
+    for (const BenchmarkRecord& record: records) {
+        groupWidth = std::max(groupWidth, record.group.size());
+        functionWidth = std::max(functionWidth, record.function.size());
+    }
+
+    std::ios_base::fmtflags flags = out.flags();
+    std::streamsize precision = out.precision();
+    out << std::left << std::setw(groupWidth + 2) << "group" << std::setw(functionWidth + 2) << "function"
+        << std::right << std::setw(12) << "median ms" << std::setw(10) << "GB/s" << '\n';
+    out << std::fixed;
+    for (const BenchmarkRecord& record: records) {
+        out << std::left << std::setw(groupWidth + 2) << record.group << std::setw(functionWidth + 2) << record.function
+            << std::right << std::setprecision(3) << std::setw(12) << record.seconds.median * 1e3
+            << std::setprecision(2) << std::setw(10) << record.throughputGBs() << '\n';
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
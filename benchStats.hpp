@@ -0,0 +1,94 @@
+/*
+ * benchStats.hpp declares the sample statistics and the machine-readable summary
+ * (JSON and CSV) that BenchMarker writes next to the Profiler trace.
+ */
+
+#ifndef BENCHSTATS_HPP
+#define BENCHSTATS_HPP
+#include "perfCounters.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Order statistics and dispersion of a set of timing samples, in seconds.
+ */
+struct SampleStats {
+    std::size_t count = 0;
+    double min = 0;
+    double median = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double mean = 0;
+    double stddev = 0;
+    // coefficient of variation, stddev / mean
+    double cv = 0;
+
+    /**
+    * @brief Computes the statistics of `samples`.
+    *
+    * Percentiles use the nearest-rank method and the standard deviation is the sample
+    * (n - 1) deviation, so a single sample reports a deviation of 0.
+    *
+    * @param samples Timing samples in seconds.
+    * @return The statistics, all zero if `samples` is empty.
+    */
+    static SampleStats fromSamples(std::vector<double> samples);
+};
+
+/**
+ * @brief Summary of the measured iterations of one function on one input.
+ */
+struct BenchmarkRecord {
+    // "single", "multi", "scaling" or "patterns:<count>"
+    std::string group;
+    std::string function;
+    // benchmark case the record was measured on, e.g. "100MB" or "100MB_dna_n16_d10",
+    // with its alphabet, needle length and planted needle count
+    std::string caseName;
+    std::string alphabet;
+    std::size_t needleLength = 0;
+    std::uint64_t occurrences = 0;
+    std::uint64_t sizeBytes = 0;
+    // bytes a call has to read, smaller than sizeBytes for functions that stop at the first match
+    std::uint64_t bytesProcessed = 0;
+    unsigned int warmupIterations = 0;
+    SampleStats seconds;
+    // mean counter deltas per measured call, empty unless counter mode was on
+    PerfSample counters;
+    // scaling sweep only: pinned threads (0 for other records), NUMA node of the data
+    // (-1 without NUMA support), T(1 thread) / (threads * T(threads)), and the STREAM
+    // triad bandwidth measured with the same threads on the same node
+    unsigned int threads = 0;
+    int numaNode = -1;
+    double parallelEfficiency = 0;
+    double streamGBs = 0;
+
+    /**
+    * @brief Returns bytesProcessed over the median iteration in GB/s (10^9 bytes per second).
+    */
+    double throughputGBs() const;
+};
+
+/**
+ * @brief Writes `records` as a JSON array of objects to `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeSummaryJson(const std::vector<BenchmarkRecord>& records, const std::string& fileName);
+
+/**
+ * @brief Writes `records` as CSV with a header row to `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void writeSummaryCsv(const std::vector<BenchmarkRecord>& records, const std::string& fileName);
+
+/**
+ * @brief Writes `records` to `out` as an aligned table of group, function, median time and GB/s.
+ */
+void writeSummaryTable(const std::vector<BenchmarkRecord>& records, std::ostream& out);
+
+#endif // BENCHSTATS_HPP
@@ -0,0 +1,304 @@
+/**
+ * @file corpusGenerator.cpp
+ * @brief Implementation file for the CorpusGenerator class.
+ */
+
+#include "corpusGenerator.hpp"
+#include "searchFunctions/threadPool.hpp"
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+// bump when the generated bytes for a given spec change, so old cache files are not reused
+const char* generatorVersion = "ss-corpus-v1";
+
+const std::size_t blockSize = 1024 * 1024;
+const std::size_t blocksPerBatch = 64;
+
+std::uint64_t splitMix64(std::uint64_t& state) {
+    std::uint64_t z = (state += 0x9e3779b97f4a7c15ULL);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+}
+
+/**
+ * @brief xoshiro256** generator, one independent stream per (seed, block) pair.
+ */
+class Xoshiro256 {
+public:
+    Xoshiro256(std::uint64_t seed, std::uint64_t stream) {
+        std::uint64_t state = seed ^ (stream * 0xd1b54a32d192ed03ULL);
+        for (auto& word: m_state) {
+            word = splitMix64(state);
+        }
+    }
+
+    std::uint64_t next() {
+        const std::uint64_t result = rotl(m_state[1] * 5, 7) * 9;
+        const std::uint64_t t = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= t;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+
+private:
+    static std::uint64_t rotl(std::uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+    std::array<std::uint64_t, 4> m_state;
+};
+
+using SymbolTable = std::vector<char>;
+
+/**
+ * @brief Spreads weighted symbols over a 65536-entry table, every symbol getting at least one entry.
+ */
+SymbolTable buildTable(const std::vector<std::pair<char, double>>& weights) {
+    const std::size_t tableSize = 65536;
+    double total = 0;
+    for (const auto& entry: weights) {
+        total += entry.second;
+    }
+
+    std::vector<std::size_t> counts;
+    std::size_t assigned = 0;
+    for (const auto& entry: weights) {
+        std::size_t count = std::max<std::size_t>(1, entry.second / total * tableSize + 0.5);
+        counts.push_back(count);
+        assigned += count;
+    }
+    // rounding error goes to the most frequent symbol
+    auto largest = std::max_element(counts.begin(), counts.end()) - counts.begin();
+    counts[largest] += tableSize - assigned;
+
+    SymbolTable table;
+    table.reserve(tableSize);
+    for (std::size_t i = 0; i < weights.size(); i++) {
+        table.insert(table.end(), counts[i], weights[i].first);
+    }
+    return table;
+}
+
+SymbolTable symbolTable(const CorpusSpec& spec) {
+    std::vector<std::pair<char, double>> weights;
+    switch (spec.distribution) {
+    case ByteDistribution::Uniform: {
+        // printable ASCII first, then the remaining byte values
+        std::vector<unsigned char> symbols;
+        for (int c = 32; c <= 126; c++) symbols.push_back(c);
+        for (int c = 0; c < 32; c++) symbols.push_back(c);
+        for (int c = 127; c < 256; c++) symbols.push_back(c);
+        for (unsigned int i = 0; i < spec.alphabetSize; i++) {
+            weights.emplace_back(static_cast<char>(symbols[i]), 1.0);
+        }
+        break;
+    }
+    case ByteDistribution::English:
+        weights = {
+            {' ', 18.3}, {'e', 10.2}, {'t', 7.5}, {'a', 6.5}, {'o', 6.2}, {'i', 5.7},
+            {'n', 5.7}, {'s', 5.3}, {'h', 4.9}, {'r', 4.9}, {'d', 3.5}, {'l', 3.3},
+            {'u', 2.3}, {'c', 2.2}, {'m', 2.0}, {'f', 1.8}, {'w', 1.7}, {'g', 1.6},
+            {'y', 1.6}, {'p', 1.5}, {'b', 1.3}, {'v', 0.8}, {'k', 0.6}, {'x', 0.15},
+            {'j', 0.1}, {'q', 0.08}, {'z', 0.06}, {',', 1.0}, {'.', 0.9}, {'\n', 0.3},
+            {'T', 0.3}, {'I', 0.3}, {'A', 0.2}, {'S', 0.2}, {'\'', 0.2}, {'"', 0.1}
+        };
+        break;
+    case ByteDistribution::Dna:
+        weights = {{'A', 1.0}, {'C', 1.0}, {'G', 1.0}, {'T', 1.0}};
+        break;
+    }
+    return buildTable(weights);
+}
+
+/**
+ * @brief Fills one block from its own stream, four symbols per 64-bit draw.
+ */
+void fillBlock(char* out, std::size_t length, const SymbolTable& table, std::uint64_t seed, std::uint64_t block) {
+    Xoshiro256 rng(seed, block);
+    std::size_t i = 0;
+    for (; i + 4 <= length; i += 4) {
+        std::uint64_t r = rng.next();
+        char symbols[4] = {
+            table[r & 0xffff],
+            table[(r >> 16) & 0xffff],
+            table[(r >> 32) & 0xffff],
+            table[r >> 48]
+        };
+        std::memcpy(out + i, symbols, 4);
+    }
+    std::uint64_t r = rng.next();
+    for (; i < length; i++, r >>= 16) {
+        out[i] = table[r & 0xffff];
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Returns a 64-bit FNV-1a hash of every field and the generator version.
+ */
+std::uint64_t CorpusSpec::hash() const {
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    auto mix = [&h](const void* data, std::size_t length) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < length; i++) {
+            h = (h ^ bytes[i]) * 0x100000001b3ULL;
+        }
+    };
+    auto mixValue = [&mix](std::uint64_t value) {
+        mix(&value, sizeof(value));
+    };
+
+    mix(generatorVersion, std::strlen(generatorVersion));
+    mixValue(sizeBytes);
+    mixValue(static_cast<std::uint64_t>(distribution));
+    mixValue(alphabetSize);
+    mixValue(seed);
+    mixValue(needle.size());
+    mix(needle.data(), needle.size());
+    mixValue(occurrences);
+    return h;
+}
+
+/**
+ * @brief Writes the corpus described by `spec` to `fileName`.
+ *
+ * @param spec The corpus parameters.
+ * @param fileName The file to write.
+ *
+ * @throws std::invalid_argument if the needle is empty, the alphabet size is outside [1, 256],
+ *         or the corpus is too small to hold all occurrences.
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void CorpusGenerator::generate(const CorpusSpec& spec, const std::string& fileName) {
+    // checks
+    if (spec.needle.empty()) {
+        throw std::invalid_argument("Substring cannot be empty.");
+    }
+    if (spec.alphabetSize == 0 || spec.alphabetSize > 256) {
+        throw std::invalid_argument("Alphabet size must be between 1 and 256.");
+    }
+    if (spec.sizeBytes < spec.needle.size() || spec.sizeBytes / spec.needle.size() < spec.occurrences) {
+        throw std::invalid_argument("File size is too small to accommodate all occurrences of the substring.");
+    }
+
+    const SymbolTable table = symbolTable(spec);
+
+    // planted positions, sorted so each batch only visits the ones that touch it
+    std::vector<std::uint64_t> positions(spec.occurrences);
+    std::mt19937_64 gen(spec.seed);
+    std::uniform_int_distribution<std::uint64_t> positionDist(0, spec.sizeBytes - spec.needle.size());
+    for (auto& position: positions) {
+        position = positionDist(gen);
+    }
+    std::sort(positions.begin(), positions.end());
+
+    std::ofstream outFile(fileName, std::ios::binary);
+    if (!outFile) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+
+    const std::uint64_t batchSize = blockSize * blocksPerBatch;
+    std::vector<char> buffer(std::min<std::uint64_t>(batchSize, spec.sizeBytes));
+
+    for (std::uint64_t batchStart = 0; batchStart < spec.sizeBytes; batchStart += batchSize) {
+        std::uint64_t batchEnd = std::min(batchStart + batchSize, spec.sizeBytes);
+        std::uint64_t firstBlock = batchStart / blockSize;
+        std::size_t blocks = (batchEnd - batchStart + blockSize - 1) / blockSize;
+
+        ThreadPool::Get().parallelFor(blocks, [&](std::size_t i) {
+            std::uint64_t blockStart = (firstBlock + i) * blockSize;
+            std::uint64_t blockEnd = std::min(blockStart + blockSize, batchEnd);
+            fillBlock(buffer.data() + (blockStart - batchStart), blockEnd - blockStart, table, spec.seed, firstBlock + i);
+        });
+
+        // copy the part of every planted needle that falls into this batch
+        std::uint64_t lowest = batchStart >= spec.needle.size() ? batchStart - spec.needle.size() + 1 : 0;
+        for (auto it = std::lower_bound(positions.begin(), positions.end(), lowest);
+             it != positions.end() && *it < batchEnd; ++it) {
+            std::uint64_t from = std::max(*it, batchStart);
+            std::uint64_t to = std::min(*it + spec.needle.size(), batchEnd);
+            std::memcpy(buffer.data() + (from - batchStart), spec.needle.data() + (from - *it), to - from);
+        }
+
+        outFile.write(buffer.data(), static_cast<std::streamsize>(batchEnd - batchStart));
+    }
+
+    outFile.close();
+    if (!outFile) {
+        throw std::runtime_error("Failed to write file: " + fileName);
+    }
+}
+
+/**
+ * @brief Returns a cached corpus for `spec`, generating it first if needed.
+ *
+ * @param spec The corpus parameters.
+ * @param filePrefix Path prefix of the cache file.
+ * @return The path of the cached corpus.
+ */
+std::string CorpusGenerator::getOrGenerate(const CorpusSpec& spec, const std::string& filePrefix) {
+    char hashText[17];
+    std::snprintf(hashText, sizeof(hashText), "%016llx", static_cast<unsigned long long>(spec.hash()));
+    std::string fileName = filePrefix + "." + hashText;
+
+    std::error_code error;
+    if (std::filesystem::file_size(fileName, error) == spec.sizeBytes && !error) {
+        return fileName;
+    }
+
+    // a unique name per writer, so concurrent runs never write into the same file
+    std::string tempName = fileName + ".tmp" + std::to_string(std::random_device{}());
+    try {
+        generate(spec, tempName);
+    } catch (...) {
+        std::filesystem::remove(tempName, error);
+        throw;
+    }
+    std::filesystem::rename(tempName, fileName);
+    return fileName;
+}
+
+/**
+ * @brief Draws a needle of `length` symbols from the byte distribution of `spec`.
+ *
+ * Symbols are drawn from the same lookup table as the corpus, with a std::mt19937_64
+ * seeded from the seed and the length.
+ *
+ * @param spec The corpus parameters; its needle and occurrences are ignored.
+ * @param length Number of symbols.
+ * @return The needle.
+ *
+ * @throws std::invalid_argument if the alphabet size is outside [1, 256].
+ */
+std::string CorpusGenerator::randomNeedle(const CorpusSpec& spec, std::size_t length) {
+    if (spec.alphabetSize == 0 || spec.alphabetSize > 256) {
+        throw std::invalid_argument("Alphabet size must be between 1 and 256.");
+    }
+
+    const SymbolTable table = symbolTable(spec);
+    std::mt19937_64 gen(spec.seed ^ (0x9e3779b97f4a7c15ull * (length + 1)));
+    std::uniform_int_distribution<std::size_t> symbolDist(0, table.size() - 1);
+
+    std::string needle(length, '\0');
+    for (char& symbol: needle) {
+        symbol = table[symbolDist(gen)];
+    }
+    return needle;
+}
@@ -0,0 +1,91 @@
+/*
+ * corpusGenerator.hpp declares the synthetic corpus generator used by BenchMarker.
+ * Corpora are reproducible from their parameters and cached on disk under a name
+ * derived from a hash of those parameters.
+ */
+
+#ifndef CORPUSGENERATOR_HPP
+#define CORPUSGENERATOR_HPP
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Byte distribution of a generated corpus.
+ */
+enum class ByteDistribution {
+    Uniform, // alphabetSize symbols, equally likely
+    English, // letter, space and punctuation frequencies of English text
+    Dna      // A, C, G and T, equally likely
+};
+
+/**
+ * @brief Parameters that fully determine a generated corpus.
+ */
+struct CorpusSpec {
+    std::uint64_t sizeBytes = 0;
+    ByteDistribution distribution = ByteDistribution::Uniform;
+    // number of symbols for ByteDistribution::Uniform, starting with the printable ASCII range
+    unsigned int alphabetSize = 95;
+    std::uint64_t seed = 0;
+    std::string needle;
+    std::uint64_t occurrences = 0;
+
+    /**
+    * @brief Returns a 64-bit FNV-1a hash of every field and the generator version.
+    */
+    std::uint64_t hash() const;
+};
+
+class CorpusGenerator {
+public:
+    /**
+    * @brief Writes the corpus described by `spec` to `fileName`.
+    *
+    * The corpus is cut into fixed-size blocks, each filled by its own xoshiro256**
+    * stream seeded from (spec.seed, block index). Every 64-bit draw yields four
+    * symbols through a 65536-entry lookup table built from the distribution, and the
+    * blocks are generated in parallel on ThreadPool::Get(). The output therefore only
+    * depends on the spec, not on the thread count. The needle is then planted at
+    * `occurrences` positions drawn from a seeded std::mt19937_64. Data is written batch
+    * by batch, so memory use is bounded by the batch size rather than the corpus size.
+    *
+    * @param spec The corpus parameters.
+    * @param fileName The file to write.
+    *
+    * @throws std::invalid_argument if the needle is empty, the alphabet size is outside [1, 256],
+    *         or the corpus is too small to hold all occurrences.
+    * @throws std::runtime_error if the file cannot be written.
+    */
+    static void generate(const CorpusSpec& spec, const std::string& fileName);
+
+    /**
+    * @brief Returns a cached corpus for `spec`, generating it first if needed.
+    *
+    * The cache file is `filePrefix` followed by the hex hash of `spec`. A missing file is
+    * generated under a unique temporary name and renamed into place, so neither an
+    * interrupted run nor a concurrent one leaves a partial corpus behind.
+    *
+    * @param spec The corpus parameters.
+    * @param filePrefix Path prefix of the cache file.
+    * @return The path of the cached corpus.
+    */
+    static std::string getOrGenerate(const CorpusSpec& spec, const std::string& filePrefix);
+
+    /**
+    * @brief Draws a needle of `length` symbols from the byte distribution of `spec`.
+    *
+    * The needle depends only on the distribution, the alphabet size, the seed and the
+    * length, so cases that differ in corpus size or planted occurrences search for the
+    * same needle.
+    *
+    * @param spec The corpus parameters; its needle and occurrences are ignored.
+    * @param length Number of symbols.
+    * @return The needle.
+    *
+    * @throws std::invalid_argument if the alphabet size is outside [1, 256].
+    */
+    static std::string randomNeedle(const CorpusSpec& spec, std::size_t length);
+};
+
+#endif // CORPUSGENERATOR_HPP
@@ -0,0 +1,177 @@
+/**
+ * @file corpusSearch.cpp
+ * @brief Implementation file for the CorpusSearcher class.
+ */
+
+#include "corpusSearch.hpp"
+#include "readAhead.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <climits>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Files packed back to back, with the offset table to map positions back to them.
+ */
+struct Batch {
+    std::unique_ptr<char[]> data;
+    std::size_t capacity = 0;
+    std::size_t length = 0;
+    // list index of the first packed file
+    std::uint32_t firstFile = 0;
+    // start of every packed file in `data`, followed by the end of the last one
+    std::vector<std::size_t> starts;
+};
+
+} // namespace
+
+/**
+ * @brief Constructs a searcher running `search` on every batch.
+ *
+ * @param search Find-all function returning ascending match positions in its input.
+ * @param options Batch layout.
+ *
+ * @throws std::invalid_argument if the batch size is 0 or past the int offsets of `search`,
+ *         or there are fewer than 2 batches.
+ */
+CorpusSearcher::CorpusSearcher(SearchFunction search, CorpusSearchOptions options)
+: m_search(std::move(search)), m_options(options) {
+    if (m_options.batchSize == 0 || m_options.batchSize > INT_MAX || m_options.batchCount < 2) {
+        throw std::invalid_argument("Corpus search needs a batch size in (0, INT_MAX] and at least 2 batches.");
+    }
+}
+
+/**
+ * @brief Lists the regular files under `path` in a stable order.
+ *
+ * Directories that cannot be read are skipped.
+ *
+ * @param path A directory, walked recursively, or a single file.
+ *
+ * @return The file paths, sorted.
+ *
+ * @throws std::runtime_error if `path` does not exist.
+ */
+std::vector<std::string> CorpusSearcher::listFiles(const std::string& path) {
+    PROFILE_FUNCTION();
+    namespace fs = std::filesystem;
+
+    std::error_code error;
+    fs::file_status status = fs::status(path, error);
+    if (!fs::exists(status)) {
+        throw std::runtime_error("No such file or directory: " + path);
+    }
+    if (!fs::is_directory(status)) {
+        return {path};
+    }
+
+    std::vector<std::string> files;
+    for (const auto& entry: fs::recursive_directory_iterator(path, fs::directory_options::skip_permission_denied)) {
+        if (entry.is_regular_file(error)) {
+            files.push_back(entry.path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * @brief Searches every file of `files`.
+ *
+ * Batch k lives in slot k % batchCount of a readAhead() ring. The reader packs whole
+ * files into a slot until the next one would overflow batchSize; a file larger than
+ * batchSize starts a batch of its own and grows that slot. Matches are mapped back to
+ * their files with the batch's offset table in one pass, since both are ascending.
+ *
+ * @param files The files to search; a match reports its file as an index into this list.
+ * @param needle The pattern to search for; an empty needle has no matches.
+ * @param onMatch Called with every match, ordered by file, then offset.
+ *
+ * @return The number of matches.
+ *
+ * @throws std::invalid_argument if there are more files than a 32-bit file index holds.
+ * @throws std::runtime_error if a file cannot be opened or read, or is larger than an int offset.
+ */
+std::uint64_t CorpusSearcher::searchFiles(const std::vector<std::string>& files, std::string_view needle,
+                                          const MatchCallback& onMatch) const {
+    PROFILE_FUNCTION();
+    if (files.size() > UINT32_MAX) {
+        throw std::invalid_argument("Corpus search supports at most 2^32 - 1 files.");
+    }
+    if (needle.empty() || files.empty()) {
+        return 0;
+    }
+
+    const std::size_t batchSize = m_options.batchSize;
+    const std::size_t batchCount = m_options.batchCount;
+    std::vector<Batch> batches(batchCount);
+
+    std::size_t nextFile = 0;
+    // a file opened for a batch it did not fit in, packed first into the next one
+    std::optional<InputFile> pending;
+    auto pack = [&](std::size_t index) {
+        Batch& batch = batches[index % batchCount];
+        batch.length = 0;
+        batch.firstFile = nextFile;
+        batch.starts.assign(1, 0);
+        for (; nextFile < files.size(); nextFile++) {
+            if (!pending) {
+                pending.emplace(files[nextFile]);
+            }
+            std::size_t size = pending->size();
+            if (batch.length > 0 && batch.length + size > batchSize) {
+                break;
+            }
+            if (size > INT_MAX) {
+                throw std::runtime_error("File too large for a corpus batch: " + files[nextFile]);
+            }
+            if (batch.capacity < batch.length + size) {
+                batch.capacity = std::max(batchSize, batch.length + size);
+                batch.data = std::make_unique_for_overwrite<char[]>(batch.capacity);
+            }
+            // a file that shrank since it was opened is packed with its current length
+            batch.length += pending->read(batch.data.get() + batch.length, size);
+            batch.starts.push_back(batch.length);
+            pending.reset();
+        }
+        return nextFile < files.size();
+    };
+
+    std::uint64_t matchCount = 0;
+    auto search = [&](std::size_t index) {
+        const Batch& batch = batches[index % batchCount];
+        std::string_view view(batch.data.get(), batch.length);
+        if (view.length() < needle.length()) {
+            return;
+        }
+
+        std::vector<int> positions;
+        {
+            PROFILE_SCOPE("Search Batch");
+            positions = m_search(view, needle);
+        }
+
+        std::size_t file = 0;
+        for (int position: positions) {
+            std::size_t start = position;
+            while (batch.starts[file + 1] <= start) {
+                file++;
+            }
+            // a match running into the next file is an artifact of the packing
+            if (start + needle.length() <= batch.starts[file + 1]) {
+                onMatch(CorpusMatch{static_cast<std::uint32_t>(batch.firstFile + file), start - batch.starts[file]});
+                matchCount++;
+            }
+        }
+    };
+
+    readAhead(batchCount, pack, search);
+    return matchCount;
+}
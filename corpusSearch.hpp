@@ -0,0 +1,99 @@
+/*
+ * corpusSearch.hpp declares CorpusSearcher, which searches many files by packing them
+ * into large batches, so per-call setup and launch costs are paid per batch, not per file.
+ */
+
+#ifndef CORPUSSEARCH_HPP
+#define CORPUSSEARCH_HPP
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Batch layout of a CorpusSearcher.
+ */
+struct CorpusSearchOptions {
+    // bytes packed per batch; a larger file gets a batch of its own
+    std::size_t batchSize = 64 * 1024 * 1024;
+    // batches in memory; the reader packs up to batchCount - 1 batches ahead of the search
+    std::size_t batchCount = 3;
+};
+
+/**
+ * @brief One occurrence in a corpus: the file it is in and its offset there.
+ */
+struct CorpusMatch {
+    // index of the file in the list passed to CorpusSearcher::searchFiles()
+    std::uint32_t file;
+    std::uint64_t offset;
+
+    auto operator<=>(const CorpusMatch&) const = default;
+};
+
+/**
+ * @brief Searches a list of files, packed back to back into batches with an offset table.
+ *
+ * A reader thread reads whole files into the next free batch while the calling thread
+ * searches the previous ones, so file I/O overlaps the search. Each batch is searched
+ * with one call of the search function, e.g. one ThreadPool job or one OpenCL dispatch,
+ * instead of one call per file. Files are packed without separators and a match is
+ * only reported if it ends inside the file it starts in, so no match spans two files.
+ *
+ * Memory use is batchCount batches of batchSize bytes, grown only for files larger than
+ * a batch, plus the offset tables and the result list of one batch.
+ */
+class CorpusSearcher {
+public:
+    // any find-all function, e.g. one registered as a MultiReturnFunction
+    using SearchFunction = std::function<std::vector<int>(std::string_view, std::string_view)>;
+    using MatchCallback = std::function<void(const CorpusMatch&)>;
+
+    /**
+    * @brief Constructs a searcher running `search` on every batch.
+    *
+    * @param search Find-all function returning ascending match positions in its input.
+    * @param options Batch layout.
+    *
+    * @throws std::invalid_argument if the batch size is 0 or past the int offsets of `search`,
+    *         or there are fewer than 2 batches.
+    */
+    explicit CorpusSearcher(SearchFunction search, CorpusSearchOptions options = {});
+
+    /**
+    * @brief Lists the regular files under `path` in a stable order.
+    *
+    * @param path A directory, walked recursively without following symlinked directories,
+    *             or a single file.
+    *
+    * @return The file paths, sorted.
+    *
+    * @throws std::runtime_error if `path` does not exist.
+    */
+    static std::vector<std::string> listFiles(const std::string& path);
+
+    /**
+    * @brief Searches every file of `files`.
+    *
+    * @param files The files to search; a match reports its file as an index into this list.
+    * @param needle The pattern to search for; an empty needle has no matches.
+    * @param onMatch Called with every match, ordered by file, then offset.
+    *
+    * @return The number of matches.
+    *
+    * @throws std::runtime_error if a file cannot be opened or read, or is larger than an int offset.
+    */
+    std::uint64_t searchFiles(const std::vector<std::string>& files, std::string_view needle,
+                              const MatchCallback& onMatch) const;
+
+    const CorpusSearchOptions& options() const { return m_options; }
+
+private:
+    SearchFunction m_search;
+    CorpusSearchOptions m_options;
+};
+
+#endif // CORPUSSEARCH_HPP
@@ -1,25 +1,274 @@
+#include <algorithm>
+#include <cstdint>
 #include <functional>
+#include <iostream>
 #include <cstring>
+#include <filesystem>
+#include <stdexcept>
 #include <string>
+#include <string_view>
 #include <vector>
 #include "benchMarker.hpp"
+#include "streamSearch.hpp"
+#include "corpusSearch.hpp"
 #include "searchFunctions/cl.hpp"
 #include "searchFunctions/standardFunctions.hpp"
 #include "searchFunctions/implementedFunctions.hpp"
+#include "searchFunctions/algorithmFunctions.hpp"
+#include "searchFunctions/sinkSearch.hpp"
+#include "searchFunctions/simdFunctions.hpp"
+#include "searchFunctions/parallelFunctions.hpp"
+#include "searchFunctions/hybridSearch.hpp"
+#include "searchFunctions/shardedSearch.hpp"
+#include "searchFunctions/threadPool.hpp"
+#include "searchFunctions/multiPattern.hpp"
+#include "searchFunctions/approximateFunctions.hpp"
 #include "performance-analyzer/performance-analyzer.hpp"
+#ifdef ENABLE_VULKAN
+#include "searchFunctions/vkSearch.hpp"
+#endif
 
-int main() {
+/**
+ * @brief Streams a file or stdin through one of the find-all functions and prints every match offset.
+ *
+ * Usage: ss_analytics --stream [--kernel NAME] NEEDLE [FILE]
+ * FILE defaults to "-", stdin. NAME is any registered find-all function and defaults to
+ * adaptiveFindAll. The match count goes to stderr, so stdout holds only offsets.
+ *
+ * @param argc Argument count of main.
+ * @param argv Arguments of main, argv[1] being "--stream".
+ * @param functions The registered find-all functions.
+ *
+ * @return The process exit code.
+ */
+static int runStreamSearch(int argc, char* argv[], const std::vector<MultiReturnFunction>& functions) {
+    std::string kernelName = "adaptiveFindAll";
+    int arg = 2;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "--kernel") == 0) {
+        kernelName = argv[arg + 1];
+        arg += 2;
+    }
+    if (arg >= argc || argc - arg > 2) {
+        std::cerr << "Usage: " << argv[0] << " --stream [--kernel NAME] NEEDLE [FILE]" << std::endl;
+        return 2;
+    }
+    std::string needle = argv[arg];
+    std::string fileName = arg + 1 < argc ? argv[arg + 1] : "-";
 
-    std::vector<std::function<int(std::string&, std::string&)>> benchMarkedSingleReturn {
-        stringSearch,
-        standardFind
+    auto function = std::find_if(functions.begin(), functions.end(),
+                                 [&](const MultiReturnFunction& f) { return f.name == kernelName; });
+    if (function == functions.end()) {
+        std::cerr << "Unknown kernel: " << kernelName << std::endl;
+        return 2;
+    }
+
+    try {
+        StreamSearcher searcher(function->function);
+        std::uint64_t matches = searcher.searchFile(fileName, needle, [](std::uint64_t offset) {
+            std::cout << offset << '\n';
+        });
+        std::cout.flush();
+        std::cerr << matches << " matches" << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Searches every file under a directory with one of the find-all functions and prints every match.
+ *
+ * Usage: ss_analytics --corpus [--kernel NAME] NEEDLE PATH
+ * PATH is a directory, searched recursively, or a single file. The files are packed into
+ * batches and NAME, any registered find-all function, runs once per batch; it defaults
+ * to parallelFindAll, and clSearch runs each batch as one OpenCL dispatch. Matches are
+ * printed as `file:offset`; the file and match counts go to stderr.
+ *
+ * @param argc Argument count of main.
+ * @param argv Arguments of main, argv[1] being "--corpus".
+ * @param functions The registered find-all functions.
+ *
+ * @return The process exit code.
+ */
+static int runCorpusSearch(int argc, char* argv[], const std::vector<MultiReturnFunction>& functions) {
+    std::string kernelName = "parallelFindAll";
+    int arg = 2;
+    if (arg + 1 < argc && std::strcmp(argv[arg], "--kernel") == 0) {
+        kernelName = argv[arg + 1];
+        arg += 2;
+    }
+    if (argc - arg != 2) {
+        std::cerr << "Usage: " << argv[0] << " --corpus [--kernel NAME] NEEDLE PATH" << std::endl;
+        return 2;
+    }
+    std::string needle = argv[arg];
+    std::string path = argv[arg + 1];
+
+    auto function = std::find_if(functions.begin(), functions.end(),
+                                 [&](const MultiReturnFunction& f) { return f.name == kernelName; });
+    if (function == functions.end()) {
+        std::cerr << "Unknown kernel: " << kernelName << std::endl;
+        return 2;
+    }
+
+    try {
+        CorpusSearcher searcher(function->function);
+        std::vector<std::string> files = CorpusSearcher::listFiles(path);
+        std::uint64_t matches = searcher.searchFiles(files, needle, [&files](const CorpusMatch& match) {
+            std::cout << files[match.file] << ':' << match.offset << '\n';
+        });
+        std::cout.flush();
+        std::cerr << matches << " matches in " << files.size() << " files" << std::endl;
+    } catch (std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Prints the OpenCL devices of the current selection, or every device, one per line.
+ *
+ * Usage: ss_analytics [--cl-devices SPEC] --list-cl-devices
+ *
+ * @return The process exit code.
+ */
+static int listClDevices() {
+    std::vector<cl::Device> devices = findClDevices(clDeviceSelection().value_or(ClDeviceSelector{}));
+    if (devices.empty()) {
+        std::cerr << "No OpenCL device found" << std::endl;
+        return 1;
+    }
+    for (size_t i = 0; i < devices.size(); i++) {
+        std::cout << i << ": " << clDeviceDescription(devices[i]) << std::endl;
+    }
+    return 0;
+}
+
+/**
+ * @brief Returns whether `option` is one of the arguments after the program name.
+ */
+static bool hasOption(int argc, char* argv[], const char* option) {
+    for (int arg = 1; arg < argc; arg++) {
+        if (std::strcmp(argv[arg], option) == 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns the argument following `option`, or nullptr if `option` is not given or is last.
+ */
+static const char* optionValue(int argc, char* argv[], const char* option) {
+    for (int arg = 1; arg + 1 < argc; arg++) {
+        if (std::strcmp(argv[arg], option) == 0) {
+            return argv[arg + 1];
+        }
+    }
+    return nullptr;
+}
+
+int main(int argc, char* argv[]) {
+    // --cl-devices SPEC selects the OpenCL devices, e.g. "gpu", "vendor=intel" or "all,0,2",
+    // and may precede any mode
+    if (argc > 2 && std::strcmp(argv[1], "--cl-devices") == 0) {
+        try {
+            setClDeviceSelector(ClDeviceSelector::parse(argv[2]));
+        } catch (std::invalid_argument& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+        // drop the option, keeping the program name in front of the remaining arguments
+        argv[2] = argv[0];
+        argv += 2;
+        argc -= 2;
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--list-cl-devices") == 0) {
+        return listClDevices();
+    }
+
+    std::vector<SingleReturnFunction> benchMarkedSingleReturn {
+        {"stringSearch", stringSearch},
+        {"standardFind", standardFind},
+        {"clSearchFirst", clSearchFirst, true},
+        {"simdFind", simdFind},
+        {"horspoolFind", horspoolFind},
+        {"raitaFind", raitaFind},
+        {"twoWayFind", twoWayFind},
+        {"shiftOrFind", shiftOrFind},
+        {"adaptiveFind", adaptiveFind}
     };    
 
-    std::vector<std::function<std::vector<int>(std::string&,std::string&)>> benchMarkedMultiReturn { 
-        clSearch,
-        standardFindAll
+    std::vector<CountFunction> benchMarkedCount {
+        {"standardCount", standardCount},
+        {"clCount", clCount, true},
+        {"adaptiveCount", [](std::string_view str, std::string_view subStr) {
+            CountSink sink;
+            adaptiveFindAllInto(str, subStr, sink);
+            return static_cast<int>(sink.count);
+        }}
     };
 
+    std::vector<MultiReturnFunction> benchMarkedMultiReturn { 
+        {"clSearch", clSearch, true},
+        {"clSearchStreaming", clSearchStreaming, true},
+        {"standardFindAll", standardFindAll},
+        {"simdFindAll", simdFindAll},
+        {"parallelFindAll", parallelFindAll},
+        {"hybridFindAll", hybridFindAll, true},
+        {"clShardedSearch", clShardedSearch, true},
+        {"horspoolFindAll", horspoolFindAll},
+        {"raitaFindAll", raitaFindAll},
+        {"twoWayFindAll", twoWayFindAll},
+        {"shiftOrFindAll", shiftOrFindAll},
+        {"adaptiveFindAll", adaptiveFindAll}
+    };
+
+    // the find-all backends again, writing into a reused buffer instead of returning a vector
+    std::vector<SinkFunction> benchMarkedSink {
+        {"standardFindAllInto", standardFindAllInto<VectorSink>},
+        {"clSearchInto", [](std::string_view str, std::string_view subStr, VectorSink& sink) {
+            ClSearchEngine::Get().findAllInto(str, subStr, sink);
+        }, true},
+        {"clSearchStreamingInto", [](std::string_view str, std::string_view subStr, VectorSink& sink) {
+            ClSearchEngine::Get().findAllStreamingInto(str, subStr, sink);
+        }, true},
+        {"simdFindAllInto", simdFindAllInto<VectorSink>},
+        {"horspoolFindAllInto", horspoolFindAllInto<VectorSink>},
+        {"raitaFindAllInto", raitaFindAllInto<VectorSink>},
+        {"twoWayFindAllInto", twoWayFindAllInto<VectorSink>},
+        {"shiftOrFindAllInto", shiftOrFindAllInto<VectorSink>},
+        {"adaptiveFindAllInto", adaptiveFindAllInto<VectorSink>}
+    };
+
+#ifdef ENABLE_VULKAN
+    // the Vulkan backend is only benchmarked when a driver with a compute device is present
+    try {
+        std::string vulkanDevice = VkSearchEngine::Get().deviceName();
+        std::cout << "Vulkan device: " << vulkanDevice << std::endl;
+        benchMarkedSingleReturn.push_back({"vulkanStringSearch", vulkanStringSearch, true});
+        benchMarkedMultiReturn.push_back({"vulkanFindAll", vulkanFindAll, true});
+    } catch (std::runtime_error& e) {
+        std::cout << "Vulkan unavailable, skipping the Vulkan backend: " << e.what() << std::endl;
+    }
+#endif
+
+    // parallel find-all at 1, 2, 4, ... threads below all cores, to measure scaling
+    for (unsigned threads = 1; threads < ThreadPool::Get().size(); threads *= 2) {
+        benchMarkedMultiReturn.push_back({"parallelFindAll x" + std::to_string(threads), [threads](std::string_view str, std::string_view subStr) {
+            return parallelFindAllThreads(str, subStr, threads);
+        }});
+    }
+
+    if (argc > 1 && std::strcmp(argv[1], "--stream") == 0) {
+        return runStreamSearch(argc, argv, benchMarkedMultiReturn);
+    }
+    if (argc > 1 && std::strcmp(argv[1], "--corpus") == 0) {
+        return runCorpusSearch(argc, argv, benchMarkedMultiReturn);
+    }
+
     std::vector<unsigned int> benchMarkFileSizes {
         10,
         50,
@@ -31,7 +280,85 @@ int main() {
         1500
     };
 
+    std::cout << "SIMD implementation: " << simdImplementationName() << std::endl;
+
+    // tune the OpenCL kernels once per device, later runs reuse the stored configuration
+    std::string kernelConfigFile = "clKernelConfig.txt";
+    ClSearchEngine& clEngine = ClSearchEngine::Get();
+    if (!clEngine.loadKernelConfig(kernelConfigFile)) {
+        std::cout << "Tuning OpenCL kernels" << std::endl;
+        clEngine.autotune("akdl;jfksjft");
+        clEngine.saveKernelConfig(kernelConfigFile);
+    }
+    std::cout << "OpenCL kernel: " << clEngine.kernelConfig().name() << std::endl;
+
+    std::vector<MultiPatternFunction> benchMarkedMultiPattern {
+        {"clMultiSearch", clMultiSearch, true},
+        {"clBatchSearch", clBatchSearch, true},
+        {"ahoCorasickFindAll", ahoCorasickFindAll},
+        {"repeatedFindAll", repeatedFindAll}
+    };
+
+    std::vector<ApproximateFunction> benchMarkedHamming {
+        {"shiftAddFindAll", shiftAddFindAll},
+        {"clHammingSearch", clHammingSearch, true}
+    };
+
+    std::vector<ApproximateFunction> benchMarkedEdit {
+        {"myersFindAll", myersFindAll},
+        {"parallelMyersFindAll", parallelMyersFindAll}
+    };
+
+    std::vector<unsigned int> benchMarkPatternCounts {
+        1,
+        10,
+        100,
+        500,
+        1000
+    };
+
     BenchMarker benchMarker(benchMarkedSingleReturn, benchMarkedMultiReturn, benchMarkFileSizes);
+    benchMarker.setCountFunctions(benchMarkedCount);
+    benchMarker.setSinkFunctions(benchMarkedSink);
+    benchMarker.setMultiPatternFunctions(benchMarkedMultiPattern, benchMarkPatternCounts);
+    benchMarker.setApproximateFunctions(benchMarkedHamming, benchMarkedEdit, 2, 10);
+    benchMarker.setIterations(1, 5);
+    benchMarker.setIndexBenchmark(FmIndexOptions{}, 500);
+    // --counters adds hardware performance counters to the trace and the summary
+    benchMarker.setPerfCounters(hasOption(argc, argv, "--counters"));
+
+    // --scaling sweeps the ThreadPool::Get() backends over pinned thread counts on every NUMA node
+    if (hasOption(argc, argv, "--scaling")) {
+        std::vector<MultiReturnFunction> benchMarkedScaling {
+            {"parallelFindAll", parallelFindAll},
+            // zero edits reports exactly the matches of parallelFindAll
+            {"parallelMyersFindAll k=0", [](std::string_view str, std::string_view subStr) {
+                std::vector<int> offsets;
+                for (const ApproximateMatch& match: parallelMyersFindAll(str, subStr, 0)) {
+                    offsets.push_back(match.offset);
+                }
+                return offsets;
+            }}
+        };
+        // every node is also swept at its full width
+        std::vector<unsigned int> scalingThreadCounts;
+        for (unsigned threads = 1; threads < ThreadPool::Get().size(); threads *= 2) {
+            scalingThreadCounts.push_back(threads);
+        }
+        benchMarker.setScalingSweep(benchMarkedScaling, scalingThreadCounts, 500);
+    }
+
+    // --matrix SPEC_OR_FILE runs the cross-product of corpus sizes, needle lengths, match
+    // densities and alphabets, e.g. "size=10,100;needle=4,16,64;density=0,1,1000;alphabet=uniform,dna"
+    if (const char* matrix = optionValue(argc, argv, "--matrix")) {
+        try {
+            benchMarker.setMatrix(std::filesystem::is_regular_file(matrix) ? BenchmarkMatrix::load(matrix)
+                                                                          : BenchmarkMatrix::parse(matrix));
+        } catch (std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+    }
 
     std::string filePrefix = "../results/testOutput";
     std::string testDataName = "testData.txt";
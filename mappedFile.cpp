@@ -0,0 +1,118 @@
+/**
+ * @file mappedFile.cpp
+ * @brief Implementation file for the MappedFile class.
+ */
+
+#include "mappedFile.hpp"
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define MAPPEDFILE_POSIX 1
+#else
+#include <fstream>
+#include <iterator>
+#define MAPPEDFILE_POSIX 0
+#endif
+
+/**
+ * @brief Maps a file into memory.
+ *
+ * @param fileName Name of the file to map.
+ * @param access Expected access pattern.
+ *
+ * @throws std::runtime_error if the file cannot be opened or mapped.
+ */
+MappedFile::MappedFile(const std::string& fileName, Access access)
+: m_data(nullptr), m_size(0), m_mapped(false) {
+#if MAPPEDFILE_POSIX
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+
+    struct stat info;
+    if (::fstat(fd, &info) != 0) {
+        ::close(fd);
+        throw std::runtime_error("Failed to stat file: " + fileName);
+    }
+    m_size = info.st_size;
+
+    // mmap rejects zero-length mappings, an empty file is just an empty view
+    if (m_size > 0) {
+        void* mapping = ::mmap(nullptr, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+        if (mapping == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error("Failed to map file: " + fileName);
+        }
+        m_data = static_cast<char*>(mapping);
+        m_mapped = true;
+
+        // hints only, failures are harmless
+        if (access == Access::Sequential) {
+            ::madvise(mapping, m_size, MADV_SEQUENTIAL);
+            ::madvise(mapping, m_size, MADV_WILLNEED);
+        } else {
+            ::madvise(mapping, m_size, MADV_RANDOM);
+        }
+#ifdef MADV_HUGEPAGE
+        ::madvise(mapping, m_size, MADV_HUGEPAGE);
+#endif
+    }
+    ::close(fd);
+#else
+    (void)access;
+    std::ifstream file(fileName, std::ios::binary);
+    if (!file) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+    m_fallback.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    m_data = m_fallback.data();
+    m_size = m_fallback.size();
+#endif
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+: m_data(std::exchange(other.m_data, nullptr)), m_size(std::exchange(other.m_size, 0)),
+  m_mapped(std::exchange(other.m_mapped, false)), m_fallback(std::move(other.m_fallback)) {
+    if (!m_mapped) {
+        m_data = m_fallback.data();
+    }
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        unmap();
+        m_data = std::exchange(other.m_data, nullptr);
+        m_size = std::exchange(other.m_size, 0);
+        m_mapped = std::exchange(other.m_mapped, false);
+        m_fallback = std::move(other.m_fallback);
+        if (!m_mapped) {
+            m_data = m_fallback.data();
+        }
+    }
+    return *this;
+}
+
+/**
+ * @brief Releases the mapping, if any.
+ */
+void MappedFile::unmap() {
+#if MAPPEDFILE_POSIX
+    if (m_mapped) {
+        ::munmap(m_data, m_size);
+    }
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_mapped = false;
+}
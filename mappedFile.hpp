@@ -0,0 +1,76 @@
+/*
+ * mappedFile.hpp declares MappedFile, a memory-mapped view of a corpus file that the
+ * search functions can read through std::string_view without a resident copy.
+ */
+
+#ifndef MAPPEDFILE_HPP
+#define MAPPEDFILE_HPP
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+class MappedFile {
+public:
+    /**
+    * @brief How the mapping will be read, passed to the kernel as an madvise hint.
+    */
+    enum class Access {
+        Sequential, // streamed front to back, e.g. a corpus being scanned
+        Random      // scattered lookups, e.g. an FM-index
+    };
+
+    /**
+    * @brief Maps a file into memory.
+    *
+    * The file is mapped private and copy-on-write: reads come straight from the page
+    * cache, and writes (e.g. planting needles) only copy the touched pages. For
+    * Access::Sequential the kernel is advised that the mapping is read sequentially
+    * and readahead is started right away; for Access::Random readahead is disabled.
+    * Either way the mapping may use huge pages.
+    *
+    * On platforms without mmap the file is read into an owned buffer instead.
+    *
+    * @param fileName Name of the file to map.
+    * @param access Expected access pattern.
+    *
+    * @throws std::runtime_error if the file cannot be opened or mapped.
+    */
+    explicit MappedFile(const std::string& fileName, Access access = Access::Sequential);
+
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    /**
+    * @brief Returns a pointer to the first byte of the mapping (page aligned when mapped).
+    */
+    char* data() { return m_data; }
+    const char* data() const { return m_data; }
+
+    /**
+    * @brief Returns the size of the file in bytes.
+    */
+    std::size_t size() const { return m_size; }
+
+    /**
+    * @brief Returns the whole file as a string view.
+    */
+    std::string_view view() const { return std::string_view(m_data, m_size); }
+
+private:
+    /**
+    * @brief Releases the mapping, if any.
+    */
+    void unmap();
+
+private:
+    char* m_data;
+    std::size_t m_size;
+    bool m_mapped;
+    std::string m_fallback;
+};
+
+#endif // MAPPEDFILE_HPP
@@ -0,0 +1,166 @@
+/**
+ * @file numaTopology.cpp
+ * @brief NUMA node discovery, node-local buffers and the STREAM triad probe.
+ */
+
+#include "numaTopology.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <new>
+#include <utility>
+
+#ifdef HAVE_LIBNUMA
+#include <numa.h>
+#endif
+
+namespace {
+
+const std::size_t pageSize = 4096;
+
+} // namespace
+
+/**
+ * @brief Returns whether node placement is available (built with libnuma and supported by the kernel).
+ */
+bool numaAvailable() {
+#ifdef HAVE_LIBNUMA
+    return numa_available() >= 0;
+#else
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns the NUMA nodes that have CPUs in the calling thread's affinity mask.
+ *
+ * Memory-only nodes are left out.
+ */
+std::vector<NumaNode> numaNodes() {
+    std::vector<unsigned> allowed = ThreadPool::currentAffinity();
+
+#ifdef HAVE_LIBNUMA
+    if (numaAvailable()) {
+        std::vector<NumaNode> nodes;
+        struct bitmask* mask = numa_allocate_cpumask();
+        for (int node = 0; node <= numa_max_node(); node++) {
+            if (numa_node_to_cpus(node, mask) != 0) {
+                continue;
+            }
+            NumaNode entry {node, {}};
+            for (unsigned cpu: allowed) {
+                if (numa_bitmask_isbitset(mask, cpu)) {
+                    entry.cpus.push_back(cpu);
+                }
+            }
+            if (!entry.cpus.empty()) {
+                nodes.push_back(std::move(entry));
+            }
+        }
+        numa_free_cpumask(mask);
+        if (!nodes.empty()) {
+            return nodes;
+        }
+    }
+#endif
+
+    return {NumaNode{-1, allowed}};
+}
+
+/**
+ * @brief Allocates `size` bytes on `node`, untouched.
+ *
+ * @throws std::bad_alloc if the allocation fails.
+ */
+NodeBuffer::NodeBuffer(std::size_t size, const NumaNode& node)
+: m_data(nullptr), m_size(size), m_numa(false) {
+#ifdef HAVE_LIBNUMA
+    if (node.id >= 0 && numaAvailable()) {
+        m_data = static_cast<char*>(numa_alloc_onnode(std::max<std::size_t>(size, 1), node.id));
+        if (!m_data) {
+            throw std::bad_alloc();
+        }
+        m_numa = true;
+        return;
+    }
+#else
+    (void)node;
+#endif
+    m_data = static_cast<char*>(::operator new[](std::max<std::size_t>(size, 1), std::align_val_t(pageSize)));
+}
+
+NodeBuffer::~NodeBuffer() {
+#ifdef HAVE_LIBNUMA
+    if (m_numa) {
+        numa_free(m_data, std::max<std::size_t>(m_size, 1));
+        return;
+    }
+#endif
+    ::operator delete[](m_data, std::align_val_t(pageSize));
+}
+
+/**
+ * @brief Measures memory bandwidth with the STREAM triad a[i] = b[i] + q * c[i].
+ *
+ * The arrays are split into a few ranges per thread; the pool hands ranges out
+ * dynamically, but every thread runs on the node, so the pages stay local whichever
+ * thread first touches them.
+ *
+ * @param pool The threads to measure with, normally pinned to CPUs of `node`.
+ * @param node The node the arrays are placed on.
+ * @param elements Doubles per array.
+ * @param repetitions Timed runs.
+ *
+ * @return The best bandwidth in GB/s (10^9 bytes per second).
+ */
+double streamTriadGBs(ThreadPool& pool, const NumaNode& node, std::size_t elements, unsigned repetitions) {
+    PROFILE_FUNCTION();
+    if (elements == 0 || repetitions == 0) {
+        return 0;
+    }
+
+    NodeBuffer aBuffer(elements * sizeof(double), node);
+    NodeBuffer bBuffer(elements * sizeof(double), node);
+    NodeBuffer cBuffer(elements * sizeof(double), node);
+    double* a = reinterpret_cast<double*>(aBuffer.data());
+    double* b = reinterpret_cast<double*>(bBuffer.data());
+    double* c = reinterpret_cast<double*>(cBuffer.data());
+
+    std::size_t ranges = std::min<std::size_t>(elements, pool.size() * 4);
+    std::size_t rangeSize = (elements + ranges - 1) / ranges;
+    auto forRanges = [&](auto&& body) {
+        pool.parallelFor(ranges, [&](std::size_t range) {
+            std::size_t begin = range * rangeSize;
+            std::size_t end = std::min(begin + rangeSize, elements);
+            body(begin, end);
+        });
+    };
+
+    forRanges([&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            a[i] = 0;
+            b[i] = 1;
+            c[i] = 2;
+        }
+    });
+
+    const double q = 3;
+    double best = 0;
+    for (unsigned r = 0; r < repetitions; r++) {
+        auto start = std::chrono::steady_clock::now();
+        forRanges([&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; i++) {
+                a[i] = b[i] + q * c[i];
+            }
+        });
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        if (seconds > 0) {
+            best = std::max(best, 3 * sizeof(double) * elements / seconds / 1e9);
+        }
+    }
+
+    // read a result back, so the stores cannot be dropped
+    volatile double check = a[elements / 2];
+    (void)check;
+    return best;
+}
@@ -0,0 +1,84 @@
+/*
+ * numaTopology.hpp declares the NUMA view of the machine used by the core-scaling
+ * sweep: the nodes and their CPUs, node-local buffers and a STREAM-style bandwidth probe.
+ */
+
+#ifndef NUMATOPOLOGY_HPP
+#define NUMATOPOLOGY_HPP
+#include <cstddef>
+#include <vector>
+#include "searchFunctions/threadPool.hpp"
+
+/**
+ * @brief A NUMA node and the CPUs of it the process may run on.
+ */
+struct NumaNode {
+    // node number, -1 when the machine is treated as a single node
+    int id;
+    std::vector<unsigned> cpus;
+};
+
+/**
+ * @brief Returns whether node placement is available (built with libnuma and supported by the kernel).
+ */
+bool numaAvailable();
+
+/**
+ * @brief Returns the NUMA nodes that have CPUs in the calling thread's affinity mask.
+ *
+ * Without NUMA support this is a single node with id -1 holding every allowed CPU.
+ * CPUs keep the kernel's numbering, which on common x86 systems lists one hardware
+ * thread of every core before the SMT siblings, so a prefix of a node's CPUs fills
+ * physical cores first.
+ */
+std::vector<NumaNode> numaNodes();
+
+/**
+ * @brief Memory placed on one NUMA node.
+ *
+ * With NUMA support the pages are bound to the node (mbind through numa_alloc_onnode);
+ * otherwise the buffer is an ordinary page-aligned allocation. In both cases the pages
+ * are only committed when first written, so the caller should first-touch them from
+ * threads running on the node, which also places them under the default local policy.
+ */
+class NodeBuffer {
+public:
+    /**
+    * @brief Allocates `size` bytes on `node`, untouched.
+    *
+    * @throws std::bad_alloc if the allocation fails.
+    */
+    NodeBuffer(std::size_t size, const NumaNode& node);
+    ~NodeBuffer();
+
+    NodeBuffer(const NodeBuffer&) = delete;
+    NodeBuffer& operator=(const NodeBuffer&) = delete;
+
+    char* data() { return m_data; }
+    std::size_t size() const { return m_size; }
+
+private:
+    char* m_data;
+    std::size_t m_size;
+    // allocated by libnuma rather than operator new
+    bool m_numa;
+};
+
+/**
+ * @brief Measures memory bandwidth with the STREAM triad a[i] = b[i] + q * c[i].
+ *
+ * The three arrays of `elements` doubles are allocated on `node` and first touched by
+ * the threads of `pool`, which then run the triad `repetitions` times. As in STREAM the
+ * best run is reported and every element counts 24 bytes (two reads, one write, no
+ * write-allocate traffic). The arrays should be several times the last-level cache.
+ *
+ * @param pool The threads to measure with, normally pinned to CPUs of `node`.
+ * @param node The node the arrays are placed on.
+ * @param elements Doubles per array.
+ * @param repetitions Timed runs.
+ *
+ * @return The best bandwidth in GB/s (10^9 bytes per second).
+ */
+double streamTriadGBs(ThreadPool& pool, const NumaNode& node, std::size_t elements, unsigned repetitions);
+
+#endif // NUMATOPOLOGY_HPP
@@ -0,0 +1,437 @@
+/**
+ * @file perfCounters.cpp
+ * @brief Implementation of the hardware performance counter mode.
+ */
+
+#include "perfCounters.hpp"
+#include "searchFunctions/threadPool.hpp"
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+
+#if defined(__linux__)
+#include <cerrno>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define PERFCOUNTERS_LINUX 1
+#else
+#define PERFCOUNTERS_LINUX 0
+#endif
+
+namespace {
+
+/**
+ * @brief perf_event group of one thread, opened on construction and kept for the thread's lifetime.
+ */
+class CounterGroup {
+public:
+    CounterGroup();
+    ~CounterGroup();
+
+    CounterGroup(const CounterGroup&) = delete;
+    CounterGroup& operator=(const CounterGroup&) = delete;
+
+    /**
+    * @brief Returns the running totals, scaled up if the group was multiplexed.
+    */
+    PerfSample read() const;
+
+    /**
+    * @brief Returns the number of events that could be opened.
+    */
+    std::size_t size() const { return m_size; }
+
+    /**
+    * @brief Returns why the first refused event could not be opened.
+    */
+    const std::string& error() const { return m_error; }
+
+private:
+    int m_leader;
+    std::array<int, PerfSample::EventCount> m_fds;
+    // group read order: the leader first, then the members in the order they were opened
+    std::array<PerfSample::Event, PerfSample::EventCount> m_order;
+    std::size_t m_size;
+    std::string m_error;
+};
+
+#if PERFCOUNTERS_LINUX
+
+struct EventSpec {
+    std::uint32_t type;
+    std::uint64_t config;
+};
+
+const EventSpec eventSpecs[PerfSample::EventCount] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+    {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16)},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+};
+
+CounterGroup::CounterGroup()
+: m_leader(-1), m_size(0) {
+    m_fds.fill(-1);
+    for (std::size_t e = 0; e < PerfSample::EventCount; e++) {
+        perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = eventSpecs[e].type;
+        attr.config = eventSpecs[e].config;
+        // the group starts disabled and is enabled as a whole once complete
+        attr.disabled = m_leader < 0 ? 1 : 0;
+        // user space only, which perf_event_paranoid 2 still allows
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        int fd = ::syscall(SYS_perf_event_open, &attr, 0, -1, m_leader, 0);
+        if (fd < 0) {
+            if (m_error.empty()) {
+                m_error = std::string(PerfSample::name(static_cast<PerfSample::Event>(e))) + ": " + std::strerror(errno);
+            }
+            continue;
+        }
+        if (m_leader < 0) {
+            m_leader = fd;
+        }
+        m_fds[e] = fd;
+        m_order[m_size++] = static_cast<PerfSample::Event>(e);
+    }
+
+    if (m_leader >= 0) {
+        ::ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+CounterGroup::~CounterGroup() {
+    for (int fd: m_fds) {
+        if (fd >= 0) {
+            ::close(fd);
+        }
+    }
+}
+
+PerfSample CounterGroup::read() const {
+    PerfSample sample;
+    if (m_leader < 0) {
+        return sample;
+    }
+
+    // nr, time enabled, time running, then one value per event
+    std::uint64_t buffer[3 + PerfSample::EventCount];
+    ssize_t length = ::read(m_leader, buffer, sizeof(buffer));
+    if (length < static_cast<ssize_t>(3 * sizeof(std::uint64_t)) || buffer[2] == 0) {
+        return sample;
+    }
+
+    double scale = buffer[2] < buffer[1] ? static_cast<double>(buffer[1]) / buffer[2] : 1.0;
+    std::size_t count = std::min<std::size_t>(buffer[0], m_size);
+    for (std::size_t i = 0; i < count; i++) {
+        sample.values[m_order[i]] = buffer[3 + i] * scale;
+        sample.valid[m_order[i]] = true;
+    }
+    return sample;
+}
+
+#else
+
+CounterGroup::CounterGroup()
+: m_leader(-1), m_size(0), m_error("perf_event_open is only available on Linux") {
+    m_fds.fill(-1);
+}
+
+CounterGroup::~CounterGroup() {}
+
+PerfSample CounterGroup::read() const {
+    return PerfSample{};
+}
+
+#endif
+
+/**
+ * @brief Returns the calling thread's counter group, opening it on first use.
+ */
+CounterGroup& threadGroup() {
+    thread_local CounterGroup group;
+    return group;
+}
+
+std::string jsonEscape(const std::string& text) {
+    std::string escaped;
+    for (char c: text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+} // namespace
+
+/**
+ * @brief Returns whether any event was counted.
+ */
+bool PerfSample::any() const {
+    for (bool v: valid) {
+        if (v) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Returns instructions per cycle, or 0 if either is missing.
+ */
+double PerfSample::ipc() const {
+    if (!valid[Cycles] || !valid[Instructions] || values[Cycles] <= 0) {
+        return 0;
+    }
+    return values[Instructions] / values[Cycles];
+}
+
+/**
+ * @brief Returns `bytes` per cycle, or 0 if cycles are missing.
+ */
+double PerfSample::bytesPerCycle(std::uint64_t bytes) const {
+    if (!valid[Cycles] || values[Cycles] <= 0) {
+        return 0;
+    }
+    return bytes / values[Cycles];
+}
+
+/**
+ * @brief Returns the per-event mean of `samples`, over the samples that counted the event.
+ */
+PerfSample PerfSample::mean(const std::vector<PerfSample>& samples) {
+    PerfSample result;
+    std::array<std::size_t, EventCount> counts {};
+    for (const auto& sample: samples) {
+        for (std::size_t e = 0; e < EventCount; e++) {
+            if (sample.valid[e]) {
+                result.values[e] += sample.values[e];
+                counts[e]++;
+            }
+        }
+    }
+    for (std::size_t e = 0; e < EventCount; e++) {
+        if (counts[e] > 0) {
+            result.values[e] /= counts[e];
+            result.valid[e] = true;
+        }
+    }
+    return result;
+}
+
+/**
+ * @brief Returns the JSON name of `event`, e.g. "llcMisses".
+ */
+const char* PerfSample::name(Event event) {
+    switch (event) {
+    case Cycles:
+        return "cycles";
+    case Instructions:
+        return "instructions";
+    case L1dMisses:
+        return "l1dMisses";
+    case LlcMisses:
+        return "llcMisses";
+    case BranchMisses:
+        return "branchMisses";
+    default:
+        return "unknown";
+    }
+}
+
+PerfCounters::PerfCounters()
+: m_active(false), m_firstEvent(true) {}
+
+/**
+ * @brief Returns the process-wide counter session.
+ */
+PerfCounters& PerfCounters::Get() {
+    static PerfCounters counters;
+    return counters;
+}
+
+/**
+ * @brief Starts writing counter samples to `fileName`.
+ *
+ * Availability is probed by opening the calling thread's group.
+ *
+ * @param fileName The trace file to write.
+ *
+ * @return false, after printing why, if no hardware counter can be opened.
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+bool PerfCounters::beginSession(const std::string& fileName) {
+    std::lock_guard lock(m_mutex);
+    if (m_active) {
+        return true;
+    }
+
+    CounterGroup& group = threadGroup();
+    if (group.size() == 0) {
+        static bool reported = false;
+        if (!reported) {
+            std::cerr << "Hardware counters unavailable (" << group.error() << "), counter mode disabled" << std::endl;
+            reported = true;
+        }
+        return false;
+    }
+    if (group.size() < PerfSample::EventCount) {
+        std::cerr << "Some hardware counters unavailable (" << group.error() << ")" << std::endl;
+    }
+
+    m_trace.open(fileName);
+    if (!m_trace) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+    m_trace << "{\"otherData\": {},\"traceEvents\":[";
+    m_trace.flush();
+    m_active = true;
+    m_firstEvent = true;
+    return true;
+}
+
+/**
+ * @brief Finishes the trace file. Does nothing without an active session.
+ */
+void PerfCounters::endSession() {
+    std::lock_guard lock(m_mutex);
+    if (!m_active) {
+        return;
+    }
+    m_trace << "]}";
+    m_trace.close();
+    m_active = false;
+}
+
+/**
+ * @brief Reads the running totals of the calling thread's counters, opening them on first use.
+ */
+PerfSample PerfCounters::read() {
+    return threadGroup().read();
+}
+
+/**
+ * @brief Sums the running totals of every thread of ThreadPool::Get(), the caller included.
+ *
+ * The pool runs one read per thread, so each thread reads its own group. An event is
+ * only valid if every thread counted it, otherwise the sum would silently miss threads.
+ */
+PerfSample PerfCounters::readPool() {
+    ThreadPool& pool = ThreadPool::Get();
+    std::vector<PerfSample> samples(pool.size());
+    pool.runOnEveryThread([&samples](std::size_t thread) {
+        samples[thread] = threadGroup().read();
+    });
+
+    PerfSample total;
+    total.valid.fill(true);
+    for (const auto& sample: samples) {
+        for (std::size_t e = 0; e < PerfSample::EventCount; e++) {
+            total.values[e] += sample.values[e];
+            total.valid[e] = total.valid[e] && sample.valid[e];
+        }
+    }
+    return total;
+}
+
+/**
+ * @brief Appends one sample to the trace as a complete event with the counters in "args".
+ *
+ * @param name Scope name.
+ * @param start Start of the scope.
+ * @param duration Length of the scope.
+ * @param sample Counter deltas of the scope.
+ * @param bytes Bytes the scope processed, 0 if unknown.
+ */
+void PerfCounters::record(const std::string& name, std::chrono::steady_clock::time_point start,
+                          std::chrono::steady_clock::duration duration, const PerfSample& sample, std::uint64_t bytes) {
+    using Microseconds = std::chrono::duration<double, std::micro>;
+
+    std::lock_guard lock(m_mutex);
+    if (!m_active) {
+        return;
+    }
+
+    if (!m_firstEvent) {
+        m_trace << ",";
+    }
+    m_firstEvent = false;
+
+    m_trace << std::setprecision(6) << std::fixed
+            << "{\"cat\":\"counters\",\"dur\":" << Microseconds(duration).count()
+            << ",\"name\":\"" << jsonEscape(name) << "\",\"ph\":\"X\",\"pid\":0"
+            << ",\"tid\":" << std::hash<std::thread::id>{}(std::this_thread::get_id())
+            << ",\"ts\":" << Microseconds(start.time_since_epoch()).count()
+            << ",\"args\":{";
+    m_trace << std::setprecision(0);
+    for (std::size_t e = 0; e < PerfSample::EventCount; e++) {
+        if (sample.valid[e]) {
+            m_trace << "\"" << PerfSample::name(static_cast<PerfSample::Event>(e)) << "\":" << sample.values[e] << ",";
+        }
+    }
+    m_trace << std::setprecision(4)
+            << "\"ipc\":" << sample.ipc()
+            << ",\"bytes\":" << bytes
+            << ",\"bytesPerCycle\":" << sample.bytesPerCycle(bytes)
+            << "}}";
+    m_trace << std::defaultfloat;
+}
+
+/**
+ * @brief Starts counting.
+ *
+ * @param name Scope name in the counter trace.
+ * @param bytes Bytes the scope processes, used for bytes per cycle; 0 if unknown.
+ */
+CounterScope::CounterScope(std::string name, std::uint64_t bytes)
+: m_name(std::move(name)), m_bytes(bytes), m_active(PerfCounters::Get().active()), m_stopped(false), m_duration(0) {
+    if (m_active) {
+        m_start = std::chrono::steady_clock::now();
+        m_sample = PerfCounters::Get().readPool();
+    }
+}
+
+/**
+ * @brief Stops counting if still running and records the sample.
+ */
+CounterScope::~CounterScope() {
+    if (!m_active) {
+        return;
+    }
+    stop();
+    PerfCounters::Get().record(m_name, m_start, m_duration, m_sample, m_bytes);
+}
+
+/**
+ * @brief Stops counting; work after this call is not included in the sample.
+ */
+void CounterScope::stop() {
+    if (!m_active || m_stopped) {
+        return;
+    }
+    PerfSample end = PerfCounters::Get().readPool();
+    m_duration = std::chrono::steady_clock::now() - m_start;
+
+    for (std::size_t e = 0; e < PerfSample::EventCount; e++) {
+        bool valid = m_sample.valid[e] && end.valid[e];
+        m_sample.values[e] = valid ? end.values[e] - m_sample.values[e] : 0;
+        m_sample.valid[e] = valid;
+    }
+    m_stopped = true;
+}
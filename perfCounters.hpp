@@ -0,0 +1,187 @@
+/*
+ * perfCounters.hpp declares the hardware performance counters that can be captured
+ * next to the Profiler's wall-clock scopes, read through Linux perf_event_open.
+ */
+
+#ifndef PERFCOUNTERS_HPP
+#define PERFCOUNTERS_HPP
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Counter deltas of one scope, or their mean over several scopes.
+ */
+struct PerfSample {
+    enum Event {
+        Cycles,
+        Instructions,
+        L1dMisses,     // L1 data cache read misses
+        LlcMisses,     // last-level cache misses
+        BranchMisses,
+        EventCount
+    };
+
+    std::array<double, EventCount> values {};
+    // false for events the machine or the container does not expose
+    std::array<bool, EventCount> valid {};
+
+    /**
+    * @brief Returns whether any event was counted.
+    */
+    bool any() const;
+
+    /**
+    * @brief Returns instructions per cycle, or 0 if either is missing.
+    */
+    double ipc() const;
+
+    /**
+    * @brief Returns `bytes` per cycle, or 0 if cycles are missing.
+    */
+    double bytesPerCycle(std::uint64_t bytes) const;
+
+    /**
+    * @brief Returns the per-event mean of `samples`, over the samples that counted the event.
+    */
+    static PerfSample mean(const std::vector<PerfSample>& samples);
+
+    /**
+    * @brief Returns the JSON name of `event`, e.g. "llcMisses".
+    */
+    static const char* name(Event event);
+};
+
+/**
+ * @brief Optional counter mode: collects per-scope counter samples into a trace file.
+ *
+ * Each thread opens its own perf_event group (cycles, instructions, L1D read misses,
+ * LLC misses, branch misses; user space only) the first time it enters a CounterScope
+ * during a session, and keeps it open. Events the kernel refuses are left out; when
+ * none can be opened, e.g. in containers with a restrictive perf_event_paranoid or
+ * seccomp profile, or on platforms other than Linux, beginSession() reports it once and
+ * every CounterScope becomes a no-op. Multiplexed counts are scaled by their running time.
+ *
+ * Samples are written as complete ("X") events in the Chrome trace format the Profiler
+ * uses, with the counters, IPC and bytes per cycle in "args", so the file can be loaded
+ * next to the Profiler's trace. A scope counts the thread it runs on and every worker of
+ * ThreadPool::Get(), so the parallel backends are counted in full; threads outside the
+ * pool, such as those of an OpenCL or Vulkan driver, and work on a device are not.
+ */
+class PerfCounters {
+public:
+    /**
+    * @brief Returns the process-wide counter session.
+    */
+    static PerfCounters& Get();
+
+    /**
+    * @brief Starts writing counter samples to `fileName`.
+    *
+    * @return false, after printing why, if no hardware counter can be opened; the session
+    *         then stays inactive.
+    *
+    * @throws std::runtime_error if the file cannot be opened.
+    */
+    bool beginSession(const std::string& fileName);
+
+    /**
+    * @brief Finishes the trace file. Does nothing without an active session.
+    */
+    void endSession();
+
+    /**
+    * @brief Returns whether a session is collecting samples.
+    */
+    bool active() const { return m_active; }
+
+    /**
+    * @brief Reads the running totals of the calling thread's counters, opening them on first use.
+    */
+    PerfSample read();
+
+    /**
+    * @brief Sums the running totals of every thread of ThreadPool::Get(), the caller included.
+    *
+    * Each thread reads its own counters, opening them on first use. An event is only
+    * valid if every thread counted it.
+    */
+    PerfSample readPool();
+
+    /**
+    * @brief Appends one sample to the trace.
+    *
+    * @param name Scope name.
+    * @param start Start of the scope.
+    * @param duration Length of the scope.
+    * @param sample Counter deltas of the scope.
+    * @param bytes Bytes the scope processed, 0 if unknown.
+    */
+    void record(const std::string& name, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::duration duration, const PerfSample& sample, std::uint64_t bytes);
+
+private:
+    PerfCounters();
+
+private:
+    std::mutex m_mutex;
+    std::ofstream m_trace;
+    bool m_active;
+    bool m_firstEvent;
+};
+
+/**
+ * @brief Captures the counter deltas of a scope and records them when it ends.
+ *
+ * Covers the calling thread and the ThreadPool::Get() workers, see PerfCounters::readPool().
+ * A no-op unless PerfCounters::Get() has an active session.
+ */
+class CounterScope {
+public:
+    /**
+    * @brief Starts counting.
+    *
+    * @param name Scope name in the counter trace.
+    * @param bytes Bytes the scope processes, used for bytes per cycle; 0 if unknown.
+    */
+    explicit CounterScope(std::string name, std::uint64_t bytes = 0);
+
+    /**
+    * @brief Stops counting if still running and records the sample.
+    */
+    ~CounterScope();
+
+    CounterScope(const CounterScope&) = delete;
+    CounterScope& operator=(const CounterScope&) = delete;
+
+    /**
+    * @brief Stops counting; work after this call is not included in the sample.
+    */
+    void stop();
+
+    /**
+    * @brief Sets the bytes recorded with the sample, for sizes only known after the scope's work.
+    */
+    void setBytes(std::uint64_t bytes) { m_bytes = bytes; }
+
+    /**
+    * @brief Returns the counter deltas, complete once stop() was called.
+    */
+    const PerfSample& sample() const { return m_sample; }
+
+private:
+    std::string m_name;
+    std::uint64_t m_bytes;
+    bool m_active;
+    bool m_stopped;
+    std::chrono::steady_clock::time_point m_start;
+    std::chrono::steady_clock::duration m_duration;
+    PerfSample m_sample;
+};
+
+#endif // PERFCOUNTERS_HPP
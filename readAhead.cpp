@@ -0,0 +1,226 @@
+/**
+ * @file readAhead.cpp
+ * @brief Implementation file for InputFile and readAhead().
+ */
+
+#include "readAhead.hpp"
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#if READAHEAD_POSIX
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <filesystem>
+#endif
+
+#if READAHEAD_POSIX
+
+/**
+ * @brief Opens `fileName`, or borrows stdin for "-".
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+InputFile::InputFile(const std::string& fileName, InputFileOptions options)
+: m_name(fileName), m_owned(fileName != "-"), m_size(0), m_fd(STDIN_FILENO), m_direct(false),
+  m_dropReadPages(false), m_offset(0) {
+    if (m_owned) {
+        m_fd = ::open(fileName.c_str(), O_RDONLY);
+        if (m_fd < 0) {
+            throw std::runtime_error("Failed to open file: " + fileName);
+        }
+    }
+
+    // pipes and terminals accept no hint and have no size, so these only apply to regular files
+    struct stat info;
+    if (::fstat(m_fd, &info) != 0 || !S_ISREG(info.st_mode)) {
+        return;
+    }
+    m_size = info.st_size;
+#ifdef O_DIRECT
+    if (options.directIo) {
+        m_direct = ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) | O_DIRECT) == 0;
+    }
+#endif
+    m_dropReadPages = options.dropReadPages;
+#ifdef POSIX_FADV_SEQUENTIAL
+    if (!m_direct) {
+        ::posix_fadvise(m_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    }
+#endif
+}
+
+InputFile::~InputFile() {
+    if (m_owned) {
+        ::close(m_fd);
+    }
+}
+
+/**
+ * @brief Reads up to `size` bytes, returning fewer only at the end of the input.
+ *
+ * @throws std::runtime_error if the read fails.
+ */
+std::size_t InputFile::read(char* buffer, std::size_t size) {
+    std::size_t filled = 0;
+    while (filled < size) {
+        ssize_t count = ::read(m_fd, buffer + filled, size - filled);
+        if (count > 0) {
+            filled += count;
+            continue;
+        }
+        if (count == 0) {
+            break;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+#ifdef O_DIRECT
+        // a short read leaves the offset unaligned for O_DIRECT, continue buffered
+        if (errno == EINVAL && m_direct) {
+            ::fcntl(m_fd, F_SETFL, ::fcntl(m_fd, F_GETFL) & ~O_DIRECT);
+            m_direct = false;
+            continue;
+        }
+#endif
+        throw std::runtime_error("Failed to read file: " + m_name);
+    }
+
+#ifdef POSIX_FADV_DONTNEED
+    // the bytes are in the caller's buffer now, keep the page cache from filling with the stream
+    if (m_dropReadPages && !m_direct && filled > 0) {
+        ::posix_fadvise(m_fd, m_offset, filled, POSIX_FADV_DONTNEED);
+    }
+#endif
+    m_offset += filled;
+    return filled;
+}
+
+#else
+
+/**
+ * @brief Opens `fileName`, or borrows stdin for "-".
+ *
+ * @throws std::runtime_error if the file cannot be opened.
+ */
+InputFile::InputFile(const std::string& fileName, InputFileOptions options)
+: m_name(fileName), m_owned(fileName != "-"), m_size(0), m_file(stdin) {
+    (void)options;
+    if (m_owned) {
+        m_file = std::fopen(fileName.c_str(), "rb");
+        if (!m_file) {
+            throw std::runtime_error("Failed to open file: " + fileName);
+        }
+        std::error_code error;
+        std::uintmax_t size = std::filesystem::file_size(fileName, error);
+        m_size = error ? 0 : size;
+    }
+}
+
+InputFile::~InputFile() {
+    if (m_owned) {
+        std::fclose(m_file);
+    }
+}
+
+/**
+ * @brief Reads up to `size` bytes, returning fewer only at the end of the input.
+ *
+ * @throws std::runtime_error if the read fails.
+ */
+std::size_t InputFile::read(char* buffer, std::size_t size) {
+    std::size_t filled = std::fread(buffer, 1, size, m_file);
+    if (filled < size && std::ferror(m_file)) {
+        throw std::runtime_error("Failed to read file: " + m_name);
+    }
+    return filled;
+}
+
+#endif
+
+/**
+ * @brief Fills a ring of `slotCount` slots on a reader thread while the calling thread consumes them.
+ *
+ * `produced` and `consumed` count slots of the sequence; the reader waits while it is
+ * slotCount slots ahead, the caller while it has caught up. Either side stopping wakes
+ * the other through `finished` or `cancelled`.
+ *
+ * @param slotCount Number of slots, at least 2.
+ * @param fill Fills the given slot and returns whether another slot follows.
+ * @param consume Consumes the given slot.
+ */
+void readAhead(std::size_t slotCount, const std::function<bool(std::size_t)>& fill,
+               const std::function<void(std::size_t)>& consume) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::size_t produced = 0;
+    std::size_t consumed = 0;
+    bool finished = false;
+    bool cancelled = false;
+    std::exception_ptr readError;
+
+    std::thread reader([&]() {
+        try {
+            for (std::size_t slot = 0; ; slot++) {
+                {
+                    std::unique_lock lock(mutex);
+                    changed.wait(lock, [&] { return cancelled || slot - consumed < slotCount; });
+                    if (cancelled) {
+                        break;
+                    }
+                }
+
+                bool more = fill(slot);
+
+                std::lock_guard lock(mutex);
+                produced = slot + 1;
+                changed.notify_all();
+                if (!more) {
+                    break;
+                }
+            }
+        } catch (...) {
+            std::lock_guard lock(mutex);
+            readError = std::current_exception();
+        }
+        std::lock_guard lock(mutex);
+        finished = true;
+        changed.notify_all();
+    });
+
+    try {
+        for (std::size_t slot = 0; ; slot++) {
+            {
+                std::unique_lock lock(mutex);
+                changed.wait(lock, [&] { return produced > slot || finished; });
+                if (produced <= slot) {
+                    break;
+                }
+            }
+
+            consume(slot);
+
+            std::lock_guard lock(mutex);
+            consumed = slot + 1;
+            changed.notify_all();
+        }
+    } catch (...) {
+        {
+            std::lock_guard lock(mutex);
+            cancelled = true;
+            changed.notify_all();
+        }
+        reader.join();
+        throw;
+    }
+
+    reader.join();
+    if (readError) {
+        std::rethrow_exception(readError);
+    }
+}
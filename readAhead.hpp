@@ -0,0 +1,92 @@
+/*
+ * readAhead.hpp declares the input side shared by StreamSearcher and CorpusSearcher: a
+ * sequential file reader and a reader thread that fills a ring of slots ahead of the search.
+ */
+
+#ifndef READAHEAD_HPP
+#define READAHEAD_HPP
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define READAHEAD_POSIX 1
+#else
+#include <cstdio>
+#define READAHEAD_POSIX 0
+#endif
+
+/**
+ * @brief I/O hints of an InputFile.
+ */
+struct InputFileOptions {
+    // read regular files with O_DIRECT, bypassing the page cache; falls back to buffered
+    // reads where the platform or file system does not support it
+    bool directIo = false;
+    // drop the pages of a regular file from the page cache once they have been read
+    bool dropReadPages = false;
+};
+
+/**
+ * @brief Sequential reader over a file, a named pipe or stdin.
+ *
+ * Regular files read buffered are advised to the kernel as read sequentially.
+ */
+class InputFile {
+public:
+    /**
+    * @brief Opens `fileName`, or borrows stdin for "-".
+    *
+    * @throws std::runtime_error if the file cannot be opened.
+    */
+    explicit InputFile(const std::string& fileName, InputFileOptions options = {});
+    ~InputFile();
+
+    InputFile(const InputFile&) = delete;
+    InputFile& operator=(const InputFile&) = delete;
+
+    /**
+    * @brief Returns the size of a regular file when it was opened, 0 for pipes and terminals.
+    */
+    std::uint64_t size() const { return m_size; }
+
+    /**
+    * @brief Reads up to `size` bytes, returning fewer only at the end of the input.
+    *
+    * @throws std::runtime_error if the read fails.
+    */
+    std::size_t read(char* buffer, std::size_t size);
+
+private:
+    std::string m_name;
+    bool m_owned;
+    std::uint64_t m_size;
+#if READAHEAD_POSIX
+    int m_fd;
+    bool m_direct;
+    bool m_dropReadPages;
+    std::uint64_t m_offset;
+#else
+    std::FILE* m_file;
+#endif
+};
+
+/**
+ * @brief Fills a ring of `slotCount` slots on a reader thread while the calling thread consumes them.
+ *
+ * Slot k of the sequence is ring slot k % slotCount. `fill(k)` runs on the reader thread
+ * once slot k - slotCount has been consumed and returns whether another slot follows;
+ * `consume(k)` runs on the calling thread for every filled slot, in order. An exception
+ * from `fill` ends the sequence and is rethrown here after the filled slots have been
+ * consumed; an exception from `consume` stops the reader and is rethrown once it has
+ * stopped.
+ *
+ * @param slotCount Number of slots, at least 2.
+ * @param fill Fills the given slot and returns whether another slot follows.
+ * @param consume Consumes the given slot.
+ */
+void readAhead(std::size_t slotCount, const std::function<bool(std::size_t)>& fill,
+               const std::function<void(std::size_t)>& consume);
+
+#endif // READAHEAD_HPP
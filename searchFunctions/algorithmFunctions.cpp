@@ -0,0 +1,231 @@
+#include "algorithmFunctions.hpp"
+#include "simdFunctions.hpp"
+#include "sinkSearch.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <array>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/*
+ * collects the occurrences as the int offsets of the vector API and stops after the
+ * first one if `firstOnly` is set
+ */
+struct OccurrenceSink {
+    bool firstOnly;
+    std::vector<int> occurrences;
+
+    bool operator()(MatchOffset offset) {
+        occurrences.push_back(static_cast<int>(offset));
+        return !firstOnly;
+    }
+};
+
+using Algorithm = void (*)(std::string_view str, std::string_view subStr, OccurrenceSink& sink);
+
+// simdFindRange stops by itself after the first occurrence, which simdFindAllInto's blocks cannot
+void simd(std::string_view str, std::string_view subStr, OccurrenceSink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    simdFindRange(str, subStr, 0, str.length() - subStr.length() + 1, sink.firstOnly, sink.occurrences);
+}
+
+Algorithm algorithmFor(SearchAlgorithm algorithm) {
+    switch (algorithm) {
+    case SearchAlgorithm::Horspool: return horspoolFindAllInto<OccurrenceSink>;
+    case SearchAlgorithm::Raita: return raitaFindAllInto<OccurrenceSink>;
+    case SearchAlgorithm::TwoWay: return twoWayFindAllInto<OccurrenceSink>;
+    case SearchAlgorithm::ShiftOr: return shiftOrFindAllInto<OccurrenceSink>;
+    case SearchAlgorithm::Simd: return simd;
+    }
+    return horspoolFindAllInto<OccurrenceSink>;
+}
+
+std::vector<int> run(Algorithm algorithm, std::string_view str, std::string_view subStr, bool firstOnly) {
+    OccurrenceSink sink{firstOnly, {}};
+    algorithm(str, subStr, sink);
+    return std::move(sink.occurrences);
+}
+
+int runFirst(Algorithm algorithm, std::string_view str, std::string_view subStr) {
+    std::vector<int> occurrences = run(algorithm, str, subStr, true);
+    return occurrences.empty() ? -1 : occurrences.front();
+}
+
+} // namespace
+
+/*
+ * Boyer-Moore-Horspool search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int horspoolFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return runFirst(horspoolFindAllInto<OccurrenceSink>, str, subStr);
+}
+
+/*
+ * Boyer-Moore-Horspool search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> horspoolFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return run(horspoolFindAllInto<OccurrenceSink>, str, subStr, false);
+}
+
+/*
+ * Raita search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int raitaFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return runFirst(raitaFindAllInto<OccurrenceSink>, str, subStr);
+}
+
+/*
+ * Raita search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> raitaFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return run(raitaFindAllInto<OccurrenceSink>, str, subStr, false);
+}
+
+/*
+ * Crochemore-Perrin Two-Way search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int twoWayFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return runFirst(twoWayFindAllInto<OccurrenceSink>, str, subStr);
+}
+
+/*
+ * Crochemore-Perrin Two-Way search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> twoWayFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return run(twoWayFindAllInto<OccurrenceSink>, str, subStr, false);
+}
+
+/*
+ * bit-parallel Shift-Or search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int shiftOrFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return runFirst(shiftOrFindAllInto<OccurrenceSink>, str, subStr);
+}
+
+/*
+ * bit-parallel Shift-Or search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> shiftOrFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return run(shiftOrFindAllInto<OccurrenceSink>, str, subStr, false);
+}
+
+/*
+ * picks the algorithm for a needle from its length and the number of distinct bytes in it
+ *
+ * @param subStr : the substring to search for
+ *
+ * @return the algorithm adaptiveFind and adaptiveFindAll run for this needle
+ */
+SearchAlgorithm selectAlgorithm(std::string_view subStr) {
+    std::array<bool, 256> seen {};
+    std::size_t distinct = 0;
+    for (unsigned char c: subStr) {
+        if (!seen[c]) {
+            seen[c] = true;
+            distinct++;
+        }
+    }
+
+    if (distinct <= 4) {
+        return subStr.length() <= 64 ? SearchAlgorithm::ShiftOr : SearchAlgorithm::TwoWay;
+    }
+    if (subStr.length() < 16) {
+        return std::strcmp(simdImplementationName(), "scalar") != 0 ? SearchAlgorithm::Simd : SearchAlgorithm::ShiftOr;
+    }
+    return SearchAlgorithm::Horspool;
+}
+
+/*
+ * @return the name of the algorithm
+ */
+const char* algorithmName(SearchAlgorithm algorithm) {
+    switch (algorithm) {
+    case SearchAlgorithm::Horspool: return "horspool";
+    case SearchAlgorithm::Raita: return "raita";
+    case SearchAlgorithm::TwoWay: return "twoWay";
+    case SearchAlgorithm::ShiftOr: return "shiftOr";
+    case SearchAlgorithm::Simd: return "simd";
+    }
+    return "unknown";
+}
+
+/*
+ * search that returns the index of the first occurrence of the substring in the string
+ * with the algorithm chosen by selectAlgorithm
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int adaptiveFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return runFirst(algorithmFor(selectAlgorithm(subStr)), str, subStr);
+}
+
+/*
+ * search that returns the index of every occurrence of the substring in the string
+ * with the algorithm chosen by selectAlgorithm
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> adaptiveFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return run(algorithmFor(selectAlgorithm(subStr)), str, subStr, false);
+}
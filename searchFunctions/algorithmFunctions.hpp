@@ -0,0 +1,151 @@
+#ifndef ALGORITHM_FUNCTIONS_HPP
+#define ALGORITHM_FUNCTIONS_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Classic single-pattern search algorithms and a dispatcher that picks one of them per
+ * needle. Horspool and Raita skip ahead by a bad-character shift and are sublinear on
+ * large alphabets, Two-Way is linear in the worst case with constant extra space, and
+ * Shift-Or tracks all partial matches in one machine word. Every *FindAll function
+ * reports overlapping occurrences, like standardFindAll.
+ */
+
+/*
+ * algorithms adaptiveFind and adaptiveFindAll can dispatch to
+ */
+enum class SearchAlgorithm {
+    Horspool,
+    Raita,
+    TwoWay,
+    ShiftOr,
+    Simd
+};
+
+/*
+ * Boyer-Moore-Horspool search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int horspoolFind(std::string_view str, std::string_view subStr);
+
+/*
+ * Boyer-Moore-Horspool search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> horspoolFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * Raita search (Horspool shifts, last, first and middle byte checked before the rest)
+ * that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int raitaFind(std::string_view str, std::string_view subStr);
+
+/*
+ * Raita search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> raitaFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * Crochemore-Perrin Two-Way search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int twoWayFind(std::string_view str, std::string_view subStr);
+
+/*
+ * Crochemore-Perrin Two-Way search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> twoWayFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * bit-parallel Shift-Or search that returns the index of the first occurrence of the substring in the string
+ *
+ * Needles longer than 64 bytes are filtered on their first 64 bytes and then verified.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int shiftOrFind(std::string_view str, std::string_view subStr);
+
+/*
+ * bit-parallel Shift-Or search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> shiftOrFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * picks the algorithm for a needle from its length and the number of distinct bytes in it
+ *
+ * Needles over a small alphabet (4 distinct bytes or fewer, e.g. DNA) make first/last
+ * byte filters fire constantly and bad-character shifts short, so they go to Shift-Or
+ * up to 64 bytes and to Two-Way beyond. Other needles shorter than 16 bytes use the
+ * SIMD first/last byte filter when the CPU has vector support (Shift-Or otherwise),
+ * and longer ones use Horspool, whose shifts approach the needle length.
+ *
+ * @param subStr : the substring to search for
+ *
+ * @return the algorithm adaptiveFind and adaptiveFindAll run for this needle
+ */
+SearchAlgorithm selectAlgorithm(std::string_view subStr);
+
+/*
+ * @return the name of the algorithm ("horspool", "raita", "twoWay", "shiftOr" or "simd")
+ */
+const char* algorithmName(SearchAlgorithm algorithm);
+
+/*
+ * search that returns the index of the first occurrence of the substring in the string
+ * with the algorithm chosen by selectAlgorithm
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int adaptiveFind(std::string_view str, std::string_view subStr);
+
+/*
+ * search that returns the index of every occurrence of the substring in the string
+ * with the algorithm chosen by selectAlgorithm
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> adaptiveFindAll(std::string_view str, std::string_view subStr);
+
+#endif // ALGORITHM_FUNCTIONS_HPP
@@ -0,0 +1,297 @@
+#include "approximateFunctions.hpp"
+#include "threadPool.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Rejects distances that are negative or would let every window match.
+ *
+ * @throws std::invalid_argument if `maxDistance` is negative or not below the pattern length.
+ */
+void checkDistance(std::string_view pattern, int maxDistance) {
+    if (maxDistance < 0 || static_cast<std::size_t>(maxDistance) >= pattern.length()) {
+        throw std::invalid_argument("Maximum distance must be non-negative and below the pattern length.");
+    }
+}
+
+/**
+ * @brief A pattern preprocessed for Myers' bit-vector algorithm, 64 pattern positions per block.
+ */
+class MyersPattern {
+public:
+    explicit MyersPattern(std::string_view pattern)
+    : m_length(pattern.length()), m_blocks((pattern.length() + 63) / 64), m_peq(256 * m_blocks, 0),
+      m_lastBit(std::uint64_t(1) << ((pattern.length() - 1) % 64)) {
+        for (std::size_t i = 0; i < m_length; i++) {
+            m_peq[static_cast<unsigned char>(pattern[i]) * m_blocks + i / 64] |= std::uint64_t(1) << (i % 64);
+        }
+    }
+
+    /**
+     * @brief Scans str[begin, end) from a fresh column and appends every end position at or
+     * after `reportFrom` whose distance is at most `maxEdits`.
+     *
+     * The matches are appended with their end position as offset.
+     */
+    void scan(std::string_view str, std::size_t begin, std::size_t reportFrom, std::size_t end,
+              int maxEdits, std::vector<ApproximateMatch>& ends) const {
+        // vertical deltas of the column: +1 in vp, -1 in vn, 0 elsewhere
+        std::vector<std::uint64_t> vp(m_blocks, ~std::uint64_t(0));
+        std::vector<std::uint64_t> vn(m_blocks, 0);
+        int score = m_length;
+
+        for (std::size_t j = begin; j < end; j++) {
+            const std::uint64_t* peq = &m_peq[static_cast<unsigned char>(str[j]) * m_blocks];
+            // the top row is all zeros, a match may start anywhere
+            int carry = 0;
+            for (std::size_t b = 0; b < m_blocks; b++) {
+                std::uint64_t eq = peq[b];
+                std::uint64_t xv = eq | vn[b];
+                if (carry < 0) {
+                    eq |= 1;
+                }
+                std::uint64_t xh = (((eq & vp[b]) + vp[b]) ^ vp[b]) | eq;
+                std::uint64_t hp = vn[b] | ~(xh | vp[b]);
+                std::uint64_t hn = vp[b] & xh;
+
+                std::uint64_t high = b + 1 == m_blocks ? m_lastBit : std::uint64_t(1) << 63;
+                int carryOut = (hp & high) ? 1 : (hn & high) ? -1 : 0;
+
+                hp <<= 1;
+                hn <<= 1;
+                if (carry < 0) {
+                    hn |= 1;
+                } else if (carry > 0) {
+                    hp |= 1;
+                }
+                vp[b] = hn | ~(xv | hp);
+                vn[b] = hp & xv;
+                carry = carryOut;
+            }
+            score += carry;
+
+            if (j >= reportFrom && score <= maxEdits) {
+                ends.push_back(ApproximateMatch{static_cast<int>(j), score});
+            }
+        }
+    }
+
+private:
+    std::size_t m_length;
+    std::size_t m_blocks;
+    // m_peq[c * m_blocks + b] has bit i set if pattern[64 * b + i] == c
+    std::vector<std::uint64_t> m_peq;
+    std::uint64_t m_lastBit;
+};
+
+/**
+ * @brief Returns the start of the shortest alignment of `pattern` ending at `end` with `distance` edits.
+ *
+ * Runs the edit distance DP backwards from `end`, anchored there, one text byte per
+ * column, until the whole pattern is aligned at `distance`. `column` is scratch space.
+ */
+int startOf(std::string_view str, std::string_view pattern, std::size_t end, int distance, std::vector<int>& column) {
+    std::size_t m = pattern.length();
+    column.resize(m + 1);
+    for (std::size_t i = 0; i <= m; i++) {
+        column[i] = i;
+    }
+
+    std::size_t maxLength = std::min(end + 1, m + distance);
+    for (std::size_t c = 1; c <= maxLength; c++) {
+        char t = str[end + 1 - c];
+        int diagonal = column[0];
+        column[0] = c;
+        for (std::size_t i = 1; i <= m; i++) {
+            int substitution = diagonal + (pattern[m - i] != t ? 1 : 0);
+            diagonal = column[i];
+            column[i] = std::min({column[i] + 1, column[i - 1] + 1, substitution});
+        }
+        if (column[m] == distance) {
+            return end + 1 - c;
+        }
+    }
+    // unreachable for distances reported by MyersPattern::scan()
+    return end + 1 > m ? end + 1 - m : 0;
+}
+
+/**
+ * @brief Replaces the end positions in `matches` by their start positions.
+ */
+void resolveStarts(std::string_view str, std::string_view pattern, std::vector<ApproximateMatch>& matches) {
+    std::vector<int> column;
+    for (auto& match: matches) {
+        match.offset = startOf(str, pattern, match.offset, match.distance, column);
+    }
+}
+
+/**
+ * @brief Sorts matches and keeps the smallest distance per start offset.
+ */
+void uniqueStarts(std::vector<ApproximateMatch>& matches) {
+    std::sort(matches.begin(), matches.end());
+    matches.erase(std::unique(matches.begin(), matches.end(),
+                              [](const ApproximateMatch& lhs, const ApproximateMatch& rhs) { return lhs.offset == rhs.offset; }),
+                  matches.end());
+}
+
+} // namespace
+
+/**
+ * @brief Orders matches by offset, then distance.
+ */
+bool operator<(const ApproximateMatch& lhs, const ApproximateMatch& rhs) {
+    if (lhs.offset != rhs.offset) {
+        return lhs.offset < rhs.offset;
+    }
+    return lhs.distance < rhs.distance;
+}
+
+/*
+ * k-mismatch search with the bit-parallel Shift-Add algorithm
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxMismatches : the largest Hamming distance reported
+ *
+ * @return every offset within maxMismatches mismatches, with its mismatch count, in ascending order
+ */
+std::vector<ApproximateMatch> shiftAddFindAll(std::string_view str, std::string_view pattern, int maxMismatches) {
+    PROFILE_FUNCTION();
+    if (pattern.empty()) {
+        return {};
+    }
+    checkDistance(pattern, maxMismatches);
+    if (pattern.length() > str.length()) {
+        return {};
+    }
+
+    std::size_t m = pattern.length();
+    std::vector<ApproximateMatch> matches;
+
+    // counter bits for values up to maxMismatches, plus the overflow bit
+    unsigned fieldBits = std::bit_width(static_cast<unsigned>(maxMismatches)) + 1;
+    if (m * fieldBits > 64) {
+        for (std::size_t i = 0; i + m <= str.length(); i++) {
+            int mismatches = 0;
+            for (std::size_t j = 0; j < m && mismatches <= maxMismatches; j++) {
+                mismatches += str[i + j] != pattern[j] ? 1 : 0;
+            }
+            if (mismatches <= maxMismatches) {
+                matches.push_back(ApproximateMatch{static_cast<int>(i), mismatches});
+            }
+        }
+        return matches;
+    }
+
+    // table[c] has a 1 in the counter of every pattern position that is not c
+    std::uint64_t ones = 0;
+    for (std::size_t j = 0; j < m; j++) {
+        ones |= std::uint64_t(1) << (j * fieldBits);
+    }
+    std::uint64_t table[256];
+    std::fill(std::begin(table), std::end(table), ones);
+    for (std::size_t j = 0; j < m; j++) {
+        table[static_cast<unsigned char>(pattern[j])] &= ~(std::uint64_t(1) << (j * fieldBits));
+    }
+
+    std::uint64_t overflowMask = ones << (fieldBits - 1);
+    std::uint64_t stateMask = m * fieldBits == 64 ? ~std::uint64_t(0) : (std::uint64_t(1) << (m * fieldBits)) - 1;
+    std::uint64_t counterMask = (std::uint64_t(1) << (fieldBits - 1)) - 1;
+    unsigned lastShift = (m - 1) * fieldBits;
+
+    // counter j holds the mismatches of pattern[0, j] against the text ending at the current byte
+    std::uint64_t state = 0;
+    std::uint64_t overflow = 0;
+    for (std::size_t i = 0; i < str.length(); i++) {
+        state = ((state << fieldBits) + table[static_cast<unsigned char>(str[i])]) & stateMask;
+        // an overflowed counter is cleared, its overflow bit travels with it
+        overflow = ((overflow << fieldBits) | (state & overflowMask)) & stateMask;
+        state &= ~overflowMask;
+
+        if (i + 1 >= m && ((overflow >> lastShift) & ~counterMask) == 0) {
+            int mismatches = (state >> lastShift) & counterMask;
+            if (mismatches <= maxMismatches) {
+                matches.push_back(ApproximateMatch{static_cast<int>(i + 1 - m), mismatches});
+            }
+        }
+    }
+    return matches;
+}
+
+/*
+ * k-edit search with Myers' bit-vector algorithm
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxEdits : the largest edit distance reported
+ *
+ * @return one match per start offset with its smallest distance, in ascending order
+ */
+std::vector<ApproximateMatch> myersFindAll(std::string_view str, std::string_view pattern, int maxEdits) {
+    PROFILE_FUNCTION();
+    if (pattern.empty()) {
+        return {};
+    }
+    checkDistance(pattern, maxEdits);
+
+    MyersPattern myers(pattern);
+    std::vector<ApproximateMatch> matches;
+    myers.scan(str, 0, 0, str.length(), maxEdits, matches);
+    resolveStarts(str, pattern, matches);
+    uniqueStarts(matches);
+    return matches;
+}
+
+/*
+ * multi-threaded myersFindAll
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxEdits : the largest edit distance reported
+ *
+ * @return the same matches as myersFindAll
+ */
+std::vector<ApproximateMatch> parallelMyersFindAll(std::string_view str, std::string_view pattern, int maxEdits) {
+    PROFILE_FUNCTION();
+    if (pattern.empty()) {
+        return {};
+    }
+    checkDistance(pattern, maxEdits);
+    if (str.empty()) {
+        return {};
+    }
+
+    MyersPattern myers(pattern);
+    std::size_t ranges = std::clamp<std::size_t>(ThreadPool::Get().size(), 1, str.length());
+    std::size_t rangeSize = (str.length() + ranges - 1) / ranges;
+    // the longest alignment within maxEdits spans this many bytes before its end
+    std::size_t reach = pattern.length() + maxEdits - 1;
+
+    // every range owns the matches that end inside it
+    std::vector<std::vector<ApproximateMatch>> rangeResults(ranges);
+    ThreadPool::Get().parallelFor(ranges, [&](std::size_t range) {
+        std::size_t begin = range * rangeSize;
+        std::size_t end = std::min(begin + rangeSize, str.length());
+        if (begin >= end) {
+            return;
+        }
+        std::size_t scanBegin = begin > reach ? begin - reach : 0;
+        myers.scan(str, scanBegin, begin, end, maxEdits, rangeResults[range]);
+        resolveStarts(str, pattern, rangeResults[range]);
+    });
+
+    std::vector<ApproximateMatch> matches;
+    for (auto& result: rangeResults) {
+        matches.insert(matches.end(), result.begin(), result.end());
+    }
+    uniqueStarts(matches);
+    return matches;
+}
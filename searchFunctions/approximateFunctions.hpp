@@ -0,0 +1,80 @@
+#ifndef APPROXIMATE_FUNCTIONS_HPP
+#define APPROXIMATE_FUNCTIONS_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief One approximate occurrence of a pattern: where it starts and how far it is from the pattern.
+ *
+ * Layout matches an OpenCL int2, so device results can be read back directly.
+ */
+struct ApproximateMatch {
+    int offset;
+    int distance;
+
+    bool operator==(const ApproximateMatch&) const = default;
+};
+
+/**
+ * @brief Orders matches by offset, then distance. All approximate backends return this order.
+ */
+bool operator<(const ApproximateMatch& lhs, const ApproximateMatch& rhs);
+
+/*
+ * k-mismatch search with the bit-parallel Shift-Add algorithm (Baeza-Yates and Gonnet)
+ *
+ * Every pattern position keeps a mismatch counter of just enough bits for
+ * maxMismatches plus an overflow bit, all packed into one 64-bit word that is shifted
+ * and added once per text byte. Patterns whose counters do not fit in 64 bits fall back
+ * to counting mismatches per offset, stopping after maxMismatches + 1.
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxMismatches : the largest Hamming distance reported
+ *
+ * @return every offset whose pattern-length window differs from the pattern in at most
+ *         maxMismatches bytes, with that number of mismatches, in ascending order
+ *
+ * @throws std::invalid_argument if maxMismatches is negative or not below the pattern length
+ */
+std::vector<ApproximateMatch> shiftAddFindAll(std::string_view str, std::string_view pattern, int maxMismatches);
+
+/*
+ * k-edit search with Myers' bit-vector algorithm, in Hyyrö's multi-word form
+ *
+ * The column of the edit distance matrix is kept as vertical delta bit-vectors of
+ * 64 pattern positions per word, so every text byte costs O(pattern length / 64) word
+ * operations. An end position whose best alignment has at most maxEdits edits is
+ * traced back to the start of its shortest alignment with that distance.
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxEdits : the largest edit (Levenshtein) distance reported
+ *
+ * @return one match per start offset, with the smallest distance of any alignment
+ *         found starting there, in ascending order
+ *
+ * @throws std::invalid_argument if maxEdits is negative or not below the pattern length
+ */
+std::vector<ApproximateMatch> myersFindAll(std::string_view str, std::string_view pattern, int maxEdits);
+
+/*
+ * multi-threaded myersFindAll
+ *
+ * The string is split into one range of end positions per thread of ThreadPool::Get().
+ * Every range starts scanning pattern length + maxEdits - 1 bytes early, which is as far
+ * back as an alignment within maxEdits can reach, so the ranges report exactly the
+ * matches of the sequential scan.
+ *
+ * @param str : the string to search in
+ * @param pattern : the pattern to search for
+ * @param maxEdits : the largest edit (Levenshtein) distance reported
+ *
+ * @return the same matches as myersFindAll
+ *
+ * @throws std::invalid_argument if maxEdits is negative or not below the pattern length
+ */
+std::vector<ApproximateMatch> parallelMyersFindAll(std::string_view str, std::string_view pattern, int maxEdits);
+
+#endif // APPROXIMATE_FUNCTIONS_HPP
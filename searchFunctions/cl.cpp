@@ -1,198 +1,2393 @@
 #include "performance-analyzer/performance-analyzer.hpp"
+#include "cl.hpp"
 #include <vector>
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <climits>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <sys/types.h>
+#include <string>
+
+namespace {
+
+// LOCAL_SIZE is passed as a build option and must be a power of two.
+const std::string kernelSource = R"(
+    // Returns 1 if 'substr' occurs at position `i` of 'str'.
+    int matchAt(__global const char* str,
+                __constant const char* substr,
+                int i,
+                int strLen,
+                int subLen)
+    {
+        if (i > strLen - subLen) {
+            return 0;
+        }
+        for (int j = 0; j < subLen; ++j) {
+            if (str[i + j] != substr[j]) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    // Pass 2a (pass 1 and 3 live in stripSearchSource): work-efficient exclusive scan of 2 * LOCAL_SIZE elements per work-group.
+    __kernel void scanBlocks(__global int* data,
+                             __global int* blockSums,
+                             int n)
+    {
+        __local int temp[2 * LOCAL_SIZE];
+        int lid = get_local_id(0);
+        int base = get_group_id(0) * 2 * LOCAL_SIZE;
+        int ai = lid;
+        int bi = lid + LOCAL_SIZE;
+
+        temp[ai] = (base + ai < n) ? data[base + ai] : 0;
+        temp[bi] = (base + bi < n) ? data[base + bi] : 0;
+
+        // up-sweep
+        int offset = 1;
+        for (int d = LOCAL_SIZE; d > 0; d >>= 1) {
+            barrier(CLK_LOCAL_MEM_FENCE);
+            if (lid < d) {
+                int a = offset * (2 * lid + 1) - 1;
+                int b = offset * (2 * lid + 2) - 1;
+                temp[b] += temp[a];
+            }
+            offset <<= 1;
+        }
+
+        if (lid == 0) {
+            blockSums[get_group_id(0)] = temp[2 * LOCAL_SIZE - 1];
+            temp[2 * LOCAL_SIZE - 1] = 0;
+        }
+
+        // down-sweep
+        for (int d = 1; d <= LOCAL_SIZE; d <<= 1) {
+            offset >>= 1;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            if (lid < d) {
+                int a = offset * (2 * lid + 1) - 1;
+                int b = offset * (2 * lid + 2) - 1;
+                int t = temp[a];
+                temp[a] = temp[b];
+                temp[b] += t;
+            }
+        }
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        if (base + ai < n) data[base + ai] = temp[ai];
+        if (base + bi < n) data[base + bi] = temp[bi];
+    }
+
+    // Pass 2b: adds the scanned block totals back onto every block.
+    __kernel void addBlockOffsets(__global int* data,
+                                  __global const int* blockOffsets,
+                                  int n)
+    {
+        int base = get_group_id(0) * 2 * LOCAL_SIZE;
+        int offset = blockOffsets[get_group_id(0)];
+        int ai = base + get_local_id(0);
+        int bi = ai + LOCAL_SIZE;
+
+        if (ai < n) data[ai] += offset;
+        if (bi < n) data[bi] += offset;
+    }
+
+    // Returns the number of mismatches of 'substr' at position `i` of 'str', counting
+    // only up to maxMismatches + 1.
+    int mismatchesAt(__global const char* str,
+                     __constant const char* substr,
+                     int i,
+                     int subLen,
+                     int maxMismatches)
+    {
+        int mismatches = 0;
+        for (int j = 0; j < subLen && mismatches <= maxMismatches; ++j) {
+            mismatches += str[i + j] != substr[j];
+        }
+        return mismatches;
+    }
+
+    // Pass 1 of the k-mismatch find-all: one start position per work-item.
+    __kernel void countHammingMatches(__global const char* str,
+                                      __constant const char* substr,
+                                      __global int* groupCounts,
+                                      int strLen,
+                                      int subLen,
+                                      int maxMismatches)
+    {
+        __local int scratch[LOCAL_SIZE];
+        int i = get_global_id(0);
+        int lid = get_local_id(0);
+
+        scratch[lid] = (i <= strLen - subLen && mismatchesAt(str, substr, i, subLen, maxMismatches) <= maxMismatches) ? 1 : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = LOCAL_SIZE / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                scratch[lid] += scratch[lid + s];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            groupCounts[get_group_id(0)] = scratch[0];
+        }
+    }
+
+    // Pass 3 of the k-mismatch find-all: writes (offset, distance) of every match at its scanned slot.
+    __kernel void scatterHammingMatches(__global const char* str,
+                                        __constant const char* substr,
+                                        __global const int* groupOffsets,
+                                        __global int2* outMatches,
+                                        int strLen,
+                                        int subLen,
+                                        int maxMismatches)
+    {
+        __local int ranks[LOCAL_SIZE];
+        int i = get_global_id(0);
+        int lid = get_local_id(0);
+        int group = get_group_id(0);
+
+        if (groupOffsets[group + 1] == groupOffsets[group]) {
+            return;
+        }
+
+        int distance = (i <= strLen - subLen) ? mismatchesAt(str, substr, i, subLen, maxMismatches) : maxMismatches + 1;
+        int hit = distance <= maxMismatches ? 1 : 0;
+        ranks[lid] = hit;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int offset = 1; offset < LOCAL_SIZE; offset <<= 1) {
+            int v = (lid >= offset) ? ranks[lid - offset] : 0;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            ranks[lid] += v;
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (hit) {
+            outMatches[groupOffsets[group] + ranks[lid] - 1] = (int2)(i, distance);
+        }
+    }
+
+    // One wave of the first-match search: start positions waveStart .. waveStart + global size - 1.
+    // Positions past the smallest match found so far, by this or an earlier wave, are skipped.
+    __kernel void searchFirst(__global const char* str,
+                              __constant const char* substr,
+                              __global int* firstMatch,
+                              int strLen,
+                              int subLen,
+                              int waveStart)
+    {
+        int i = waveStart + get_global_id(0);
+
+        if (i < *firstMatch && matchAt(str, substr, i, strLen, subLen)) {
+            atomic_min(firstMatch, i);
+        }
+    }
+  )";
+
+// Count (pass 1) and scatter (pass 3) kernels of the single-pattern and batched find-all,
+// built once per ClKernelConfig. Each work-item scans STRIP consecutive start positions. With TILED
+// the work-group first copies its text plus the subLen - 1 byte halo into __local memory
+// and scans it from there; with VECTORIZED 16 bytes at a time are compared against the
+// pattern's first byte through char16 loads and only the hits are verified.
+const std::string stripSearchSource = R"(
+    #if TILED
+    #define TEXT_SPACE __local
+    #else
+    #define TEXT_SPACE __global
+    #endif
+
+    // Returns 1 if 'substr' occurs at position `i` of 'text', given that the first byte matched.
+    int verifyAt(TEXT_SPACE const char* text,
+                 __constant const char* substr,
+                 int i,
+                 int subLen)
+    {
+        for (int j = 1; j < subLen; ++j) {
+            if (text[i + j] != substr[j]) {
+                return 0;
+            }
+        }
+        return 1;
+    }
+
+    // Counts the matches starting in [begin, end) of 'text'. When 'out' is not null they
+    // are also written, offset by `base`, to out[slot], out[slot + 1], ... in ascending order.
+    int stripMatches(TEXT_SPACE const char* text,
+                     __constant const char* substr,
+                     int begin,
+                     int end,
+                     int subLen,
+                     int base,
+                     __global int* out,
+                     int slot)
+    {
+        int count = 0;
+        char first = substr[0];
+        int i = begin;
+    #if VECTORIZED
+        for (; i + 16 <= end; i += 16) {
+            char16 hits = vload16(0, text + i) == (char16)(first);
+            if (!any(hits)) {
+                continue;
+            }
+            char flags[16];
+            vstore16(hits, 0, flags);
+            for (int k = 0; k < 16; ++k) {
+                if (flags[k] && verifyAt(text, substr, i + k, subLen)) {
+                    if (out) {
+                        out[slot + count] = base + i + k;
+                    }
+                    count++;
+                }
+            }
+        }
+    #endif
+        for (; i < end; ++i) {
+            if (text[i] == first && verifyAt(text, substr, i, subLen)) {
+                if (out) {
+                    out[slot + count] = base + i;
+                }
+                count++;
+            }
+        }
+        return count;
+    }
+
+    // Returns the text of the group starting at `groupStart`, staged in 'tile' when TILED.
+    // 'tile' must then hold LOCAL_SIZE * STRIP + subLen - 1 bytes.
+    TEXT_SPACE const char* groupText(__global const char* str,
+                                     __local char* tile,
+                                     int groupStart,
+                                     int strLen,
+                                     int subLen)
+    {
+    #if TILED
+        int length = min(LOCAL_SIZE * STRIP + subLen - 1, strLen - groupStart);
+        event_t copy = async_work_group_copy(tile, str + groupStart, length, 0);
+        wait_group_events(1, &copy);
+        return tile;
+    #else
+        return str + groupStart;
+    #endif
+    }
+
+    // Writes the number of matches starting in the group's range to groupCounts[group].
+    void countGroup(__global const char* str,
+                    __constant const char* substr,
+                    __global int* groupCounts,
+                    __local char* tile,
+                    __local int* scratch,
+                    int group,
+                    int groupStart,
+                    int strLen,
+                    int subLen)
+    {
+        int lid = get_local_id(0);
+        int begin = lid * STRIP;
+        int end = min(begin + STRIP, strLen - subLen + 1 - groupStart);
+
+        TEXT_SPACE const char* text = groupText(str, tile, groupStart, strLen, subLen);
+        scratch[lid] = stripMatches(text, substr, begin, end, subLen, groupStart, 0, 0);
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = LOCAL_SIZE / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                scratch[lid] += scratch[lid + s];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            groupCounts[group] = scratch[0];
+        }
+    }
+
+    // Every strip writes its matches to the group offset plus the strip's rank within the group.
+    void scatterGroup(__global const char* str,
+                      __constant const char* substr,
+                      __global const int* groupOffsets,
+                      __global int* outMatches,
+                      __local char* tile,
+                      __local int* ranks,
+                      int group,
+                      int groupStart,
+                      int strLen,
+                      int subLen)
+    {
+        int lid = get_local_id(0);
+
+        // groups without matches leave together, before any barrier
+        if (groupOffsets[group + 1] == groupOffsets[group]) {
+            return;
+        }
+
+        int begin = lid * STRIP;
+        int end = min(begin + STRIP, strLen - subLen + 1 - groupStart);
+
+        TEXT_SPACE const char* text = groupText(str, tile, groupStart, strLen, subLen);
+        int count = stripMatches(text, substr, begin, end, subLen, groupStart, 0, 0);
+        ranks[lid] = count;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        // inclusive Hillis-Steele scan of the strip counts
+        for (int offset = 1; offset < LOCAL_SIZE; offset <<= 1) {
+            int v = (lid >= offset) ? ranks[lid - offset] : 0;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            ranks[lid] += v;
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (count > 0) {
+            stripMatches(text, substr, begin, end, subLen, groupStart, outMatches, groupOffsets[group] + ranks[lid] - count);
+        }
+    }
+
+    // Pass 1: each work-group writes the number of matches that start in its range.
+    __kernel void countStripMatches(__global const char* str,
+                                    __constant const char* substr,
+                                    __global int* groupCounts,
+                                    int strLen,
+                                    int subLen,
+                                    __local char* tile)
+    {
+        __local int scratch[LOCAL_SIZE];
+        int group = get_group_id(0);
+        countGroup(str, substr, groupCounts, tile, scratch, group, group * LOCAL_SIZE * STRIP, strLen, subLen);
+    }
+
+    // Pass 3: writes the matches of each work-group at its scanned offset.
+    __kernel void scatterStripMatches(__global const char* str,
+                                      __constant const char* substr,
+                                      __global const int* groupOffsets,
+                                      __global int* outMatches,
+                                      int strLen,
+                                      int subLen,
+                                      __local char* tile)
+    {
+        __local int ranks[LOCAL_SIZE];
+        int group = get_group_id(0);
+        scatterGroup(str, substr, groupOffsets, outMatches, tile, ranks, group, group * LOCAL_SIZE * STRIP, strLen, subLen);
+    }
+
+    // Batched passes 1 and 3: the NDRange holds groupsPerQuery work-groups per query,
+    // query-major, so the scanned offsets of one query are contiguous and the matches
+    // come out grouped by query, each query in ascending order. Query q is the pattern
+    // patterns[patternOffsets[q]] .. patterns[patternOffsets[q + 1] - 1].
+    __kernel void countBatchMatches(__global const char* str,
+                                    __constant const char* patterns,
+                                    __constant const int* patternOffsets,
+                                    __global int* groupCounts,
+                                    int strLen,
+                                    int groupsPerQuery,
+                                    __local char* tile)
+    {
+        __local int scratch[LOCAL_SIZE];
+        int group = get_group_id(0);
+        int query = group / groupsPerQuery;
+        int groupStart = (group % groupsPerQuery) * LOCAL_SIZE * STRIP;
+        int subLen = patternOffsets[query + 1] - patternOffsets[query];
+        countGroup(str, patterns + patternOffsets[query], groupCounts, tile, scratch, group, groupStart, strLen, subLen);
+    }
+
+    __kernel void scatterBatchMatches(__global const char* str,
+                                      __constant const char* patterns,
+                                      __constant const int* patternOffsets,
+                                      __global const int* groupOffsets,
+                                      __global int* outMatches,
+                                      int strLen,
+                                      int groupsPerQuery,
+                                      __local char* tile)
+    {
+        __local int ranks[LOCAL_SIZE];
+        int group = get_group_id(0);
+        int query = group / groupsPerQuery;
+        int groupStart = (group % groupsPerQuery) * LOCAL_SIZE * STRIP;
+        int subLen = patternOffsets[query + 1] - patternOffsets[query];
+        scatterGroup(str, patterns + patternOffsets[query], groupOffsets, outMatches, tile, ranks, group, groupStart, strLen, subLen);
+    }
+  )";
+
+// Failure-less Aho-Corasick (PFAC): every work-item walks the trie from its own start
+// position, so no state carries across positions. TABLE_SPACE is __constant when the
+// tables fit in the device's constant memory and __global otherwise.
+const std::string multiPatternSource = R"(
+    // Returns the number of patterns that start at position `i` of 'str'.
+    int patternMatchesAt(__global const char* str,
+                         TABLE_SPACE const ushort* byteClass,
+                         TABLE_SPACE const int* trie,
+                         TABLE_SPACE const int* exactStart,
+                         int i,
+                         int strLen,
+                         int classCount)
+    {
+        int count = 0;
+        int state = 0;
+        for (int j = i; j < strLen; ++j) {
+            state = trie[state * classCount + byteClass[(uchar)str[j]]];
+            if (state < 0) {
+                break;
+            }
+            count += exactStart[state + 1] - exactStart[state];
+        }
+        return count;
+    }
+
+    __kernel void countPatternMatches(__global const char* str,
+                                      TABLE_SPACE const ushort* byteClass,
+                                      TABLE_SPACE const int* trie,
+                                      TABLE_SPACE const int* exactStart,
+                                      __global int* groupCounts,
+                                      int strLen,
+                                      int classCount)
+    {
+        __local int scratch[LOCAL_SIZE];
+        int i = get_global_id(0);
+        int lid = get_local_id(0);
+
+        scratch[lid] = (i < strLen) ? patternMatchesAt(str, byteClass, trie, exactStart, i, strLen, classCount) : 0;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int s = LOCAL_SIZE / 2; s > 0; s >>= 1) {
+            if (lid < s) {
+                scratch[lid] += scratch[lid + s];
+            }
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (lid == 0) {
+            groupCounts[get_group_id(0)] = scratch[0];
+        }
+    }
+
+    __kernel void scatterPatternMatches(__global const char* str,
+                                        TABLE_SPACE const ushort* byteClass,
+                                        TABLE_SPACE const int* trie,
+                                        TABLE_SPACE const int* exactStart,
+                                        TABLE_SPACE const int* exactIds,
+                                        __global const int* groupOffsets,
+                                        __global int2* outMatches,
+                                        int strLen,
+                                        int classCount)
+    {
+        __local int ranks[LOCAL_SIZE];
+        int i = get_global_id(0);
+        int lid = get_local_id(0);
+        int group = get_group_id(0);
+
+        if (groupOffsets[group + 1] == groupOffsets[group]) {
+            return;
+        }
+
+        int count = (i < strLen) ? patternMatchesAt(str, byteClass, trie, exactStart, i, strLen, classCount) : 0;
+        ranks[lid] = count;
+        barrier(CLK_LOCAL_MEM_FENCE);
+
+        for (int offset = 1; offset < LOCAL_SIZE; offset <<= 1) {
+            int v = (lid >= offset) ? ranks[lid - offset] : 0;
+            barrier(CLK_LOCAL_MEM_FENCE);
+            ranks[lid] += v;
+            barrier(CLK_LOCAL_MEM_FENCE);
+        }
+
+        if (count == 0) {
+            return;
+        }
+
+        // walk again, emitting the patterns in the order they were counted
+        int slot = groupOffsets[group] + ranks[lid] - count;
+        int state = 0;
+        for (int j = i; j < strLen; ++j) {
+            state = trie[state * classCount + byteClass[(uchar)str[j]]];
+            if (state < 0) {
+                break;
+            }
+            for (int o = exactStart[state]; o < exactStart[state + 1]; ++o) {
+                outMatches[slot++] = (int2)(exactIds[o], i);
+            }
+        }
+    }
+  )";
+
+const size_t preferredLocalSize = 256;
+
+// zero-copy host buffers need at least page alignment on every common ICD
+const size_t hostPageSize = 4096;
+
+// upper bound on the work-groups of one batched pipeline, keeps the group counts at 64 MiB
+const size_t maxBatchGroups = 16 * 1024 * 1024;
+
+/**
+ * @brief Rounds `value` up to the next multiple of `multiple`.
+ */
+size_t roundUp(size_t value, size_t multiple) {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+/**
+ * @brief Returns the summed start-to-end device time of finished events in nanoseconds.
+ */
+cl_ulong deviceTime(std::vector<cl::Event>& events) {
+    cl_ulong total = 0;
+    for (auto& event: events) {
+        total += event.getProfilingInfo<CL_PROFILING_COMMAND_END>() - event.getProfilingInfo<CL_PROFILING_COMMAND_START>();
+    }
+    return total;
+}
+
+std::string toLower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(), [](unsigned char c) { return std::tolower(c); });
+    return text;
+}
+
+// set by setClDeviceSelector(), read when the process-wide engines are created
+std::optional<ClDeviceSelector> deviceSelection;
+
+// set by setClProgramCacheDirectory(), the platform cache directory otherwise
+std::optional<std::string> programCacheDirectory;
+
+const char programCacheMagic[8] = {'s', 's', 'a', 'c', 'l', 'b', 'i', 'n'};
+
+// 64-bit FNV-1a, stable across runs and builds, unlike std::hash
+std::uint64_t fnv1a(std::string_view data) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c: data) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+/**
+ * @brief Returns the binary cached in `file` under `key`, or nothing if the file is missing, damaged or holds another key.
+ *
+ * A cache file is the magic, the key length and key, then the binary length and binary.
+ */
+std::vector<unsigned char> readCachedBinary(const std::filesystem::path& file, const std::string& key) {
+    std::ifstream in(file, std::ios::binary);
+    char magic[sizeof(programCacheMagic)];
+    std::uint64_t keyLength = 0;
+    if (!in.read(magic, sizeof(magic)) || !std::equal(magic, magic + sizeof(magic), programCacheMagic) ||
+        !in.read(reinterpret_cast<char*>(&keyLength), sizeof(keyLength)) || keyLength != key.length()) {
+        return {};
+    }
+
+    std::string storedKey(keyLength, '\0');
+    std::uint64_t binaryLength = 0;
+    if (!in.read(storedKey.data(), keyLength) || storedKey != key ||
+        !in.read(reinterpret_cast<char*>(&binaryLength), sizeof(binaryLength))) {
+        return {};
+    }
+
+    // a damaged length must not reach the allocation, the binary is the rest of the file
+    std::error_code error;
+    std::uintmax_t fileSize = std::filesystem::file_size(file, error);
+    std::streamoff header = in.tellg();
+    if (error || header < 0 || fileSize < static_cast<std::uintmax_t>(header) ||
+        binaryLength != fileSize - static_cast<std::uintmax_t>(header)) {
+        return {};
+    }
+
+    std::vector<unsigned char> binary(binaryLength);
+    if (!in.read(reinterpret_cast<char*>(binary.data()), binaryLength)) {
+        return {};
+    }
+    return binary;
+}
+
+/**
+ * @brief Stores `binary` under `key` in `file`, best effort.
+ *
+ * The file is written under a temporary name and renamed into place, so concurrent
+ * processes never read a partial entry. Failures leave the cache without the entry.
+ */
+void writeCachedBinary(const std::filesystem::path& file, const std::string& key,
+                       const std::vector<unsigned char>& binary) {
+    std::error_code error;
+    std::filesystem::create_directories(file.parent_path(), error);
+    if (error) {
+        return;
+    }
+
+    std::filesystem::path temporary = file;
+    temporary += ".tmp" + std::to_string(std::random_device{}());
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        std::uint64_t keyLength = key.length();
+        std::uint64_t binaryLength = binary.size();
+        out.write(programCacheMagic, sizeof(programCacheMagic));
+        out.write(reinterpret_cast<const char*>(&keyLength), sizeof(keyLength));
+        out.write(key.data(), key.length());
+        out.write(reinterpret_cast<const char*>(&binaryLength), sizeof(binaryLength));
+        out.write(reinterpret_cast<const char*>(binary.data()), binary.size());
+        if (!out) {
+            out.close();
+            std::filesystem::remove(temporary, error);
+            return;
+        }
+    }
+    std::filesystem::rename(temporary, file, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+    }
+}
+
+/**
+ * @brief Rejects texts whose offsets do not fit the int positions of the search kernels.
+ *
+ * @param[in] str   The text about to be searched.
+ * @param[in] what  Name of the text used in the error message.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ */
+void checkTextLength(std::string_view str, const char* what) {
+    if (str.length() > static_cast<size_t>(INT_MAX)) {
+        throw std::invalid_argument(std::string(what) + " must be at most INT_MAX bytes.");
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Parses a comma-separated selection such as "gpu", "vendor=intel" or "cpu,0,2".
+ *
+ * @param[in] spec  The selection.
+ *
+ * @throws std::invalid_argument if an item is none of a device type, vendor=NAME or an index.
+ */
+ClDeviceSelector ClDeviceSelector::parse(const std::string& spec) {
+    ClDeviceSelector selector;
+    std::stringstream items(spec);
+    std::string item;
+    while (std::getline(items, item, ',')) {
+        std::string lower = toLower(item);
+        if (lower == "all") {
+            selector.type = CL_DEVICE_TYPE_ALL;
+        } else if (lower == "cpu") {
+            selector.type = CL_DEVICE_TYPE_CPU;
+        } else if (lower == "gpu") {
+            selector.type = CL_DEVICE_TYPE_GPU;
+        } else if (lower == "accelerator") {
+            selector.type = CL_DEVICE_TYPE_ACCELERATOR;
+        } else if (lower.starts_with("vendor=")) {
+            selector.vendor = item.substr(7);
+        } else if (!item.empty() && std::all_of(item.begin(), item.end(), [](unsigned char c) { return std::isdigit(c); })) {
+            selector.indices.push_back(std::stoul(item));
+        } else {
+            throw std::invalid_argument("Unknown OpenCL device selection: " + item);
+        }
+    }
+    return selector;
+}
+
+/**
+ * @brief Returns the devices of every platform that match `selector`.
+ *
+ * Platforms without a device of the requested type are skipped, as is a missing ICD
+ * loader setup, which reports no platforms.
+ *
+ * @param[in] selector  The filters and indices; the default selects every device.
+ *
+ * @return The matching devices in platform order.
+ *
+ * @throws std::invalid_argument if an index is past the end of the filtered list.
+ */
+std::vector<cl::Device> findClDevices(const ClDeviceSelector& selector) {
+    std::vector<cl::Platform> platforms;
+    try {
+        cl::Platform::get(&platforms);
+    } catch (cl::Error&) {
+        // CL_PLATFORM_NOT_FOUND_KHR when no platform is installed
+        return {};
+    }
+
+    std::string vendor = toLower(selector.vendor);
+    std::vector<cl::Device> filtered;
+    for (auto& platform: platforms) {
+        std::vector<cl::Device> devices;
+        try {
+            platform.getDevices(selector.type, &devices);
+        } catch (cl::Error&) {
+            // CL_DEVICE_NOT_FOUND when the platform has no device of this type
+            continue;
+        }
+
+        for (auto& device: devices) {
+            if (vendor.empty() ||
+                toLower(device.getInfo<CL_DEVICE_VENDOR>()).find(vendor) != std::string::npos ||
+                toLower(platform.getInfo<CL_PLATFORM_VENDOR>()).find(vendor) != std::string::npos ||
+                toLower(platform.getInfo<CL_PLATFORM_NAME>()).find(vendor) != std::string::npos) {
+                filtered.push_back(device);
+            }
+        }
+    }
+
+    if (selector.indices.empty()) {
+        return filtered;
+    }
+    std::vector<cl::Device> selected;
+    for (size_t index: selector.indices) {
+        if (index >= filtered.size()) {
+            throw std::invalid_argument("No OpenCL device at index " + std::to_string(index) + ", " +
+                                        std::to_string(filtered.size()) + " match the selection.");
+        }
+        selected.push_back(filtered[index]);
+    }
+    return selected;
+}
+
+/**
+ * @brief Returns a one-line description of `device`: name, vendor, type and compute units.
+ */
+std::string clDeviceDescription(const cl::Device& device) {
+    cl_device_type type = device.getInfo<CL_DEVICE_TYPE>();
+    std::string typeName = type & CL_DEVICE_TYPE_GPU ? "GPU"
+                         : type & CL_DEVICE_TYPE_CPU ? "CPU"
+                         : type & CL_DEVICE_TYPE_ACCELERATOR ? "accelerator"
+                         : "other";
+    // info strings of some drivers include the terminating null
+    std::string name = device.getInfo<CL_DEVICE_NAME>().c_str();
+    std::string vendor = device.getInfo<CL_DEVICE_VENDOR>().c_str();
+    return name + " (" + vendor + ", " + typeName + ", " +
+           std::to_string(device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>()) + " compute units)";
+}
+
+/**
+ * @brief Sets the devices ClSearchEngine::Get() and ShardedSearcher::Get() are created on.
+ *
+ * @param[in] selector  The devices to use.
+ */
+void setClDeviceSelector(const ClDeviceSelector& selector) {
+    deviceSelection = selector;
+}
+
+/**
+ * @brief Returns the selection set by setClDeviceSelector(), if any.
+ */
+std::optional<ClDeviceSelector> clDeviceSelection() {
+    return deviceSelection;
+}
+
+/**
+ * @brief Sets the directory compiled OpenCL programs are cached in; an empty string disables the cache.
+ *
+ * @param[in] directory  The cache directory, created on the first store.
+ */
+void setClProgramCacheDirectory(const std::string& directory) {
+    programCacheDirectory = directory;
+}
+
+/**
+ * @brief Returns the directory compiled OpenCL programs are cached in, empty if caching is disabled.
+ *
+ * Without setClProgramCacheDirectory() this is $SS_ANALYTICS_CL_CACHE if set (empty
+ * disables the cache), else ss_analytics/opencl under $XDG_CACHE_HOME, ~/.cache or
+ * %LOCALAPPDATA%.
+ */
+std::string clProgramCacheDirectory() {
+    if (programCacheDirectory) {
+        return *programCacheDirectory;
+    }
+    if (const char* directory = std::getenv("SS_ANALYTICS_CL_CACHE")) {
+        return directory;
+    }
+    if (const char* cache = std::getenv("XDG_CACHE_HOME"); cache && *cache) {
+        return (std::filesystem::path(cache) / "ss_analytics" / "opencl").string();
+    }
+    if (const char* home = std::getenv("HOME"); home && *home) {
+        return (std::filesystem::path(home) / ".cache" / "ss_analytics" / "opencl").string();
+    }
+    if (const char* appData = std::getenv("LOCALAPPDATA"); appData && *appData) {
+        return (std::filesystem::path(appData) / "ss_analytics" / "opencl").string();
+    }
+    return "";
+}
+
+/**
+ * @brief Constructs the engine on the first device of the given type.
+ *
+ * @param[in] deviceType  OpenCL device type used to create the context.
+ *
+ * @throws cl::Error if context creation or the program build fails.
+ */
+ClSearchEngine::ClSearchEngine(cl_device_type deviceType)
+: ClSearchEngine(cl::Context(deviceType)) {}
+
+/**
+ * @brief Constructs the engine on `device`, with a context of its own.
+ *
+ * @param[in] device  The device to run on.
+ *
+ * @throws cl::Error if context creation or the program build fails.
+ */
+ClSearchEngine::ClSearchEngine(const cl::Device& device)
+: ClSearchEngine(cl::Context(device)) {}
+
+/**
+ * @brief Sets up the queues and builds the programs on the first device of `context`.
+ *
+ * Creates a profiling-enabled queue, picks the work-group size and builds the search
+ * program for it. Text, pattern and scratch buffers are allocated lazily on the first
+ * query.
+ *
+ * @param[in] context  The context to run in.
+ *
+ * @throws cl::Error if the program build fails.
+ */
+ClSearchEngine::ClSearchEngine(const cl::Context& context)
+: m_textCapacity(0), m_patternCapacity(0), m_groupOffsetsCapacity(0), m_resultCapacity(0),
+  m_haystackCapacity(0), m_haystackLength(-1), m_needlesCapacity(0), m_needleOffsetsCapacity(0),
+  m_chunksCapacity{} {
+    PROFILE_FUNCTION();
+
+    Timer setupTimer("Setup Context and Queue");
+    m_context = context;
+    m_device = m_context.getInfo<CL_CONTEXT_DEVICES>().front();
+    m_queue = cl::CommandQueue(m_context, m_device, CL_QUEUE_PROFILING_ENABLE);
+    m_hostPtrAlignment = std::max<size_t>(hostPageSize, m_device.getInfo<CL_DEVICE_MEM_BASE_ADDR_ALIGN>() / 8);
+    m_localMemSize = m_device.getInfo<CL_DEVICE_LOCAL_MEM_SIZE>();
+    m_transferQueue = cl::CommandQueue(m_context, m_device, CL_QUEUE_PROFILING_ENABLE);
+    setupTimer.stop();
+
+    // largest power of two not above the preferred and the device work-group size
+    size_t maxLocalSize = std::min(preferredLocalSize, m_device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>());
+    m_localSize = 1;
+    while (m_localSize * 2 <= maxLocalSize) {
+        m_localSize *= 2;
+    }
+
+    Timer buildTimer("Build Program");
+    std::string buildOptions = "-D LOCAL_SIZE=" + std::to_string(m_localSize);
+    m_program = buildProgram(kernelSource, buildOptions);
+    m_scanKernel = cl::Kernel(m_program, "scanBlocks");
+    m_addOffsetsKernel = cl::Kernel(m_program, "addBlockOffsets");
+    m_searchFirstKernel = cl::Kernel(m_program, "searchFirst");
+    m_countHammingKernel = cl::Kernel(m_program, "countHammingMatches");
+    m_scatterHammingKernel = cl::Kernel(m_program, "scatterHammingMatches");
+    buildTimer.stop();
+
+    // one position per work-item until a tuned configuration is set
+    setKernelConfig(ClKernelConfig{});
+
+    m_firstMatch = cl::Buffer(m_context, CL_MEM_READ_WRITE, sizeof(int));
+}
+
+/**
+ * @brief Returns the process-wide engine, creating it on first use.
+ *
+ * The engine runs on the first device of clDeviceSelection() if one was set, and on
+ * the default device otherwise.
+ *
+ * @throws std::runtime_error if the selection matches no device.
+ */
+ClSearchEngine& ClSearchEngine::Get() {
+    static ClSearchEngine engine = []() {
+        std::optional<ClDeviceSelector> selection = clDeviceSelection();
+        if (!selection) {
+            return ClSearchEngine();
+        }
+        std::vector<cl::Device> devices = findClDevices(*selection);
+        if (devices.empty()) {
+            throw std::runtime_error("No OpenCL device matches the selection.");
+        }
+        return ClSearchEngine(devices.front());
+    }();
+    return engine;
+}
+
+/**
+ * @brief Reallocates `buffer` when it holds fewer than `size` bytes.
+ *
+ * @param[in,out] buffer    The device buffer to grow.
+ * @param[in,out] capacity  Current size of `buffer` in bytes, updated on reallocation.
+ * @param[in]     size      Required size in bytes.
+ * @param[in]     flags     Memory flags used when the buffer is reallocated.
+ */
+void ClSearchEngine::ensureCapacity(cl::Buffer& buffer, size_t& capacity, size_t size, cl_mem_flags flags) {
+    if (size <= capacity) {
+        return;
+    }
+    buffer = cl::Buffer(m_context, flags, size);
+    capacity = size;
+}
+
+/**
+ * @brief Makes the text available to the device.
+ *
+ * Host memory aligned to m_hostPtrAlignment, such as the pages of a MappedFile, is
+ * wrapped as a CL_MEM_USE_HOST_PTR buffer instead of being copied into m_text, so
+ * devices sharing host memory read it in place and others transfer it straight from
+ * the mapping. The wrapper must not outlive the current call.
+ *
+ * @param[in] str  The input text to search in.
+ *
+ * @return The buffer holding the text.
+ */
+cl::Buffer ClSearchEngine::uploadText(std::string_view str) {
+    Timer bufferTimer("Create Buffers");
+    if (reinterpret_cast<std::uintptr_t>(str.data()) % m_hostPtrAlignment == 0) {
+        cl::Buffer hostText(m_context, CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR,
+                            sizeof(cl_char) * str.length(), (void*)str.data());
+        bufferTimer.stop();
+        return hostText;
+    }
+
+    ensureCapacity(m_text, m_textCapacity, sizeof(cl_char) * str.length(), CL_MEM_READ_ONLY);
+    m_queue.enqueueWriteBuffer(m_text, CL_FALSE, 0, sizeof(cl_char) * str.length(), str.data());
+    bufferTimer.stop();
+    return m_text;
+}
+
+/**
+ * @brief Uploads the pattern, growing its device buffer when needed.
+ *
+ * @param[in] substr  The pattern to search for.
+ */
+void ClSearchEngine::uploadPattern(std::string_view substr) {
+    ensureCapacity(m_pattern, m_patternCapacity, sizeof(cl_char) * substr.length(), CL_MEM_READ_ONLY);
+    m_queue.enqueueWriteBuffer(m_pattern, CL_FALSE, 0, sizeof(cl_char) * substr.length(), substr.data());
+}
+
+/**
+ * @brief Finds all occurrences of a substring using the persistent kernels.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<int> ClSearchEngine::findAll(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+    if (substr.empty() || substr.length() > str.length()) {
+        return {};
+    }
+
+    cl::Buffer text = uploadText(str);
+    uploadPattern(substr);
+
+    std::vector<cl::Event> events;
+    std::vector<int> hostResults = findAllOnDevice(text, str.length(), substr.length(), nullptr, events);
+
+    // record cl timing
+    record_cl_time(events);
+    return hostResults;
+}
+
+/**
+ * @brief Finds all occurrences of a substring, streaming the text through the device in chunks.
+ *
+ * Uploads run streamBufferCount - 1 chunks ahead of the kernels on m_transferQueue; each
+ * chunk's passes wait on its upload event. A buffer is only refilled once the passes of
+ * the chunk that used it have been read back. The device timestamps of all uploads and
+ * kernels are used to report how much of the transfer time ran under the kernels.
+ *
+ * @param[in] str        The input text to search in.
+ * @param[in] substr     The pattern to search for.
+ * @param[in] chunkSize  Number of start positions searched per chunk.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order and relative to the start of `str`.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<int> ClSearchEngine::findAllStreaming(std::string_view str, std::string_view substr,
+                                                  size_t chunkSize) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+
+    std::vector<int> hostResults;
+    streamChunks(str, substr, chunkSize, [&](MatchOffset chunkStart, const std::vector<int>& positions) {
+        for (int position: positions) {
+            hostResults.push_back(static_cast<int>(chunkStart + position));
+        }
+        return true;
+    });
+    return hostResults;
+}
+
+/**
+ * @brief Runs the chunked upload and search pipeline of findAllStreaming() and hands each chunk's matches to `onChunk`.
+ *
+ * Chunk starts are kept as size_t and passed on as MatchOffset, so the text may exceed
+ * INT_MAX bytes; only a single chunk plus its overlap has to fit the int positions of
+ * the kernels. When `onChunk` returns false no further chunk is searched, and the
+ * uploads already in flight are waited for before returning, as they read from `str`.
+ *
+ * @param[in] str        The input text to search in.
+ * @param[in] substr     The pattern to search for.
+ * @param[in] chunkSize  Number of start positions searched per chunk.
+ * @param[in] onChunk    Called per chunk, in order, with its start in `str` and its ascending
+ *                       match positions relative to that start.
+ *
+ * @throws std::invalid_argument if `chunkSize` plus the overlap is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+void ClSearchEngine::streamChunks(std::string_view str, std::string_view substr, size_t chunkSize,
+                                  const ChunkCallback& onChunk) {
+    PROFILE_FUNCTION();
+    if (substr.empty() || substr.length() > str.length() || chunkSize == 0) {
+        return;
+    }
+    size_t maxChunkLength = static_cast<size_t>(INT_MAX);
+    if (substr.length() > maxChunkLength || chunkSize > maxChunkLength - (substr.length() - 1)) {
+        throw std::invalid_argument("Chunk size plus pattern overlap must be at most INT_MAX bytes.");
+    }
+
+    size_t textLen = str.length();
+    size_t overlap = substr.length() - 1;
+    size_t numChunks = (textLen - overlap + chunkSize - 1) / chunkSize;
+
+    uploadPattern(substr);
+
+    // bytes uploaded for a chunk: its start positions plus the overlap, clamped to the text
+    auto chunkLength = [&](size_t chunk) {
+        size_t start = chunk * chunkSize;
+        return std::min(chunkSize + overlap, textLen - start);
+    };
+
+    std::vector<cl::Event> uploadEvents(numChunks);
+    auto enqueueUpload = [&](size_t chunk) {
+        size_t slot = chunk % streamBufferCount;
+        ensureCapacity(m_chunks[slot], m_chunksCapacity[slot], chunkSize + overlap, CL_MEM_READ_ONLY);
+        m_transferQueue.enqueueWriteBuffer(m_chunks[slot], CL_FALSE, 0, chunkLength(chunk),
+                                           str.data() + chunk * chunkSize, nullptr, &uploadEvents[chunk]);
+    };
+
+    std::vector<cl::Event> kernelEvents;
+    size_t uploaded = std::min(numChunks, streamBufferCount - 1);
+    {
+        PROFILE_SCOPE("Stream Chunks");
+
+        for (size_t chunk = 0; chunk < uploaded; chunk++) {
+            enqueueUpload(chunk);
+        }
+        m_transferQueue.flush();
+
+        for (size_t chunk = 0; chunk < numChunks; chunk++) {
+            // the buffer of chunk - 1 is free again, refill it with the next chunk ahead
+            size_t ahead = chunk + streamBufferCount - 1;
+            if (ahead < numChunks) {
+                enqueueUpload(ahead);
+                m_transferQueue.flush();
+                uploaded = ahead + 1;
+            }
+
+            std::vector<cl::Event> waitEvents { uploadEvents[chunk] };
+            std::vector<int> chunkResults = findAllOnDevice(m_chunks[chunk % streamBufferCount],
+                                                            chunkLength(chunk), substr.length(),
+                                                            &waitEvents, kernelEvents);
+
+            if (!onChunk(static_cast<MatchOffset>(chunk * chunkSize), chunkResults)) {
+                break;
+            }
+        }
+        m_transferQueue.finish();
+    }
+    uploadEvents.resize(uploaded);
+
+    // device-side accounting of the overlap between uploads and kernels
+    cl_ulong transferTime = 0;
+    cl_ulong kernelTime = 0;
+    cl_ulong spanStart = ~cl_ulong(0);
+    cl_ulong spanEnd = 0;
+    auto accumulate = [&](std::vector<cl::Event>& events, cl_ulong& total) {
+        for (auto& event: events) {
+            cl_ulong time_start = 0;
+            cl_ulong time_end = 0;
+            event.getProfilingInfo(CL_PROFILING_COMMAND_START, &time_start);
+            event.getProfilingInfo(CL_PROFILING_COMMAND_END, &time_end);
+            total += time_end - time_start;
+            spanStart = std::min(spanStart, time_start);
+            spanEnd = std::max(spanEnd, time_end);
+        }
+    };
+    accumulate(uploadEvents, transferTime);
+    accumulate(kernelEvents, kernelTime);
+
+    cl_ulong span = spanEnd - spanStart;
+    cl_ulong hidden = transferTime + kernelTime > span ? transferTime + kernelTime - span : 0;
+    hidden = std::min(hidden, transferTime);
+
+    record_cl_time(kernelEvents);
+    PROFILE_CUSTOM_TIME("Stream Transfer", transferTime / 1000.0f);
+    PROFILE_CUSTOM_TIME("Stream Kernel", kernelTime / 1000.0f);
+    PROFILE_CUSTOM_TIME("Stream Device Span", span / 1000.0f);
+    PROFILE_CUSTOM_TIME("Stream Transfer Hidden", hidden / 1000.0f);
+}
+
+/**
+ * @brief Runs the count, prefix-sum and scatter passes over a text already on the device.
+ *
+ * Reads the results compactMatchesOnDevice() leaves in m_result back to the host.
+ *
+ * @param[in] text        Device buffer holding the text.
+ * @param[in] textLen     Number of bytes of `text` to search.
+ * @param[in] patternLen  Length of the pattern held in m_pattern.
+ * @param[in] waitEvents  Events the first pass must wait for, or nullptr.
+ * @param[out] events     Collects the kernel events for profiling.
+ *
+ * @return The ascending match positions relative to the start of `text`.
+ *
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<int> ClSearchEngine::findAllOnDevice(const cl::Buffer& text, int textLen, int patternLen,
+                                                 const std::vector<cl::Event>* waitEvents,
+                                                 std::vector<cl::Event>& events) {
+    int totalMatches = compactMatchesOnDevice(text, textLen, patternLen, waitEvents, events);
+
+    // Read back the result
+    Timer readTimer("Read Result");
+    std::vector<int> hostResults(totalMatches);
+    if (totalMatches > 0) {
+        m_queue.enqueueReadBuffer(m_result, CL_TRUE, 0, sizeof(int) * totalMatches, hostResults.data());
+    }
+    readTimer.stop();
+
+    return hostResults;
+}
+
+/**
+ * @brief Runs the count, prefix-sum and scatter passes into m_result without reading them back.
+ *
+ * Sets the text and pattern arguments of countMatches and scatterMatches and hands
+ * them to compactOnDevice().
+ *
+ * @param[in] text        Device buffer holding the text.
+ * @param[in] textLen     Number of bytes of `text` to search.
+ * @param[in] patternLen  Length of the pattern held in m_pattern.
+ * @param[in] waitEvents  Events the first pass must wait for, or nullptr.
+ * @param[out] events     Collects the kernel events for profiling.
+ *
+ * @return The number of match positions in m_result, relative to the start of `text`.
+ *
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+int ClSearchEngine::compactMatchesOnDevice(const cl::Buffer& text, int textLen, int patternLen,
+                                           const std::vector<cl::Event>* waitEvents,
+                                           std::vector<cl::Event>& events) {
+    PROFILE_SCOPE("Run Kernel");
+    SearchKernels& kernels = searchKernelsFor(patternLen);
+    const ClKernelConfig& config = kernels.config;
+
+    size_t strips = (textLen - patternLen + config.strip) / config.strip;
+    cl::LocalSpaceArg tile = cl::Local(config.tiled ? config.localSize * config.strip + patternLen - 1 : 1);
+
+    kernels.count.setArg(0, text);
+    kernels.count.setArg(1, m_pattern);
+    kernels.count.setArg(3, textLen);
+    kernels.count.setArg(4, patternLen);
+    kernels.count.setArg(5, tile);
+
+    kernels.scatter.setArg(0, text);
+    kernels.scatter.setArg(1, m_pattern);
+    kernels.scatter.setArg(4, textLen);
+    kernels.scatter.setArg(5, patternLen);
+    kernels.scatter.setArg(6, tile);
+
+    return compactOnDevice(kernels.count, 2, kernels.scatter, 2, 3,
+                           roundUp(strips, config.localSize), config.localSize,
+                           sizeof(int), waitEvents, events);
+}
+
+/**
+ * @brief Runs the passes of findAll() and leaves the compacted results in m_result.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The number of results in m_result, 0 for an empty or too long pattern.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+int ClSearchEngine::findAllResident(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+    if (substr.empty() || substr.length() > str.length()) {
+        return 0;
+    }
+
+    cl::Buffer text = uploadText(str);
+    uploadPattern(substr);
+
+    std::vector<cl::Event> events;
+    int totalMatches = compactMatchesOnDevice(text, str.length(), substr.length(), nullptr, events);
+
+    // record cl timing
+    record_cl_time(events);
+    return totalMatches;
+}
+
+/**
+ * @brief Reads results [begin, begin + count) of m_result into m_resultBlock.
+ *
+ * m_resultBlock only grows, so after the first full block no call allocates.
+ *
+ * @throws cl::Error if the read fails.
+ */
+void ClSearchEngine::readResultBlock(int begin, int count) {
+    Timer readTimer("Read Result");
+    if (m_resultBlock.size() < static_cast<size_t>(count)) {
+        m_resultBlock.resize(count);
+    }
+    m_queue.enqueueReadBuffer(m_result, CL_TRUE, sizeof(int) * begin, sizeof(int) * count, m_resultBlock.data());
+    readTimer.stop();
+}
+
+/**
+ * @brief Runs a count kernel, the prefix sum and a scatter kernel into m_result.
+ *
+ * The count kernel must write one count per work-group at `countArg`; the scatter
+ * kernel reads the scanned offsets at `offsetsArg` and writes into `resultArg`. Those
+ * three arguments are set here, all others by the caller. The counts are scanned by
+ * countOnDevice(), whose total sizes m_result exactly. The scatter pass is skipped when
+ * there are no results.
+ *
+ * @param[in] countKernel    Kernel writing per-group counts.
+ * @param[in] countArg       Argument index of the counts buffer in `countKernel`.
+ * @param[in] scatterKernel  Kernel writing results at their scanned offsets.
+ * @param[in] offsetsArg     Argument index of the offsets buffer in `scatterKernel`.
+ * @param[in] resultArg      Argument index of the output buffer in `scatterKernel`.
+ * @param[in] globalSize     Global work size of both kernels, a multiple of `localSize`.
+ * @param[in] localSize      Work-group size of both kernels.
+ * @param[in] elementSize    Size in bytes of one result element.
+ * @param[in] waitEvents     Events the count pass must wait for, or nullptr.
+ * @param[out] events        Collects the kernel events for profiling.
+ *
+ * @return The number of results written to m_result.
+ *
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+int ClSearchEngine::compactOnDevice(cl::Kernel& countKernel, cl_uint countArg,
+                                    cl::Kernel& scatterKernel, cl_uint offsetsArg, cl_uint resultArg,
+                                    size_t globalSize, size_t localSize, size_t elementSize,
+                                    const std::vector<cl::Event>* waitEvents,
+                                    std::vector<cl::Event>& events) {
+    int total = countOnDevice(countKernel, countArg, globalSize, localSize, waitEvents, events);
+    if (total == 0) {
+        return 0;
+    }
+
+    cl::Event scatterEvent;
+    ensureCapacity(m_result, m_resultCapacity, elementSize * total, CL_MEM_READ_WRITE);
+    scatterKernel.setArg(offsetsArg, m_groupOffsets);
+    scatterKernel.setArg(resultArg, m_result);
+    m_queue.enqueueNDRangeKernel(scatterKernel, cl::NullRange, cl::NDRange(globalSize),
+                                 cl::NDRange(localSize), nullptr, &scatterEvent);
+    events.push_back(scatterEvent);
+    scatterEvent.wait();
+
+    return total;
+}
+
+/**
+ * @brief Runs a count kernel and sums its per-group counts on the device.
+ *
+ * The counts land in m_groupOffsets with one extra zero element; the exclusive scan
+ * turns them into the offsets a scatter pass needs, and its last entry into the total,
+ * which is the only value read back.
+ *
+ * @param[in] countKernel  Kernel writing per-group counts; all arguments but `countArg` set by the caller.
+ * @param[in] countArg     Argument index of the counts buffer in `countKernel`.
+ * @param[in] globalSize   Global work size, a multiple of `localSize`.
+ * @param[in] localSize    Work-group size.
+ * @param[in] waitEvents   Events the count pass must wait for, or nullptr.
+ * @param[out] events      Collects the kernel events for profiling.
+ *
+ * @return The sum of the per-group counts.
+ *
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+int ClSearchEngine::countOnDevice(cl::Kernel& countKernel, cl_uint countArg,
+                                  size_t globalSize, size_t localSize,
+                                  const std::vector<cl::Event>* waitEvents,
+                                  std::vector<cl::Event>& events) {
+    int numGroups = globalSize / localSize;
+    int zero {0};
+
+    // one slot per group plus the trailing total
+    ensureCapacity(m_groupOffsets, m_groupOffsetsCapacity, sizeof(int) * (numGroups + 1), CL_MEM_READ_WRITE);
+    m_queue.enqueueFillBuffer(m_groupOffsets, zero, sizeof(int) * numGroups, sizeof(int));
+
+    cl::Event countEvent;
+    countKernel.setArg(countArg, m_groupOffsets);
+    m_queue.enqueueNDRangeKernel(countKernel, cl::NullRange, cl::NDRange(globalSize),
+                                 cl::NDRange(localSize), waitEvents, &countEvent);
+    events.push_back(countEvent);
+
+    exclusiveScan(m_groupOffsets, numGroups + 1, 0, events);
+
+    int total {0};
+    m_queue.enqueueReadBuffer(m_groupOffsets, CL_TRUE, sizeof(int) * numGroups, sizeof(int), &total);
+    return total;
+}
+
+/**
+ * @brief In-place exclusive prefix sum of `n` ints on the device.
+ *
+ * Each work-group scans 2 * m_localSize elements and emits its total; the totals are
+ * scanned recursively one level down and added back to the blocks.
+ *
+ * @param[in,out] data    Device buffer to scan.
+ * @param[in]     n       Number of elements in `data`.
+ * @param[in]     level   Recursion depth, selects the scratch buffer for block totals.
+ * @param[out]    events  Collects the kernel events for profiling.
+ */
+void ClSearchEngine::exclusiveScan(const cl::Buffer& data, int n, size_t level, std::vector<cl::Event>& events) {
+    size_t blockSize = 2 * m_localSize;
+    int numBlocks = roundUp(n, blockSize) / blockSize;
+
+    if (m_scanSums.size() <= level) {
+        m_scanSums.resize(level + 1);
+        m_scanSumsCapacity.resize(level + 1, 0);
+    }
+    ensureCapacity(m_scanSums[level], m_scanSumsCapacity[level], sizeof(int) * numBlocks, CL_MEM_READ_WRITE);
+    // keep a handle, a deeper level may resize m_scanSums
+    cl::Buffer blockSums = m_scanSums[level];
+
+    cl::Event scanEvent;
+    m_scanKernel.setArg(0, data);
+    m_scanKernel.setArg(1, blockSums);
+    m_scanKernel.setArg(2, n);
+    m_queue.enqueueNDRangeKernel(m_scanKernel, cl::NullRange, cl::NDRange(numBlocks * m_localSize),
+                                 cl::NDRange(m_localSize), nullptr, &scanEvent);
+    events.push_back(scanEvent);
+
+    if (numBlocks == 1) {
+        return;
+    }
+
+    exclusiveScan(blockSums, numBlocks, level + 1, events);
+
+    cl::Event addEvent;
+    m_addOffsetsKernel.setArg(0, data);
+    m_addOffsetsKernel.setArg(1, blockSums);
+    m_addOffsetsKernel.setArg(2, n);
+    m_queue.enqueueNDRangeKernel(m_addOffsetsKernel, cl::NullRange, cl::NDRange(numBlocks * m_localSize),
+                                 cl::NDRange(m_localSize), nullptr, &addEvent);
+    events.push_back(addEvent);
+}
+
+/**
+ * @brief Returns the kernel configuration used by the single-pattern find-all.
+ */
+const ClKernelConfig& ClSearchEngine::kernelConfig() const {
+    return m_searchKernels.config;
+}
+
+/**
+ * @brief Builds the count and scatter kernels for `config` and uses them from now on.
+ *
+ * A tiled configuration also builds its untiled counterpart, used for patterns whose
+ * halo would not fit in local memory.
+ *
+ * @param[in] config  The kernel configuration; a localSize of 0 selects the engine default.
+ *
+ * @throws std::invalid_argument if the strip is 0, the local size is not a power of two
+ *         or exceeds the device limit, or a vectorized strip is not a multiple of 16.
+ * @throws cl::Error if the program build fails.
+ */
+void ClSearchEngine::setKernelConfig(ClKernelConfig config) {
+    if (config.localSize == 0) {
+        config.localSize = m_localSize;
+    }
+    if (config.strip == 0) {
+        throw std::invalid_argument("Kernel strip must be at least 1.");
+    }
+    if ((config.localSize & (config.localSize - 1)) != 0 ||
+        config.localSize > m_device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>()) {
+        throw std::invalid_argument("Kernel local size must be a power of two within the device limit.");
+    }
+    if (config.vectorized && config.strip % 16 != 0) {
+        throw std::invalid_argument("Vectorized kernels need a strip that is a multiple of 16.");
+    }
+
+    m_searchKernels = buildSearchKernels(config);
+    if (config.tiled) {
+        ClKernelConfig untiled = config;
+        untiled.tiled = false;
+        m_untiledKernels = buildSearchKernels(untiled);
+    }
+}
+
+/**
+ * @brief Builds the count and scatter kernels of stripSearchSource for `config`.
+ *
+ * @throws cl::Error if the program build fails.
+ */
+ClSearchEngine::SearchKernels ClSearchEngine::buildSearchKernels(const ClKernelConfig& config) {
+    Timer buildTimer("Build Program");
+    std::string buildOptions = "-D LOCAL_SIZE=" + std::to_string(config.localSize);
+    buildOptions += " -D STRIP=" + std::to_string(config.strip);
+    buildOptions += " -D TILED=" + std::to_string(config.tiled ? 1 : 0);
+    buildOptions += " -D VECTORIZED=" + std::to_string(config.vectorized ? 1 : 0);
+    cl::Program program = buildProgram(stripSearchSource, buildOptions);
+
+    SearchKernels kernels;
+    kernels.config = config;
+    kernels.count = cl::Kernel(program, "countStripMatches");
+    kernels.scatter = cl::Kernel(program, "scatterStripMatches");
+    kernels.countBatch = cl::Kernel(program, "countBatchMatches");
+    kernels.scatterBatch = cl::Kernel(program, "scatterBatchMatches");
+    buildTimer.stop();
+
+    return kernels;
+}
+
+/**
+ * @brief Builds `source` with `options` for m_device, through the on-disk binary cache.
+ *
+ * The cache entry is keyed by the device name and driver version, the options and the
+ * source; its file name is a hash of that key and the full key is stored in the file,
+ * so a stale or colliding entry is never used. A cached binary is loaded with
+ * clCreateProgramWithBinary; when there is none, or the driver rejects it, the source
+ * is compiled and its binary stored for the next process. The time taken is reported
+ * to the profiler as "Program Cache Hit" or "Program Cache Miss".
+ *
+ * @param[in] source   OpenCL C source of the program.
+ * @param[in] options  Build options.
+ *
+ * @return The built program.
+ *
+ * @throws cl::Error if the source fails to build; the build log is printed to stderr first.
+ */
+cl::Program ClSearchEngine::buildProgram(const std::string& source, const std::string& options) {
+    using Clock = std::chrono::steady_clock;
+    auto start = Clock::now();
+    auto elapsedMicroseconds = [&start]() {
+        return std::chrono::duration<float, std::micro>(Clock::now() - start).count();
+    };
+
+    std::string key = deviceKey() + "\n" + options + "\n" + source;
+    std::filesystem::path cacheFile;
+    std::string directory = clProgramCacheDirectory();
+    if (!directory.empty()) {
+        std::ostringstream fileName;
+        fileName << std::hex << std::setw(16) << std::setfill('0') << fnv1a(key) << ".bin";
+        cacheFile = std::filesystem::path(directory) / fileName.str();
+
+        std::vector<unsigned char> binary = readCachedBinary(cacheFile, key);
+        if (!binary.empty()) {
+            try {
+                cl::Program program(m_context, {m_device}, cl::Program::Binaries{binary});
+                program.build(options.c_str());
+                PROFILE_CUSTOM_TIME("Program Cache Hit", elapsedMicroseconds());
+                return program;
+            } catch (cl::Error&) {
+                // rejected by the driver, rebuilt from source and replaced below
+            }
+        }
+    }
+
+    cl::Program program(m_context, source);
+    try {
+        program.build(options.c_str());
+    } catch (cl::Error& e) {
+        // In case of a build error, print the build log.
+        std::cerr << "Build failed for device: "
+                  << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(m_device)
+                  << std::endl;
+        throw;
+    }
+
+    if (!cacheFile.empty()) {
+        std::vector<std::vector<unsigned char>> binaries = program.getInfo<CL_PROGRAM_BINARIES>();
+        if (!binaries.empty() && !binaries.front().empty()) {
+            writeCachedBinary(cacheFile, key, binaries.front());
+        }
+    }
+    PROFILE_CUSTOM_TIME("Program Cache Miss", elapsedMicroseconds());
+    return program;
+}
+
+/**
+ * @brief Returns whether the tile, its halo and the per-group int scratch fit in local memory.
+ */
+bool ClSearchEngine::tileFits(const ClKernelConfig& config, size_t patternLen) const {
+    size_t tileSize = config.localSize * config.strip + patternLen - 1;
+    return tileSize + config.localSize * sizeof(cl_int) <= m_localMemSize;
+}
+
+/**
+ * @brief Returns the count and scatter kernels for a pattern of `patternLen` bytes.
+ *
+ * Long patterns can overflow the tile of a tiled configuration; those get the untiled
+ * build of the same configuration, so `config.tiled` of the result tells whether a tile
+ * has to be passed.
+ */
+ClSearchEngine::SearchKernels& ClSearchEngine::searchKernelsFor(size_t patternLen) {
+    if (m_searchKernels.config.tiled && !tileFits(m_searchKernels.config, patternLen)) {
+        return m_untiledKernels;
+    }
+    return m_searchKernels;
+}
+
+/**
+ * @brief Benchmarks the kernel variants on this device and keeps the fastest.
+ *
+ * A pseudo-random printable sample of `sampleSize` bytes with `substr` planted once
+ * per MiB is searched with every combination of strip (1, 4, 16, 64), tiling,
+ * vectorization (strips of 16 and more) and local size (64, 128, 256, within the
+ * device limit). Each variant runs once to warm up and to check its result against the
+ * default configuration, then `repetitions` times; its score is the lowest summed
+ * device time of the count, scan and scatter passes. Variants that fail to build,
+ * launch, or return a different result are skipped.
+ *
+ * @param[in] substr       The pattern to tune with.
+ * @param[in] sampleSize   Size of the sample text in bytes.
+ * @param[in] repetitions  Timed runs per variant.
+ *
+ * @return The fastest configuration, which is also set on the engine.
+ *
+ * @throws std::invalid_argument if `substr` is empty or longer than the sample.
+ */
+ClKernelConfig ClSearchEngine::autotune(std::string_view substr, size_t sampleSize, unsigned repetitions) {
+    PROFILE_FUNCTION();
+    if (substr.empty() || substr.length() > sampleSize) {
+        throw std::invalid_argument("Tuning pattern must be non-empty and fit in the sample.");
+    }
+
+    // xorshift64 sample over the printable range; content does not need to be good randomness
+    std::string sample(sampleSize, '\0');
+    std::uint64_t state = 0x9e3779b97f4a7c15ULL;
+    for (auto& c: sample) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        c = static_cast<char>(32 + state % 95);
+    }
+    const size_t plantDistance = 1024 * 1024;
+    for (size_t position = plantDistance / 2; position + substr.length() <= sampleSize; position += plantDistance) {
+        sample.replace(position, substr.length(), substr);
+    }
+
+    cl::Buffer text(m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, sampleSize, sample.data());
+    uploadPattern(substr);
+    int textLen = sampleSize;
+    int patternLen = substr.length();
+
+    std::vector<cl::Event> events;
+    setKernelConfig(ClKernelConfig{});
+    std::vector<int> expected = findAllOnDevice(text, textLen, patternLen, nullptr, events);
+
+    std::vector<ClKernelConfig> candidates;
+    size_t maxLocalSize = m_device.getInfo<CL_DEVICE_MAX_WORK_GROUP_SIZE>();
+    for (size_t localSize: {64, 128, 256}) {
+        for (unsigned strip: {1, 4, 16, 64}) {
+            for (bool tiled: {false, true}) {
+                for (bool vectorized: {false, true}) {
+                    ClKernelConfig config{strip, tiled, vectorized, localSize};
+                    if (localSize > maxLocalSize || (vectorized && strip % 16 != 0) ||
+                        (tiled && !tileFits(config, patternLen))) {
+                        continue;
+                    }
+                    candidates.push_back(config);
+                }
+            }
+        }
+    }
+
+    ClKernelConfig best{};
+    cl_ulong bestTime = ~cl_ulong(0);
+    for (const auto& candidate: candidates) {
+        cl_ulong candidateTime = ~cl_ulong(0);
+        try {
+            setKernelConfig(candidate);
+
+            events.clear();
+            if (findAllOnDevice(text, textLen, patternLen, nullptr, events) != expected) {
+                std::cerr << "Skipping kernel " << candidate.name() << ": wrong result" << std::endl;
+                continue;
+            }
+            for (unsigned r = 0; r < repetitions; r++) {
+                events.clear();
+                findAllOnDevice(text, textLen, patternLen, nullptr, events);
+                candidateTime = std::min(candidateTime, deviceTime(events));
+            }
+        } catch (cl::Error& e) {
+            std::cerr << "Skipping kernel " << candidate.name() << ": " << e.what() << std::endl;
+            continue;
+        }
+
+        if (candidateTime < bestTime) {
+            bestTime = candidateTime;
+            best = candidate;
+        }
+    }
+
+    setKernelConfig(best);
+    return kernelConfig();
+}
+
+/**
+ * @brief Returns the key under which this device's configuration is stored.
+ */
+std::string ClSearchEngine::deviceKey() const {
+    return m_device.getInfo<CL_DEVICE_NAME>() + " / " + m_device.getInfo<CL_DRIVER_VERSION>();
+}
+
+/**
+ * @brief Sets the configuration stored for this device in `fileName`.
+ *
+ * The file holds one line per device, the device key and the configuration separated
+ * by a tab. A configuration that no longer validates is ignored.
+ *
+ * @param[in] fileName  The configuration file.
+ *
+ * @return true if a configuration for this device was found and set.
+ */
+bool ClSearchEngine::loadKernelConfig(const std::string& fileName) {
+    std::ifstream file(fileName);
+    std::string key = deviceKey();
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.rfind(key + "\t", 0) != 0) {
+            continue;
+        }
+
+        ClKernelConfig config;
+        std::istringstream fields(line.substr(key.length() + 1));
+        if (!(fields >> config.strip >> config.tiled >> config.vectorized >> config.localSize)) {
+            return false;
+        }
+        try {
+            setKernelConfig(config);
+        } catch (std::invalid_argument&) {
+            return false;
+        }
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Stores the current configuration for this device in `fileName`.
+ *
+ * Lines of other devices are kept; a previous line of this device is replaced.
+ *
+ * @param[in] fileName  The configuration file.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void ClSearchEngine::saveKernelConfig(const std::string& fileName) const {
+    std::string key = deviceKey();
+    std::vector<std::string> lines;
+    {
+        std::ifstream file(fileName);
+        std::string line;
+        while (std::getline(file, line)) {
+            if (line.rfind(key + "\t", 0) != 0) {
+                lines.push_back(line);
+            }
+        }
+    }
+
+    const ClKernelConfig& config = kernelConfig();
+    std::ostringstream entry;
+    entry << key << '\t' << config.strip << ' ' << config.tiled << ' ' << config.vectorized << ' ' << config.localSize;
+    lines.push_back(entry.str());
+
+    std::ofstream file(fileName);
+    for (const auto& line: lines) {
+        file << line << '\n';
+    }
+    if (!file) {
+        throw std::runtime_error("Failed to write file: " + fileName);
+    }
+}
+
+/**
+ * @brief Returns a short description such as "strip=16 tiled=1 vectorized=1 local=256".
+ */
+std::string ClKernelConfig::name() const {
+    return "strip=" + std::to_string(strip) + " tiled=" + std::to_string(tiled) +
+           " vectorized=" + std::to_string(vectorized) + " local=" + std::to_string(localSize);
+}
+
+/**
+ * @brief Finds every occurrence of every pattern of `automaton` in one pass over `str`.
+ *
+ * The automaton tables are uploaded per call; they are tiny compared to the text. The
+ * PFAC kernels are built on first use, once for __constant tables and once for
+ * __global tables, and the variant is chosen by whether the tables fit in the
+ * device's constant memory.
+ *
+ * @param[in] str        The input text to search in.
+ * @param[in] automaton  The patterns, compiled into a byte-class compressed trie.
+ *
+ * @return All matches ordered by offset, then pattern id.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<PatternMatch> ClSearchEngine::findAllPatterns(std::string_view str, const AhoCorasick& automaton) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+    if (str.empty()) {
+        return {};
+    }
+
+    const auto& byteClasses = automaton.byteClasses();
+    const auto& trie = automaton.trie();
+    const auto& exactStart = automaton.exactStart();
+    const auto& exactIds = automaton.exactIds();
+
+    size_t byteClassesSize = sizeof(cl_ushort) * byteClasses.size();
+    size_t trieSize = sizeof(cl_int) * trie.size();
+    size_t exactStartSize = sizeof(cl_int) * exactStart.size();
+    size_t exactIdsSize = sizeof(cl_int) * exactIds.size();
+
+    cl::Buffer text = uploadText(str);
+
+    Timer bufferTimer("Create Buffers");
+    cl::Buffer d_byteClasses(m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, byteClassesSize, (void*)byteClasses.data());
+    cl::Buffer d_trie(m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, trieSize, (void*)trie.data());
+    cl::Buffer d_exactStart(m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, exactStartSize, (void*)exactStart.data());
+    cl::Buffer d_exactIds(m_context, CL_MEM_READ_ONLY | CL_MEM_COPY_HOST_PTR, exactIdsSize, (void*)exactIds.data());
+    bufferTimer.stop();
+
+    // every table is a separate __constant argument, so all of them must fit together
+    size_t tableSize = byteClassesSize + trieSize + exactStartSize + exactIdsSize;
+    bool useConstant = tableSize <= m_device.getInfo<CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE>();
+    PatternKernels& kernels = patternKernels(useConstant);
+
+    int textLen = str.length();
+    int classCount = automaton.classCount();
+
+    std::vector<cl::Event> events;
+    int totalMatches {0};
+    {
+        PROFILE_SCOPE("Run Kernel");
 
-#ifdef __APPLE__
-#include <OpenCL/cl.h>
-#else
-#include <CL/cl.h>
-#endif
+        kernels.count.setArg(0, text);
+        kernels.count.setArg(1, d_byteClasses);
+        kernels.count.setArg(2, d_trie);
+        kernels.count.setArg(3, d_exactStart);
+        kernels.count.setArg(5, textLen);
+        kernels.count.setArg(6, classCount);
 
-#include <ctime>
-#include <iostream>
-#include <sys/types.h>
-#define CL_HPP_ENABLE_EXCEPTIONS
-#include <string>
-#define CL_HPP_TARGET_OPENCL_VERSION 120 
-#define CL_HPP_MINIMUM_OPENCL_VERSION 120
-#include "CL/opencl.hpp"
+        kernels.scatter.setArg(0, text);
+        kernels.scatter.setArg(1, d_byteClasses);
+        kernels.scatter.setArg(2, d_trie);
+        kernels.scatter.setArg(3, d_exactStart);
+        kernels.scatter.setArg(4, d_exactIds);
+        kernels.scatter.setArg(7, textLen);
+        kernels.scatter.setArg(8, classCount);
+
+        totalMatches = compactOnDevice(kernels.count, 4, kernels.scatter, 5, 6,
+                                       roundUp(textLen, m_localSize), m_localSize, sizeof(cl_int2), nullptr, events);
+        record_cl_time(events);
+    }
+
+    Timer readTimer("Read Result");
+    std::vector<PatternMatch> hostResults(totalMatches);
+    if (totalMatches > 0) {
+        m_queue.enqueueReadBuffer(m_result, CL_TRUE, 0, sizeof(cl_int2) * totalMatches, hostResults.data());
+    }
+    readTimer.stop();
 
+    // within one offset the kernel emits shorter patterns first
+    std::sort(hostResults.begin(), hostResults.end());
+    return hostResults;
+}
 
 /**
- * @brief Records and profiles the timing information for a given OpenCL event.
+ * @brief Returns the multi-pattern kernels for __constant or __global tables, building them on first use.
  *
- * Retrieves queued-to-submit and start-to-end timestamps from the event,
- * converts them to milliseconds, and feeds them into the custom profiler.
+ * @param[in] useConstant  Select the variant that reads the tables from __constant memory.
  *
- * @param[in] event  The OpenCL event whose profiling timestamps will be queried.
+ * @throws cl::Error if the program build fails.
+ */
+ClSearchEngine::PatternKernels& ClSearchEngine::patternKernels(bool useConstant) {
+    PatternKernels& kernels = m_patternKernels[useConstant ? 1 : 0];
+    if (kernels.built) {
+        return kernels;
+    }
+
+    Timer buildTimer("Build Program");
+    std::string buildOptions = "-D LOCAL_SIZE=" + std::to_string(m_localSize);
+    buildOptions += useConstant ? " -D TABLE_SPACE=__constant" : " -D TABLE_SPACE=__global";
+    cl::Program program = buildProgram(multiPatternSource, buildOptions);
+    kernels.count = cl::Kernel(program, "countPatternMatches");
+    kernels.scatter = cl::Kernel(program, "scatterPatternMatches");
+    kernels.built = true;
+    buildTimer.stop();
+
+    return kernels;
+}
+
+/**
+ * @brief Finds every position where a substring occurs with at most `maxMismatches` mismatches.
  *
- * @throws cl::Error if any of the calls to getProfilingInfo() fail.
+ * One work-item per start position counts mismatches until the pattern ends or the
+ * limit is exceeded; the matches are compacted with their distance by the same count,
+ * prefix-sum and scatter pipeline as the exact find-all.
+ *
+ * @param[in] str            The input text to search in.
+ * @param[in] substr         The pattern to search for.
+ * @param[in] maxMismatches  The largest Hamming distance reported.
+ *
+ * @return Every (offset, distance) with distance <= `maxMismatches`, in ascending offset order.
+ *
+ * @throws std::invalid_argument if `maxMismatches` is negative or not below the pattern length.
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<ApproximateMatch> ClSearchEngine::findAllHamming(std::string_view str, std::string_view substr,
+                                                             int maxMismatches) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+    if (substr.empty()) {
+        return {};
+    }
+    if (maxMismatches < 0 || static_cast<size_t>(maxMismatches) >= substr.length()) {
+        throw std::invalid_argument("Maximum distance must be non-negative and below the pattern length.");
+    }
+    if (substr.length() > str.length()) {
+        return {};
+    }
+
+    cl::Buffer text = uploadText(str);
+    uploadPattern(substr);
+
+    int textLen = str.length();
+    int patternLen = substr.length();
+    size_t positions = str.length() - substr.length() + 1;
+
+    std::vector<cl::Event> events;
+    int totalMatches {0};
+    {
+        PROFILE_SCOPE("Run Kernel");
+
+        m_countHammingKernel.setArg(0, text);
+        m_countHammingKernel.setArg(1, m_pattern);
+        m_countHammingKernel.setArg(3, textLen);
+        m_countHammingKernel.setArg(4, patternLen);
+        m_countHammingKernel.setArg(5, maxMismatches);
+
+        m_scatterHammingKernel.setArg(0, text);
+        m_scatterHammingKernel.setArg(1, m_pattern);
+        m_scatterHammingKernel.setArg(4, textLen);
+        m_scatterHammingKernel.setArg(5, patternLen);
+        m_scatterHammingKernel.setArg(6, maxMismatches);
+
+        totalMatches = compactOnDevice(m_countHammingKernel, 2, m_scatterHammingKernel, 2, 3,
+                                       roundUp(positions, m_localSize), m_localSize, sizeof(cl_int2), nullptr, events);
+        record_cl_time(events);
+    }
+
+    Timer readTimer("Read Result");
+    std::vector<ApproximateMatch> hostResults(totalMatches);
+    if (totalMatches > 0) {
+        m_queue.enqueueReadBuffer(m_result, CL_TRUE, 0, sizeof(cl_int2) * totalMatches, hostResults.data());
+    }
+    readTimer.stop();
+
+    return hostResults;
+}
+
+/**
+ * @brief Copies `str` into a device buffer that stays resident for findAllBatch().
+ *
+ * Unlike uploadText() the host memory is never wrapped, so later batches read device
+ * memory and the caller's buffer may change. The upload is blocking.
+ *
+ * @param[in] str  The text to keep on the device.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if the buffer allocation or the upload fails.
  */
-void record_cl_time(cl::Event &event); 
+void ClSearchEngine::setHaystack(std::string_view str) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Haystack");
+
+    Timer bufferTimer("Create Buffers");
+    // a zero-sized buffer is invalid, keep at least one byte
+    ensureCapacity(m_haystack, m_haystackCapacity, std::max<size_t>(str.length(), 1), CL_MEM_READ_ONLY);
+    if (!str.empty()) {
+        m_queue.enqueueWriteBuffer(m_haystack, CL_TRUE, 0, sizeof(cl_char) * str.length(), str.data());
+    }
+    m_haystackLength = str.length();
+    bufferTimer.stop();
+}
 
 /**
- * @brief Searches for all occurrences of a substring in a string using an OpenCL kernel.
+ * @brief Finds all occurrences of every needle in the resident haystack.
  *
- * This function sets up an OpenCL context and queue, builds a simple substring-search
- * kernel, dispatches it over each possible start position, and collects up to 100 match indices.
- * Profiling scopes (via PROFILE_FUNCTION and PROFILE_SCOPE) and timers measure each stage.
+ * Needles that cannot match are answered on the host. The others are grouped in
+ * order into batches that respect the device's constant buffer size (needle bytes
+ * plus offset table) and maxBatchGroups, and every batch runs through findAllPacked().
+ *
+ * @param[in] needles  The patterns to search for.
+ *
+ * @return One ascending result list per needle, in the order of `needles`.
+ *
+ * @throws std::runtime_error if no haystack has been set.
+ * @throws std::invalid_argument if a needle does not fit in constant memory.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<std::vector<int>> ClSearchEngine::findAllBatch(const std::vector<std::string>& needles) {
+    PROFILE_FUNCTION();
+    if (m_haystackLength < 0) {
+        throw std::runtime_error("No haystack on the device, call setHaystack() first.");
+    }
+
+    std::vector<std::vector<int>> hostResults(needles.size());
+
+    const ClKernelConfig& config = m_searchKernels.config;
+    size_t groupSpan = config.localSize * config.strip;
+    size_t groupsPerQuery = std::max<size_t>(roundUp(m_haystackLength, groupSpan) / groupSpan, 1);
+    size_t maxQueries = std::max<size_t>(maxBatchGroups / groupsPerQuery, 1);
+    size_t constantSize = m_device.getInfo<CL_DEVICE_MAX_CONSTANT_BUFFER_SIZE>();
+
+    std::vector<cl::Event> events;
+    std::vector<std::string_view> batch;
+    std::vector<size_t> batchIndices;
+    size_t packedSize = 0;
+    auto flush = [&]() {
+        if (batch.empty()) {
+            return;
+        }
+        std::vector<std::vector<int>> batchResults = findAllPacked(batch, events);
+        for (size_t k = 0; k < batch.size(); k++) {
+            hostResults[batchIndices[k]] = std::move(batchResults[k]);
+        }
+        batch.clear();
+        batchIndices.clear();
+        packedSize = 0;
+    };
+
+    for (size_t i = 0; i < needles.size(); i++) {
+        const std::string& needle = needles[i];
+        if (needle.empty() || needle.length() > static_cast<size_t>(m_haystackLength)) {
+            continue;
+        }
+        if (needle.length() > constantSize || sizeof(cl_int) * 2 > constantSize - needle.length()) {
+            throw std::invalid_argument("Needle does not fit in the device's constant memory.");
+        }
+        // the needle bytes and the offset table are each a __constant argument
+        size_t offsetsSize = sizeof(cl_int) * (batch.size() + 2);
+        if (batch.size() == maxQueries || packedSize + needle.length() + offsetsSize > constantSize) {
+            flush();
+        }
+        batch.push_back(needle);
+        batchIndices.push_back(i);
+        packedSize += needle.length();
+    }
+    flush();
+
+    record_cl_time(events);
+    return hostResults;
+}
+
+/**
+ * @brief Runs one batched count, prefix-sum and scatter pipeline over the resident haystack.
+ *
+ * The needles are packed into m_needles with their start offsets in m_needleOffsets.
+ * Every query gets the same number of work-groups, enough for a one-byte needle, and
+ * the groups are laid out query-major, so compactOnDevice() leaves the matches sorted
+ * by query and then by position. The scanned offset of each query's first group is
+ * where its results begin; these are read back in one strided copy.
+ *
+ * @param[in] needles  The needles of this batch, all non-empty and no longer than the haystack.
+ * @param[out] events  Collects the kernel events for profiling.
+ *
+ * @return One ascending result list per needle.
+ *
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+std::vector<std::vector<int>> ClSearchEngine::findAllPacked(const std::vector<std::string_view>& needles,
+                                                            std::vector<cl::Event>& events) {
+    std::string packed;
+    std::vector<cl_int> offsets { 0 };
+    size_t maxNeedleLen = 0;
+    for (auto needle: needles) {
+        packed += needle;
+        offsets.push_back(packed.length());
+        maxNeedleLen = std::max(maxNeedleLen, needle.length());
+    }
+
+    Timer bufferTimer("Create Buffers");
+    ensureCapacity(m_needles, m_needlesCapacity, sizeof(cl_char) * packed.length(), CL_MEM_READ_ONLY);
+    ensureCapacity(m_needleOffsets, m_needleOffsetsCapacity, sizeof(cl_int) * offsets.size(), CL_MEM_READ_ONLY);
+    // the blocking reads below keep `packed` and `offsets` alive until the in-order queue consumed them
+    m_queue.enqueueWriteBuffer(m_needles, CL_FALSE, 0, sizeof(cl_char) * packed.length(), packed.data());
+    m_queue.enqueueWriteBuffer(m_needleOffsets, CL_FALSE, 0, sizeof(cl_int) * offsets.size(), offsets.data());
+    bufferTimer.stop();
+
+    // the longest needle sizes the halo
+    SearchKernels& kernels = searchKernelsFor(maxNeedleLen);
+    const ClKernelConfig& config = kernels.config;
+
+    size_t groupSpan = config.localSize * config.strip;
+    int groupsPerQuery = std::max<size_t>(roundUp(m_haystackLength, groupSpan) / groupSpan, 1);
+    size_t numGroups = needles.size() * groupsPerQuery;
+    cl::LocalSpaceArg tile = cl::Local(config.tiled ? groupSpan + maxNeedleLen - 1 : 1);
+
+    int totalMatches {0};
+    {
+        PROFILE_SCOPE("Run Kernel");
+
+        kernels.countBatch.setArg(0, m_haystack);
+        kernels.countBatch.setArg(1, m_needles);
+        kernels.countBatch.setArg(2, m_needleOffsets);
+        kernels.countBatch.setArg(4, m_haystackLength);
+        kernels.countBatch.setArg(5, groupsPerQuery);
+        kernels.countBatch.setArg(6, tile);
+
+        kernels.scatterBatch.setArg(0, m_haystack);
+        kernels.scatterBatch.setArg(1, m_needles);
+        kernels.scatterBatch.setArg(2, m_needleOffsets);
+        kernels.scatterBatch.setArg(5, m_haystackLength);
+        kernels.scatterBatch.setArg(6, groupsPerQuery);
+        kernels.scatterBatch.setArg(7, tile);
+
+        totalMatches = compactOnDevice(kernels.countBatch, 3, kernels.scatterBatch, 3, 4,
+                                       numGroups * config.localSize, config.localSize,
+                                       sizeof(int), nullptr, events);
+    }
+
+    Timer readTimer("Read Result");
+    std::vector<std::vector<int>> hostResults(needles.size());
+    if (totalMatches > 0) {
+        // every groupsPerQuery-th scanned offset, the last one being the total
+        std::vector<cl_int> queryOffsets(needles.size() + 1);
+        m_queue.enqueueReadBufferRect(m_groupOffsets, CL_FALSE,
+                                      cl::array<cl::size_type, 3> { 0, 0, 0 },
+                                      cl::array<cl::size_type, 3> { 0, 0, 0 },
+                                      cl::array<cl::size_type, 3> { sizeof(cl_int), queryOffsets.size(), 1 },
+                                      sizeof(cl_int) * groupsPerQuery, 0, sizeof(cl_int), 0,
+                                      queryOffsets.data());
+        std::vector<int> matches(totalMatches);
+        m_queue.enqueueReadBuffer(m_result, CL_TRUE, 0, sizeof(int) * totalMatches, matches.data());
+
+        for (size_t q = 0; q < needles.size(); q++) {
+            hostResults[q].assign(matches.begin() + queryOffsets[q], matches.begin() + queryOffsets[q + 1]);
+        }
+    }
+    readTimer.stop();
+
+    return hostResults;
+}
+
+/**
+ * @brief Finds the first occurrence of a substring in ordered waves that stop at the first match.
+ *
+ * Start positions are dispatched front to back in waves that begin at firstWaveSize
+ * and double up to maxWaveSize, so a match near the front costs a small launch and a
+ * long scan few launches. Within and across waves the candidates race on a
+ * device-side atomic_min, which later work-items also use to skip positions past the
+ * best match. After each wave the minimum is read back without blocking; the host
+ * waits for the read of the previous wave only, keeping one wave in flight, and stops
+ * launching as soon as a read shows a match. Text that has to be copied is uploaded
+ * wave by wave as well, so an early match also skips the rest of the transfer.
  *
  * @param[in] str     The input text to search in.
  * @param[in] substr  The pattern to search for.
  *
- * @return A vector of starting indices where `substr` was found in `str`. Contains at most
- *         100 entries, in ascending order.
+ * @return The index of the first occurrence, or -1 if `substr` does not occur.
  *
- * @throws cl::Error if any OpenCL call fails (e.g., context creation, program build, buffer
- *         operations, or kernel enqueue). Build failures will also print the build log
- *         to stderr before rethrowing.
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
  */
-std::vector<int> clSearch(const std::string& str, const std::string& substr) {
+int ClSearchEngine::findFirst(std::string_view str, std::string_view substr) {
     PROFILE_FUNCTION();
-    std::vector<int> hostResults(100, -1);
-    int resultCount {0};
+    checkTextLength(str, "Text");
+    if (substr.empty() || substr.length() > str.length()) {
+        return -1;
+    }
 
-    Timer setupTimer("Setup Context and Queue");
+    int noMatch    = INT_MAX;
+    int textLen    = str.length();
+    int patternLen = substr.length();
+    size_t positions = str.length() - substr.length() + 1;
 
-    // Create context (first available device)
-    cl::Context context(CL_DEVICE_TYPE_DEFAULT);
+    // aligned host memory is wrapped whole, anything else is copied in wave by wave
+    bool wrapped = reinterpret_cast<std::uintptr_t>(str.data()) % m_hostPtrAlignment == 0;
+    cl::Buffer text;
+    if (wrapped) {
+        text = uploadText(str);
+    } else {
+        ensureCapacity(m_text, m_textCapacity, sizeof(cl_char) * str.length(), CL_MEM_READ_ONLY);
+        text = m_text;
+    }
+    uploadPattern(substr);
+    m_queue.enqueueFillBuffer(m_firstMatch, noMatch, 0, sizeof(int));
 
-    // Create a command queue
-    cl::CommandQueue queue(context,  CL_QUEUE_PROFILING_ENABLE);
-    setupTimer.stop();
+    m_searchFirstKernel.setArg(0, text);
+    m_searchFirstKernel.setArg(1, m_pattern);
+    m_searchFirstKernel.setArg(2, m_firstMatch);
+    m_searchFirstKernel.setArg(3, textLen);
+    m_searchFirstKernel.setArg(4, patternLen);
 
-    //Each work-item checks if 'substr' occurs at position `i` of 'str'.
-    std::string kernelSource = R"(
-    __kernel void searchAllLimited(__global const char* str,
-                                   __constant const char* substr,
-                                   __global int* outMatches,
-                                   __global int* matchCount,
-                                   int strLen,
-                                   int subLen)
+    std::vector<cl::Event> events;
+    // the read of the wave in flight and of the one before it
+    int readBack[2] = {noMatch, noMatch};
+    cl::Event readEvents[2];
+    int firstMatch = noMatch;
     {
-        int i = get_global_id(0);
+        PROFILE_SCOPE("Run Kernel");
 
-        if (i <= strLen - subLen) {
-            // Compare substring at position i
-            for (int j = 0; j < subLen; ++j) {
-                if (str[i + j] != substr[j]) {
-                    return; // Not a match
-                }
+        size_t waveStart = 0;
+        size_t waveSize = firstWaveSize;
+        size_t uploaded = 0;
+        for (size_t wave = 0; waveStart < positions; wave++) {
+            size_t waveLength = std::min(waveSize, positions - waveStart);
+
+            if (!wrapped) {
+                size_t waveEnd = waveStart + waveLength + substr.length() - 1;
+                m_queue.enqueueWriteBuffer(m_text, CL_FALSE, uploaded, waveEnd - uploaded, str.data() + uploaded);
+                uploaded = waveEnd;
             }
-            // It's a match: use an atomic to reserve a slot, if any remain
-            int slot = atomic_inc(matchCount);
-            // If we still have space in our array, record the position
-            if (slot < 100) {
-                outMatches[slot] = i;
+
+            cl::Event kernelEvent;
+            m_searchFirstKernel.setArg(5, static_cast<int>(waveStart));
+            m_queue.enqueueNDRangeKernel(m_searchFirstKernel, cl::NullRange, cl::NDRange(waveLength),
+                                         cl::NullRange, nullptr, &kernelEvent);
+            events.push_back(kernelEvent);
+            m_queue.enqueueReadBuffer(m_firstMatch, CL_FALSE, 0, sizeof(int), &readBack[wave % 2],
+                                      nullptr, &readEvents[wave % 2]);
+            m_queue.flush();
+
+            if (wave > 0) {
+                readEvents[(wave - 1) % 2].wait();
+                if (readBack[(wave - 1) % 2] != noMatch) {
+                    firstMatch = readBack[(wave - 1) % 2];
+                    break;
+                }
             }
+
+            waveStart += waveLength;
+            waveSize = std::min(2 * waveSize, maxWaveSize);
         }
     }
-  )";
 
-    // build the program
-    Timer buildTimer("Build Program");
-    // Build the program.
-    cl::Program program(context, kernelSource);
-    try {
-        program.build();
-    } catch (cl::Error& e) {
-        // In case of a build error, print the build log.
-        auto devices = context.getInfo<CL_CONTEXT_DEVICES>();
-        std::cerr << "Build failed for device: "
-                  << program.getBuildInfo<CL_PROGRAM_BUILD_LOG>(devices[0])
-                  << std::endl;
-        throw;
+    // the last wave's read; after an early stop this also waits for the read still in flight
+    Timer readTimer("Read Result");
+    m_queue.finish();
+    readTimer.stop();
+    if (firstMatch == noMatch) {
+        firstMatch = std::min(readBack[0], readBack[1]);
     }
-    buildTimer.stop();
 
-    Timer bufferTimer("Create Buffers");
-    int numTextElements = str.length();
-    int textLen    = numTextElements;
-    int patternLen = substr.length();
+    record_cl_time(events);
 
+    return firstMatch == noMatch ? -1 : firstMatch;
+}
 
-    // provide the text and pattern data to device
-    cl::Buffer d_text(
-        context,
-        CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR, 
-        sizeof(cl_char) * numTextElements,
-        (void*)str.data() 
-   );
+/**
+ * @brief Counts the occurrences of a substring without materializing their positions.
+ *
+ * Runs only the count pass of the find-all pipeline, so every work-group reduces its
+ * matches in local memory and writes a single count; the counts are summed by the
+ * device-side scan and only the total is read back. No match position is written.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The number of (possibly overlapping) occurrences of `substr` in `str`.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws cl::Error if any buffer operation or kernel enqueue fails.
+ */
+int ClSearchEngine::count(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    checkTextLength(str, "Text");
+    if (substr.empty() || substr.length() > str.length()) {
+        return 0;
+    }
 
+    int textLen    = str.length();
+    int patternLen = substr.length();
 
-    cl::Buffer d_pattern(
-        context,
-        CL_MEM_READ_ONLY | CL_MEM_USE_HOST_PTR,
-        sizeof(cl_char) * patternLen,
-        (void*)substr.data()
-    );
+    cl::Buffer text = uploadText(str);
+    uploadPattern(substr);
 
-    cl::Buffer d_result(
-        context,
-        CL_MEM_WRITE_ONLY,
-        sizeof(int) * 100
-    );
+    SearchKernels& kernels = searchKernelsFor(patternLen);
+    const ClKernelConfig& config = kernels.config;
+    size_t strips = (textLen - patternLen + config.strip) / config.strip;
+    cl::LocalSpaceArg tile = cl::Local(config.tiled ? config.localSize * config.strip + patternLen - 1 : 1);
 
-    cl::Buffer d_matchCount(
-        context,
-        CL_MEM_READ_WRITE | CL_MEM_USE_HOST_PTR,
-        sizeof(int),
-        &resultCount
-    );
+    std::vector<cl::Event> events;
+    int total {0};
+    {
+        PROFILE_SCOPE("Run Kernel");
 
+        kernels.count.setArg(0, text);
+        kernels.count.setArg(1, m_pattern);
+        kernels.count.setArg(3, textLen);
+        kernels.count.setArg(4, patternLen);
+        kernels.count.setArg(5, tile);
 
-    bufferTimer.stop();
+        total = countOnDevice(kernels.count, 2, roundUp(strips, config.localSize), config.localSize,
+                              nullptr, events);
+    }
 
-    // used for timing kernel
-    cl::Event event;
+    record_cl_time(events);
+    return total;
+}
 
-    // run kernel
-    {
-        PROFILE_SCOPE("Run Kernel");
+/**
+ * @brief Searches for all occurrences of a substring in a string using an OpenCL kernel.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findAll(). The context, queue and program
+ * are created on the first call and reused afterwards.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
+ *
+ * @throws cl::Error if any OpenCL call fails (e.g., context creation, program build, buffer
+ *         operations, or kernel enqueue). Build failures will also print the build log
+ *         to stderr before rethrowing.
+ */
+std::vector<int> clSearch(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    return ClSearchEngine::Get().findAll(str, substr);
+}
+
+/**
+ * @brief Finds the first occurrence of a substring using the early-exit OpenCL waves.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findFirst().
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The index of the first occurrence, or -1 if `substr` does not occur.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+int clSearchFirst(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    return ClSearchEngine::Get().findFirst(str, substr);
+}
+
+/**
+ * @brief Counts the occurrences of a substring using the OpenCL count pass only.
+ *
+ * Thin wrapper around ClSearchEngine::Get().count().
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The number of (possibly overlapping) occurrences of `substr` in `str`.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+int clCount(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    return ClSearchEngine::Get().count(str, substr);
+}
 
-        cl::Kernel kernel(program, "searchAllLimited");
-        kernel.setArg(0, d_text);
-        kernel.setArg(1, d_pattern);
-        kernel.setArg(2, d_result);
-        kernel.setArg(3, d_matchCount);
-        kernel.setArg(4, textLen);
-        kernel.setArg(5, patternLen);
-        
-        // Enqueue kernel:
-        Timer enqueTimer("enqueueNDRangeKernel");
-        int error = queue.enqueueNDRangeKernel(
-            kernel,
-            cl::NullRange,
-            cl::NDRange(numTextElements),
-            cl::NullRange,
-            nullptr,
-            &event
-        );
-        enqueTimer.stop();
+/**
+ * @brief Searches for all occurrences of a substring, streaming the text through the device.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findAllStreaming() with the default chunk size.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+std::vector<int> clSearchStreaming(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    return ClSearchEngine::Get().findAllStreaming(str, substr);
+}
 
-        if (error != 0) { std::cerr << "CL Error Value " << error << std::endl;}
+/**
+ * @brief Searches for every occurrence of a set of patterns using the OpenCL PFAC kernels.
+ *
+ * Builds the Aho-Corasick automaton on the host and runs ClSearchEngine::Get().findAllPatterns().
+ *
+ * @param[in] str       The input text to search in.
+ * @param[in] patterns  The patterns to search for; a pattern's index is its id.
+ *
+ * @return All matches ordered by offset, then pattern id.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ * @throws std::invalid_argument if `patterns` is empty or contains an empty pattern.
+ */
+std::vector<PatternMatch> clMultiSearch(std::string_view str, const std::vector<std::string>& patterns) {
+    PROFILE_FUNCTION();
 
-        event.wait();
-        queue.finish();
+    Timer buildTimer("Build Automaton");
+    AhoCorasick automaton(patterns);
+    buildTimer.stop();
 
-        // record cl timing
-        record_cl_time(event);
+    return ClSearchEngine::Get().findAllPatterns(str, automaton);
+}
 
-    }
+/**
+ * @brief Searches for all positions within `maxMismatches` mismatches of a substring using OpenCL.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findAllHamming().
+ *
+ * @param[in] str            The input text to search in.
+ * @param[in] substr         The pattern to search for.
+ * @param[in] maxMismatches  The largest Hamming distance reported.
+ *
+ * @return Every (offset, distance) match in ascending offset order, like shiftAddFindAll().
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ * @throws std::invalid_argument if `maxMismatches` is negative or not below the pattern length.
+ */
+std::vector<ApproximateMatch> clHammingSearch(std::string_view str, std::string_view substr, int maxMismatches) {
+    PROFILE_FUNCTION();
+    return ClSearchEngine::Get().findAllHamming(str, substr, maxMismatches);
+}
 
-    // Read back the result
-    Timer readTimer("Read Result");
-    // Get the final value of matchCount
-    queue.enqueueReadBuffer(d_matchCount, CL_TRUE, 0, sizeof(int), &resultCount);
+/**
+ * @brief Searches for every needle of a batch with one haystack upload.
+ *
+ * Runs ClSearchEngine::Get().setHaystack() and findAllBatch() and merges the per-needle
+ * lists into PatternMatch records, so the batch path can be benchmarked and verified
+ * against the other multi-pattern backends.
+ *
+ * @param[in] str       The input text to search in.
+ * @param[in] patterns  The needles to search for; a needle's index is its id.
+ *
+ * @return All matches ordered by offset, then pattern id, like clMultiSearch().
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+std::vector<PatternMatch> clBatchSearch(std::string_view str, const std::vector<std::string>& patterns) {
+    PROFILE_FUNCTION();
 
-    // Read the first min(matchCountHost, 100) entries
-    size_t numMatches = std::min((size_t)resultCount, (size_t)100);
-    hostResults.resize(numMatches);
-    queue.enqueueReadBuffer(d_result, CL_TRUE, 0,
-                            sizeof(int)*numMatches,
-                            hostResults.data());
+    ClSearchEngine& engine = ClSearchEngine::Get();
+    engine.setHaystack(str);
+    std::vector<std::vector<int>> perNeedle = engine.findAllBatch(patterns);
 
-    readTimer.stop();
-    return hostResults;
+    std::vector<PatternMatch> matches;
+    for (size_t id = 0; id < perNeedle.size(); id++) {
+        for (int offset: perNeedle[id]) {
+            matches.push_back(PatternMatch{static_cast<int>(id), offset});
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
 }
 
 /**
@@ -206,10 +2401,10 @@ std::vector<int> clSearch(const std::string& str, const std::string& substr) {
  * @throws cl::Error if any of the calls to getProfilingInfo() fail.
  */
 void record_cl_time(cl::Event &event) {
-    
-    // returns the time passed in microseconds 
+
+    // returns the time passed in microseconds
     auto calcTime = [](cl_ulong &time_start, cl_ulong &time_end) {
-        return (time_end - time_start) /1000.0f; 
+        return (time_end - time_start) /1000.0f;
     };
 
     // get timing event
@@ -219,9 +2414,40 @@ void record_cl_time(cl::Event &event) {
     event.getProfilingInfo(CL_PROFILING_COMMAND_QUEUED, &time_start);
     event.getProfilingInfo(CL_PROFILING_COMMAND_SUBMIT, &time_end);
     PROFILE_CUSTOM_TIME("GPU Queue", calcTime(time_start, time_end));
-    
+
 
     event.getProfilingInfo(CL_PROFILING_COMMAND_START, &time_start);
     event.getProfilingInfo(CL_PROFILING_COMMAND_END, &time_end);
     PROFILE_CUSTOM_TIME("GPU Exec", calcTime(time_start, time_end));
 }
+
+/**
+ * @brief Records the summed timing information of several OpenCL events.
+ *
+ * Used for multi-pass pipelines, so a single query still produces one "GPU Queue"
+ * and one "GPU Exec" entry.
+ *
+ * @param[in] events  The OpenCL events whose profiling timestamps will be summed.
+ *
+ * @throws cl::Error if any of the calls to getProfilingInfo() fail.
+ */
+void record_cl_time(std::vector<cl::Event> &events) {
+    cl_ulong queueTime = 0;
+    cl_ulong execTime = 0;
+
+    for (auto& event: events) {
+        cl_ulong time_start = 0;
+        cl_ulong time_end = 0;
+
+        event.getProfilingInfo(CL_PROFILING_COMMAND_QUEUED, &time_start);
+        event.getProfilingInfo(CL_PROFILING_COMMAND_SUBMIT, &time_end);
+        queueTime += time_end - time_start;
+
+        event.getProfilingInfo(CL_PROFILING_COMMAND_START, &time_start);
+        event.getProfilingInfo(CL_PROFILING_COMMAND_END, &time_end);
+        execTime += time_end - time_start;
+    }
+
+    PROFILE_CUSTOM_TIME("GPU Queue", queueTime / 1000.0f);
+    PROFILE_CUSTOM_TIME("GPU Exec", execTime / 1000.0f);
+}
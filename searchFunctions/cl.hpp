@@ -1,20 +1,781 @@
+#ifndef CL_SEARCH_HPP
+#define CL_SEARCH_HPP
+#include <algorithm>
+#include <climits>
+#include <functional>
+#include <optional>
+#include <stdexcept>
 #include <string>
+#include <string_view>
+#include <vector>
+#include "approximateFunctions.hpp"
+#include "multiPattern.hpp"
+#include "resultSink.hpp"
+
+#ifdef __APPLE__
+#include <OpenCL/cl.h>
+#else
+#include <CL/cl.h>
+#endif
+
+#define CL_HPP_ENABLE_EXCEPTIONS
+#define CL_HPP_TARGET_OPENCL_VERSION 120
+#define CL_HPP_MINIMUM_OPENCL_VERSION 120
+#include "CL/opencl.hpp"
+
+/**
+ * @brief Chooses OpenCL devices across all platforms.
+ *
+ * Devices are enumerated platform by platform, in the order the ICD loader reports
+ * them. `type` and `vendor` filter that list, then `indices` pick entries of the
+ * filtered list, so "the second GPU" is {CL_DEVICE_TYPE_GPU, "", {1}}.
+ */
+struct ClDeviceSelector {
+    cl_device_type type = CL_DEVICE_TYPE_ALL;
+    // case-insensitive substring of the device vendor, platform vendor or platform name; empty for any
+    std::string vendor;
+    // positions in the filtered list, empty for every device
+    std::vector<size_t> indices;
+
+    /**
+     * @brief Parses a comma-separated selection such as "gpu", "vendor=intel" or "cpu,0,2".
+     *
+     * Every item is a device type (all, cpu, gpu or accelerator), `vendor=NAME`, or an
+     * index into the filtered list.
+     *
+     * @param[in] spec  The selection.
+     *
+     * @throws std::invalid_argument if an item is none of these.
+     */
+    static ClDeviceSelector parse(const std::string& spec);
+};
+
+/**
+ * @brief Returns the devices of every platform that match `selector`.
+ *
+ * @param[in] selector  The filters and indices; the default selects every device.
+ *
+ * @return The matching devices in platform order, empty when no OpenCL platform is installed.
+ *
+ * @throws std::invalid_argument if an index is past the end of the filtered list.
+ */
+std::vector<cl::Device> findClDevices(const ClDeviceSelector& selector = {});
+
+/**
+ * @brief Returns a one-line description of `device`, e.g. "NVIDIA GeForce RTX 2060 (NVIDIA Corporation, GPU, 30 compute units)".
+ */
+std::string clDeviceDescription(const cl::Device& device);
+
+/**
+ * @brief Sets the devices ClSearchEngine::Get() and ShardedSearcher::Get() are created on.
+ *
+ * Must be called before the first call to either; the engines keep the devices they were
+ * created on. Without a selection ClSearchEngine::Get() uses the default device of the
+ * default platform and ShardedSearcher::Get() every device.
+ *
+ * @param[in] selector  The devices to use.
+ */
+void setClDeviceSelector(const ClDeviceSelector& selector);
+
+/**
+ * @brief Returns the selection set by setClDeviceSelector(), if any.
+ */
+std::optional<ClDeviceSelector> clDeviceSelection();
+
+/**
+ * @brief Sets the directory compiled OpenCL programs are cached in; an empty string disables the cache.
+ *
+ * Every program an engine builds is stored there as a device binary, keyed by the device
+ * name, driver version, build options and source, so later processes load it instead of
+ * compiling. Applies to programs built afterwards.
+ *
+ * @param[in] directory  The cache directory, created on the first store.
+ */
+void setClProgramCacheDirectory(const std::string& directory);
+
+/**
+ * @brief Returns the directory compiled OpenCL programs are cached in, empty if caching is disabled.
+ *
+ * Without setClProgramCacheDirectory() this is $SS_ANALYTICS_CL_CACHE if set (empty
+ * disables the cache), else ss_analytics/opencl under $XDG_CACHE_HOME, ~/.cache or
+ * %LOCALAPPDATA%.
+ */
+std::string clProgramCacheDirectory();
+
+/**
+ * @brief Shape of the single-pattern count and scatter kernels.
+ *
+ * Every work-item scans `strip` consecutive start positions. A tiled kernel first
+ * copies the work-group's text plus the pattern-length halo into __local memory; a
+ * vectorized kernel compares 16 bytes at a time against the pattern's first byte with
+ * char16 loads and only verifies the hits. The fastest shape depends on the device,
+ * see ClSearchEngine::autotune().
+ */
+struct ClKernelConfig {
+    unsigned int strip = 1;
+    bool tiled = false;
+    bool vectorized = false;
+    // work-group size, 0 selects the engine default
+    size_t localSize = 0;
+
+    bool operator==(const ClKernelConfig&) const = default;
+
+    /**
+     * @brief Returns a short description such as "strip=16 tiled=1 vectorized=1 local=256".
+     */
+    std::string name() const;
+};
+
+/**
+ * @brief Long-lived OpenCL search engine.
+ *
+ * Creates the context, command queue and compiled search program once and keeps
+ * them, together with the device buffers, alive across calls. Per-query work is
+ * then limited to uploading the text, running the kernels and reading the result.
+ * Device buffers only grow, so repeated queries of similar size never reallocate.
+ *
+ * Find-all runs as a three-pass pipeline: every work-group counts its matches, the
+ * counts are turned into output offsets by a parallel exclusive prefix sum, and a
+ * scatter pass writes each match into its slot. The result is exact, uncapped and in
+ * ascending order without any global atomic. The count and scatter passes are built
+ * for a ClKernelConfig, which autotune() can choose per device.
+ *
+ * The kernels index the text with int positions, so calls that return int offsets
+ * accept texts of at most INT_MAX bytes and reject longer ones.
+ */
+class ClSearchEngine {
+public:
+    /**
+     * @brief Constructs the engine on the first device of the given type.
+     *
+     * @param[in] deviceType  OpenCL device type used to create the context.
+     *
+     * @throws cl::Error if context creation or the program build fails. Build failures
+     *         also print the build log to stderr before rethrowing.
+     */
+    explicit ClSearchEngine(cl_device_type deviceType = CL_DEVICE_TYPE_DEFAULT);
+
+    /**
+     * @brief Constructs the engine on `device`, with a context of its own.
+     *
+     * @param[in] device  The device to run on, e.g. one returned by findClDevices().
+     *
+     * @throws cl::Error if context creation or the program build fails.
+     */
+    explicit ClSearchEngine(const cl::Device& device);
+
+    /**
+     * @brief Returns the process-wide engine, creating it on first use.
+     *
+     * The engine runs on the first device of clDeviceSelection() if one was set, and on
+     * the default device otherwise.
+     *
+     * @throws std::runtime_error if the selection matches no device.
+     */
+    static ClSearchEngine& Get();
+
+    /**
+     * @brief Finds all occurrences of a substring using the persistent kernel.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     *
+     * @return A vector of all starting indices where `substr` was found in `str`, in
+     *         ascending order.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    std::vector<int> findAll(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Finds all occurrences of a substring and passes them to `sink`.
+     *
+     * Runs the passes of findAll() over the text in slices of residentChunkSize start
+     * positions, each with `substr.length() - 1` bytes of overlap, so every slice fits
+     * the int positions of the kernels however long the text is. The compacted results
+     * of a slice are read back in blocks of resultBlockSize into a host buffer the engine
+     * keeps across calls and handed to the sink as 64-bit offsets from the slice's start.
+     * No host memory is allocated per call once the buffer has grown to one block, and a
+     * sink that returns false stops the read-back.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     * @param[in] sink    Receives the offsets of the occurrences in ascending order.
+     *
+     * @throws std::invalid_argument if `substr` does not fit in a slice's overlap.
+     * @throws cl::Error if any buffer operation or kernel enqueue fails.
+     */
+    template<ResultSink Sink>
+    void findAllInto(std::string_view str, std::string_view substr, Sink& sink) {
+        if (substr.empty() || substr.length() > str.length()) {
+            return;
+        }
+        size_t overlap = substr.length() - 1;
+        if (overlap > static_cast<size_t>(INT_MAX) - residentChunkSize) {
+            throw std::invalid_argument("Pattern must be shorter than INT_MAX - residentChunkSize bytes.");
+        }
+
+        for (size_t chunkStart = 0; chunkStart + overlap < str.length(); chunkStart += residentChunkSize) {
+            int total = findAllResident(str.substr(chunkStart, residentChunkSize + overlap), substr);
+            for (int begin = 0; begin < total; begin += resultBlockSize) {
+                int count = std::min(resultBlockSize, total - begin);
+                readResultBlock(begin, count);
+                for (int i = 0; i < count; i++) {
+                    if (!sink(static_cast<MatchOffset>(chunkStart) + static_cast<MatchOffset>(m_resultBlock[i]))) {
+                        return;
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Finds the first occurrence of a substring in ordered waves that stop at the first match.
+     *
+     * The start positions are dispatched front to back in waves of firstWaveSize
+     * positions, doubling up to maxWaveSize. The waves share a device-side minimum
+     * index, and no wave is launched once a match has been read back, so a match
+     * near the front of a large text costs neither the full scan nor the full upload.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     *
+     * @return The index of the first occurrence, or -1 if `substr` does not occur.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    int findFirst(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Counts the occurrences of a substring without materializing their positions.
+     *
+     * Runs the count pass of findAll() with its work-group reduction and sums the
+     * group counts on the device; only the total is read back.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     *
+     * @return The number of (possibly overlapping) occurrences of `substr` in `str`.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    int count(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Finds all occurrences of a substring, streaming the text through the device in chunks.
+     *
+     * The text is split into chunks of `chunkSize` start positions, each uploaded with
+     * `substr.length() - 1` bytes of overlap so matches straddling a chunk edge are found
+     * exactly once. Chunks rotate through streamBufferCount device buffers and are
+     * uploaded on a dedicated transfer queue, so the upload of the next chunks overlaps
+     * the kernels of the current one. Device memory use is bounded by the chunk size,
+     * not the text size.
+     *
+     * @param[in] str        The input text to search in.
+     * @param[in] substr     The pattern to search for.
+     * @param[in] chunkSize  Number of start positions searched per chunk.
+     *
+     * @return A vector of all starting indices where `substr` was found in `str`, in
+     *         ascending order and relative to the start of `str`.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes; use
+     *         findAllStreamingInto() for longer texts.
+     */
+    std::vector<int> findAllStreaming(std::string_view str, std::string_view substr,
+                                      size_t chunkSize = defaultChunkSize);
+
+    /**
+     * @brief Streams the text through the device like findAllStreaming() and passes the occurrences to `sink`.
+     *
+     * Every chunk is searched with int positions relative to its own start, which are
+     * widened with the chunk's 64-bit base before they reach the sink, so the text may be
+     * longer than INT_MAX bytes. A sink that returns false stops the stream after the
+     * current chunk's uploads have completed.
+     *
+     * @param[in] str        The input text to search in.
+     * @param[in] substr     The pattern to search for.
+     * @param[in] sink       Receives the offsets of the occurrences in ascending order.
+     * @param[in] chunkSize  Number of start positions searched per chunk.
+     *
+     * @throws std::invalid_argument if a chunk with its overlap is longer than INT_MAX bytes.
+     */
+    template<ResultSink Sink>
+    void findAllStreamingInto(std::string_view str, std::string_view substr, Sink& sink,
+                              size_t chunkSize = defaultChunkSize) {
+        streamChunks(str, substr, chunkSize, [&](MatchOffset chunkStart, const std::vector<int>& positions) {
+            for (int position: positions) {
+                if (!sink(chunkStart + static_cast<MatchOffset>(position))) {
+                    return false;
+                }
+            }
+            return true;
+        });
+    }
+
+    /**
+     * @brief Finds every occurrence of every pattern of `automaton` in one pass over `str`.
+     *
+     * Each work-item walks the automaton's trie from one start position (failure-less
+     * Aho-Corasick), reading the tables from __constant memory when they fit and from
+     * __global memory otherwise.
+     *
+     * @param[in] str        The input text to search in.
+     * @param[in] automaton  The patterns, compiled into a byte-class compressed trie.
+     *
+     * @return All matches ordered by offset, then pattern id.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    std::vector<PatternMatch> findAllPatterns(std::string_view str, const AhoCorasick& automaton);
+
+    /**
+     * @brief Finds every position where a substring occurs with at most `maxMismatches` mismatches.
+     *
+     * Uses the per-offset structure of the exact kernels, but counts mismatches instead
+     * of stopping at the first one.
+     *
+     * @param[in] str            The input text to search in.
+     * @param[in] substr         The pattern to search for.
+     * @param[in] maxMismatches  The largest Hamming distance reported.
+     *
+     * @return Every (offset, distance) with distance <= `maxMismatches`, in ascending offset order.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes, or if `maxMismatches` is
+     *         negative or not below the pattern length.
+     */
+    std::vector<ApproximateMatch> findAllHamming(std::string_view str, std::string_view substr, int maxMismatches);
+
+    /**
+     * @brief Copies `str` into a device buffer that stays resident for findAllBatch().
+     *
+     * The copy is complete when the call returns, so `str` may change or go away
+     * afterwards; call setHaystack() again to search the new contents.
+     *
+     * @param[in] str  The text to keep on the device.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    void setHaystack(std::string_view str);
+
+    /**
+     * @brief Finds all occurrences of every needle in the resident haystack.
+     *
+     * The needles are packed back to back into one __constant buffer with an offset
+     * table and searched by a single count, prefix-sum and scatter pipeline; batches
+     * whose packed needles or group counts exceed the device limits are split into a
+     * few such pipelines. The haystack is not transferred again.
+     *
+     * @param[in] needles  The patterns to search for; empty needles and needles longer
+     *                     than the haystack have no occurrences.
+     *
+     * @return One list per needle, in the order of `needles`, holding its starting
+     *         indices in ascending order.
+     *
+     * @throws std::runtime_error if no haystack has been set.
+     * @throws std::invalid_argument if a needle does not fit in constant memory.
+     */
+    std::vector<std::vector<int>> findAllBatch(const std::vector<std::string>& needles);
+
+    /**
+     * @brief Returns the device the engine runs on.
+     */
+    const cl::Device& device() const { return m_device; }
+
+    /**
+     * @brief Returns the kernel configuration used by the single-pattern find-all.
+     */
+    const ClKernelConfig& kernelConfig() const;
+
+    /**
+     * @brief Builds the count and scatter kernels for `config` and uses them from now on.
+     *
+     * @param[in] config  The kernel configuration; a localSize of 0 selects the engine default.
+     *
+     * @throws std::invalid_argument if the strip is 0, the local size is not a power of two
+     *         or exceeds the device limit, or a vectorized strip is not a multiple of 16.
+     * @throws cl::Error if the program build fails.
+     */
+    void setKernelConfig(ClKernelConfig config);
+
+    /**
+     * @brief Benchmarks the kernel variants on this device and keeps the fastest.
+     *
+     * Every combination of strip, tiling, vectorization and local size supported by the
+     * device is verified against the default configuration and timed on a synthetic
+     * sample with the device's profiling timestamps.
+     *
+     * @param[in] substr       The pattern to tune with.
+     * @param[in] sampleSize   Size of the sample text in bytes.
+     * @param[in] repetitions  Timed runs per variant.
+     *
+     * @return The fastest configuration, which is also set on the engine.
+     *
+     * @throws std::invalid_argument if `substr` is empty or longer than the sample.
+     */
+    ClKernelConfig autotune(std::string_view substr, size_t sampleSize = defaultTuningSampleSize,
+                            unsigned repetitions = 3);
+
+    /**
+     * @brief Sets the configuration stored for this device in `fileName`.
+     *
+     * @param[in] fileName  The configuration file.
+     *
+     * @return true if a configuration for this device was found and set.
+     */
+    bool loadKernelConfig(const std::string& fileName);
+
+    /**
+     * @brief Stores the current configuration for this device in `fileName`, keeping other devices' entries.
+     *
+     * @param[in] fileName  The configuration file.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void saveKernelConfig(const std::string& fileName) const;
+
+    static constexpr size_t defaultChunkSize = 64 * 1024 * 1024;
+    static constexpr size_t streamBufferCount = 3;
+    static constexpr size_t defaultTuningSampleSize = 64 * 1024 * 1024;
+    static constexpr size_t firstWaveSize = 1024 * 1024;
+    static constexpr size_t maxWaveSize = 64 * 1024 * 1024;
+    static constexpr int resultBlockSize = 64 * 1024;
+    // start positions per findAllInto() slice, a multiple of the page size so aligned texts stay wrapped
+    static constexpr size_t residentChunkSize = size_t(1) << 30;
+
+private:
+    /**
+     * @brief Sets up the queues and builds the programs on the first device of `context`.
+     */
+    explicit ClSearchEngine(const cl::Context& context);
+
+    struct SearchKernels {
+        ClKernelConfig config;
+        cl::Kernel count;
+        cl::Kernel scatter;
+        cl::Kernel countBatch;
+        cl::Kernel scatterBatch;
+    };
+
+    /**
+     * @brief Builds `source` with `options` for the engine's device, loading and storing binaries in clProgramCacheDirectory().
+     *
+     * @throws cl::Error if the source fails to build.
+     */
+    cl::Program buildProgram(const std::string& source, const std::string& options);
+
+    /**
+     * @brief Builds the count and scatter kernels for `config`.
+     */
+    SearchKernels buildSearchKernels(const ClKernelConfig& config);
+
+    /**
+     * @brief Returns whether the tile, its halo and the per-group int scratch fit in local memory.
+     */
+    bool tileFits(const ClKernelConfig& config, size_t patternLen) const;
+
+    /**
+     * @brief Returns the count and scatter kernels for a pattern of `patternLen` bytes, untiled if its halo does not fit.
+     */
+    SearchKernels& searchKernelsFor(size_t patternLen);
+
+    /**
+     * @brief Returns the key under which this device's configuration is stored: device name and driver version.
+     */
+    std::string deviceKey() const;
+
+    struct PatternKernels {
+        bool built = false;
+        cl::Kernel count;
+        cl::Kernel scatter;
+    };
+
+    /**
+     * @brief Returns the multi-pattern kernels for __constant or __global tables, building them on first use.
+     */
+    PatternKernels& patternKernels(bool useConstant);
+
+    /**
+     * @brief Makes the text available to the device, wrapping page-aligned host memory without a copy.
+     *
+     * @return The buffer holding the text; only valid for the current call.
+     */
+    cl::Buffer uploadText(std::string_view str);
+
+    /**
+     * @brief Uploads the pattern, growing its device buffer when needed.
+     */
+    void uploadPattern(std::string_view substr);
+
+    /**
+     * @brief Reallocates `buffer` when it holds fewer than `size` bytes.
+     */
+    void ensureCapacity(cl::Buffer& buffer, size_t& capacity, size_t size, cl_mem_flags flags);
+
+    // receives a chunk's 64-bit start and its match positions, returns whether to go on
+    using ChunkCallback = std::function<bool(MatchOffset, const std::vector<int>&)>;
+
+    /**
+     * @brief Runs the chunked upload and search pipeline of findAllStreaming() and hands each chunk's matches to `onChunk`.
+     */
+    void streamChunks(std::string_view str, std::string_view substr, size_t chunkSize,
+                      const ChunkCallback& onChunk);
+
+    /**
+     * @brief Runs the passes of findAll() and leaves the compacted results in m_result.
+     *
+     * @return The number of results in m_result.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    int findAllResident(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Reads results [begin, begin + count) of m_result into m_resultBlock.
+     */
+    void readResultBlock(int begin, int count);
+
+    /**
+     * @brief Runs the count, prefix-sum and scatter passes into m_result without reading them back.
+     *
+     * @return The number of results in m_result.
+     */
+    int compactMatchesOnDevice(const cl::Buffer& text, int textLen, int patternLen,
+                               const std::vector<cl::Event>* waitEvents,
+                               std::vector<cl::Event>& events);
+
+    /**
+     * @brief Runs the count, prefix-sum and scatter passes over a text already on the device.
+     *
+     * @param[in] text        Device buffer holding the text.
+     * @param[in] textLen     Number of bytes of `text` to search.
+     * @param[in] patternLen  Length of the pattern held in m_pattern.
+     * @param[in] waitEvents  Events the first pass must wait for, or nullptr.
+     * @param[out] events     Collects the kernel events for profiling.
+     *
+     * @return The ascending match positions relative to the start of `text`.
+     */
+    std::vector<int> findAllOnDevice(const cl::Buffer& text, int textLen, int patternLen,
+                                     const std::vector<cl::Event>* waitEvents,
+                                     std::vector<cl::Event>& events);
+
+    /**
+     * @brief Runs one batched count, prefix-sum and scatter pipeline over the resident haystack.
+     *
+     * @param[in] needles  The needles of this batch, all non-empty and no longer than the haystack.
+     * @param[out] events  Collects the kernel events for profiling.
+     *
+     * @return One ascending result list per needle.
+     */
+    std::vector<std::vector<int>> findAllPacked(const std::vector<std::string_view>& needles,
+                                                std::vector<cl::Event>& events);
+
+    /**
+     * @brief Runs a count kernel and sums its per-group counts on the device.
+     *
+     * @return The sum of the counts; m_groupOffsets holds the scanned offsets.
+     */
+    int countOnDevice(cl::Kernel& countKernel, cl_uint countArg,
+                      size_t globalSize, size_t localSize,
+                      const std::vector<cl::Event>* waitEvents,
+                      std::vector<cl::Event>& events);
+
+    /**
+     * @brief Runs a count kernel, the prefix sum and a scatter kernel into m_result.
+     *
+     * @return The number of results written to m_result.
+     */
+    int compactOnDevice(cl::Kernel& countKernel, cl_uint countArg,
+                        cl::Kernel& scatterKernel, cl_uint offsetsArg, cl_uint resultArg,
+                        size_t globalSize, size_t localSize, size_t elementSize,
+                        const std::vector<cl::Event>* waitEvents,
+                        std::vector<cl::Event>& events);
+
+    /**
+     * @brief In-place exclusive prefix sum of `n` ints on the device.
+     *
+     * Each work-group scans 2 * m_localSize elements and emits its total; the totals are
+     * scanned recursively one level down and added back to the blocks.
+     *
+     * @param[in,out] data    Device buffer to scan.
+     * @param[in]     n       Number of elements in `data`.
+     * @param[in]     level   Recursion depth, selects the scratch buffer for block totals.
+     * @param[out]    events  Collects the kernel events for profiling.
+     */
+    void exclusiveScan(const cl::Buffer& data, int n, size_t level, std::vector<cl::Event>& events);
+
+private:
+    cl::Context m_context;
+    cl::Device m_device;
+    cl::CommandQueue m_queue;
+    cl::CommandQueue m_transferQueue;
+    cl::Program m_program;
+    cl::Kernel m_scanKernel;
+    cl::Kernel m_addOffsetsKernel;
+    cl::Kernel m_searchFirstKernel;
+    cl::Kernel m_countHammingKernel;
+    cl::Kernel m_scatterHammingKernel;
+    SearchKernels m_searchKernels;
+    // used instead of a tiled m_searchKernels when the pattern's halo does not fit
+    SearchKernels m_untiledKernels;
+    PatternKernels m_patternKernels[2];
+    size_t m_localSize;
+    size_t m_hostPtrAlignment;
+    size_t m_localMemSize;
+
+    cl::Buffer m_text;
+    size_t m_textCapacity;
+    cl::Buffer m_pattern;
+    size_t m_patternCapacity;
+    cl::Buffer m_groupOffsets;
+    size_t m_groupOffsetsCapacity;
+    std::vector<cl::Buffer> m_scanSums;
+    std::vector<size_t> m_scanSumsCapacity;
+    cl::Buffer m_result;
+    size_t m_resultCapacity;
+    // host side of findAllInto(), reused across calls
+    std::vector<int> m_resultBlock;
+    cl::Buffer m_firstMatch;
+    cl::Buffer m_haystack;
+    size_t m_haystackCapacity;
+    // length of the resident haystack, -1 before setHaystack()
+    int m_haystackLength;
+    cl::Buffer m_needles;
+    size_t m_needlesCapacity;
+    cl::Buffer m_needleOffsets;
+    size_t m_needleOffsetsCapacity;
+    cl::Buffer m_chunks[streamBufferCount];
+    size_t m_chunksCapacity[streamBufferCount];
+};
+
+/**
+ * @brief Records and profiles the timing information for a given OpenCL event.
+ *
+ * Retrieves queued-to-submit and start-to-end timestamps from the event,
+ * converts them to milliseconds, and feeds them into the custom profiler.
+ *
+ * @param[in] event  The OpenCL event whose profiling timestamps will be queried.
+ *
+ * @throws cl::Error if any of the calls to getProfilingInfo() fail.
+ */
+void record_cl_time(cl::Event &event);
+
+/**
+ * @brief Records the summed timing information of several OpenCL events.
+ *
+ * Used for multi-pass pipelines, so a single query still produces one "GPU Queue"
+ * and one "GPU Exec" entry.
+ *
+ * @param[in] events  The OpenCL events whose profiling timestamps will be summed.
+ *
+ * @throws cl::Error if any of the calls to getProfilingInfo() fail.
+ */
+void record_cl_time(std::vector<cl::Event> &events);
 
 /**
  * @brief Searches for all occurrences of a substring in a string using an OpenCL kernel.
  *
- * This function sets up an OpenCL context and queue, builds a simple substring-search
- * kernel, dispatches it over each possible start position, and collects up to 100 match indices.
- * Profiling scopes (via PROFILE_FUNCTION and PROFILE_SCOPE) and timers measure each stage.
+ * Thin wrapper around ClSearchEngine::Get().findAll(). The context, queue and program
+ * are created on the first call and reused afterwards.
  *
  * @param[in] str     The input text to search in.
  * @param[in] substr  The pattern to search for.
  *
- * @return A vector of starting indices where `substr` was found in `str`. Contains at most
- *         100 entries, in ascending order.
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
  *
  * @throws cl::Error if any OpenCL call fails (e.g., context creation, program build, buffer
  *         operations, or kernel enqueue). Build failures will also print the build log
  *         to stderr before rethrowing.
  */
-std::vector<int> clSearch(const std::string& str,const std::string& substr);
+std::vector<int> clSearch(std::string_view str,std::string_view substr);
+
+/**
+ * @brief Finds the first occurrence of a substring using the early-exit OpenCL waves.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findFirst().
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The index of the first occurrence, or -1 if `substr` does not occur.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+int clSearchFirst(std::string_view str, std::string_view substr);
+
+/**
+ * @brief Counts the occurrences of a substring using the OpenCL count pass only.
+ *
+ * Thin wrapper around ClSearchEngine::Get().count().
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The number of (possibly overlapping) occurrences of `substr` in `str`.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+int clCount(std::string_view str, std::string_view substr);
+
+/**
+ * @brief Searches for all occurrences of a substring, streaming the text through the device.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findAllStreaming() with the default chunk size.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+std::vector<int> clSearchStreaming(std::string_view str, std::string_view substr);
+
+/**
+ * @brief Searches for every occurrence of a set of patterns using the OpenCL PFAC kernels.
+ *
+ * Builds the Aho-Corasick automaton on the host and runs ClSearchEngine::Get().findAllPatterns().
+ *
+ * @param[in] str       The input text to search in.
+ * @param[in] patterns  The patterns to search for; a pattern's index is its id.
+ *
+ * @return All matches ordered by offset, then pattern id.
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ * @throws std::invalid_argument if `patterns` is empty or contains an empty pattern.
+ */
+std::vector<PatternMatch> clMultiSearch(std::string_view str, const std::vector<std::string>& patterns);
+
+/**
+ * @brief Searches for all positions within `maxMismatches` mismatches of a substring using OpenCL.
+ *
+ * Thin wrapper around ClSearchEngine::Get().findAllHamming().
+ *
+ * @param[in] str            The input text to search in.
+ * @param[in] substr         The pattern to search for.
+ * @param[in] maxMismatches  The largest Hamming distance reported.
+ *
+ * @return Every (offset, distance) match in ascending offset order, like shiftAddFindAll().
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ * @throws std::invalid_argument if `maxMismatches` is negative or not below the pattern length.
+ */
+std::vector<ApproximateMatch> clHammingSearch(std::string_view str, std::string_view substr, int maxMismatches);
+
+/**
+ * @brief Searches for every needle of a batch with one haystack upload.
+ *
+ * Runs ClSearchEngine::Get().setHaystack() and findAllBatch(). Callers that query the
+ * same text repeatedly should call setHaystack() once and findAllBatch() per batch.
+ *
+ * @param[in] str       The input text to search in.
+ * @param[in] patterns  The needles to search for; a needle's index is its id.
+ *
+ * @return All matches ordered by offset, then pattern id, like clMultiSearch().
+ *
+ * @throws cl::Error if any OpenCL call fails.
+ */
+std::vector<PatternMatch> clBatchSearch(std::string_view str, const std::vector<std::string>& patterns);
+
+#endif // CL_SEARCH_HPP
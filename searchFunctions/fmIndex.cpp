@@ -0,0 +1,586 @@
+#include "fmIndex.hpp"
+#include "threadPool.hpp"
+#include "../mappedFile.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <fstream>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+const char indexMagic[8] = {'S', 'S', 'F', 'M', 'I', 'D', 'X', '\0'};
+// bump when the image layout changes, so stale index files are rejected
+const std::uint32_t indexVersion = 1;
+
+// rows per parallel build task, a multiple of 64 so tasks never share a bitvector word
+const std::size_t buildChunkRows = 1 << 20;
+// occurrences per parallel locate task
+const std::size_t locateChunk = 4096;
+// below this length SA-IS sorts suffixes directly
+const std::int32_t naiveSortThreshold = 10;
+
+std::uint64_t align8(std::uint64_t offset) {
+    return (offset + 7) & ~std::uint64_t(7);
+}
+
+/**
+ * @brief Suffix array by induced sorting (SA-IS, Nong, Zhang and Chan 2009).
+ *
+ * Follows the formulation of the AtCoder Library: no sentinel is required, a suffix
+ * that is a prefix of another sorts first. LMS substrings are sorted by one induce
+ * pass, named, and if names repeat the reduced string is sorted recursively; a
+ * second induce pass from the sorted LMS suffixes then yields the suffix array.
+ *
+ * @param s      The string, n symbols in [0, upper].
+ * @param n      Length of `s`.
+ * @param upper  Largest symbol value.
+ *
+ * @return The start positions of all suffixes in lexicographic order.
+ */
+template<typename Symbol>
+std::vector<std::int32_t> suffixArray(const Symbol* s, std::int32_t n, std::int32_t upper) {
+    if (n == 0) {
+        return {};
+    }
+    if (n < naiveSortThreshold) {
+        std::vector<std::int32_t> sa(n);
+        std::iota(sa.begin(), sa.end(), 0);
+        std::sort(sa.begin(), sa.end(), [&](std::int32_t a, std::int32_t b) {
+            return std::lexicographical_compare(s + a, s + n, s + b, s + n);
+        });
+        return sa;
+    }
+
+    // S-type: the suffix at i is smaller than the one at i + 1; the last suffix is L-type
+    std::vector<bool> isS(n);
+    for (std::int32_t i = n - 2; i >= 0; i--) {
+        isS[i] = s[i] == s[i + 1] ? isS[i + 1] : s[i] < s[i + 1];
+    }
+
+    // bucketStart[c]: first row of bucket c, sStart[c]: first row of its S-type part
+    std::vector<std::int32_t> bucketStart(upper + 1), sStart(upper + 1);
+    for (std::int32_t i = 0; i < n; i++) {
+        if (!isS[i]) {
+            sStart[s[i]]++;
+        } else {
+            bucketStart[s[i] + 1]++;
+        }
+    }
+    for (std::int32_t c = 0; c <= upper; c++) {
+        sStart[c] += bucketStart[c];
+        if (c < upper) {
+            bucketStart[c + 1] += sStart[c];
+        }
+    }
+
+    std::vector<std::int32_t> sa(n);
+    std::vector<std::int32_t> bucket(upper + 1);
+    auto induce = [&](const std::vector<std::int32_t>& lms) {
+        std::fill(sa.begin(), sa.end(), -1);
+        std::copy(sStart.begin(), sStart.end(), bucket.begin());
+        for (std::int32_t d: lms) {
+            if (d != n) {
+                sa[bucket[s[d]]++] = d;
+            }
+        }
+        // L-type suffixes, left to right from the bucket starts
+        std::copy(bucketStart.begin(), bucketStart.end(), bucket.begin());
+        sa[bucket[s[n - 1]]++] = n - 1;
+        for (std::int32_t i = 0; i < n; i++) {
+            std::int32_t v = sa[i];
+            if (v >= 1 && !isS[v - 1]) {
+                sa[bucket[s[v - 1]]++] = v - 1;
+            }
+        }
+        // S-type suffixes, right to left from the bucket ends
+        std::copy(bucketStart.begin(), bucketStart.end(), bucket.begin());
+        for (std::int32_t i = n - 1; i >= 0; i--) {
+            std::int32_t v = sa[i];
+            if (v >= 1 && isS[v - 1]) {
+                sa[--bucket[s[v - 1] + 1]] = v - 1;
+            }
+        }
+    };
+
+    // leftmost S-type positions and their index among them
+    std::vector<std::int32_t> lmsIndex(n + 1, -1);
+    std::vector<std::int32_t> lms;
+    for (std::int32_t i = 1; i < n; i++) {
+        if (!isS[i - 1] && isS[i]) {
+            lmsIndex[i] = lms.size();
+            lms.push_back(i);
+        }
+    }
+    std::int32_t m = lms.size();
+
+    induce(lms);
+
+    if (m > 0) {
+        std::vector<std::int32_t> sortedLms;
+        sortedLms.reserve(m);
+        for (std::int32_t v: sa) {
+            if (lmsIndex[v] != -1) {
+                sortedLms.push_back(v);
+            }
+        }
+
+        // name the LMS substrings, equal substrings get equal names
+        std::vector<std::int32_t> reduced(m);
+        std::int32_t name = 0;
+        reduced[lmsIndex[sortedLms[0]]] = 0;
+        for (std::int32_t i = 1; i < m; i++) {
+            std::int32_t l = sortedLms[i - 1];
+            std::int32_t r = sortedLms[i];
+            std::int32_t endL = lmsIndex[l] + 1 < m ? lms[lmsIndex[l] + 1] : n;
+            std::int32_t endR = lmsIndex[r] + 1 < m ? lms[lmsIndex[r] + 1] : n;
+            bool same = endL - l == endR - r;
+            if (same) {
+                while (l < endL && s[l] == s[r]) {
+                    l++;
+                    r++;
+                }
+                same = l != n && s[l] == s[r];
+            }
+            if (!same) {
+                name++;
+            }
+            reduced[lmsIndex[sortedLms[i]]] = name;
+        }
+
+        std::vector<std::int32_t> reducedSa = suffixArray(reduced.data(), m, name);
+        for (std::int32_t i = 0; i < m; i++) {
+            sortedLms[i] = lms[reducedSa[i]];
+        }
+        induce(sortedLms);
+    }
+    return sa;
+}
+
+// section offsets of an index image
+struct Layout {
+    std::uint64_t bwt;
+    std::uint64_t checkpoints;
+    std::uint64_t sampledBits;
+    std::uint64_t sampledRanks;
+    std::uint64_t samples;
+    std::uint64_t size;
+};
+
+} // namespace
+
+/**
+ * @brief Fixed-size header at the start of every index image, in native byte order.
+ */
+struct FmIndex::Header {
+    char magic[8];
+    std::uint32_t version;
+    std::uint32_t saSampleRate;
+    std::uint32_t occSampleRate;
+    std::uint32_t sigma;
+    std::uint64_t textLength;
+    // BWT row whose suffix is the whole text; its BWT byte stands for the sentinel
+    std::uint64_t sentinelRow;
+    std::uint64_t sampleCount;
+    std::uint64_t bwtOffset;
+    std::uint64_t checkpointOffset;
+    std::uint64_t sampledBitsOffset;
+    std::uint64_t sampledRanksOffset;
+    std::uint64_t samplesOffset;
+    std::uint64_t imageSize;
+    // rows whose suffix starts with a byte smaller than c, the sentinel row included
+    std::uint64_t smaller[257];
+    // dense symbol of every byte that occurs in the text, indexes a checkpoint
+    std::uint8_t symbol[256];
+};
+
+namespace {
+
+Layout layoutOf(std::uint64_t textLength, std::uint32_t sigma, std::uint32_t saSampleRate,
+                std::uint32_t occSampleRate, std::uint64_t headerSize) {
+    std::uint64_t rows = textLength + 1;
+    std::uint64_t words = (rows + 63) / 64;
+    std::uint64_t sampleCount = textLength / saSampleRate + 1;
+
+    Layout layout;
+    layout.bwt = align8(headerSize);
+    layout.checkpoints = align8(layout.bwt + rows);
+    layout.sampledBits = align8(layout.checkpoints + (rows / occSampleRate + 1) * sigma * sizeof(std::uint32_t));
+    layout.sampledRanks = layout.sampledBits + words * sizeof(std::uint64_t);
+    layout.samples = align8(layout.sampledRanks + words * sizeof(std::uint32_t));
+    layout.size = align8(layout.samples + sampleCount * sizeof(std::uint32_t));
+    return layout;
+}
+
+} // namespace
+
+FmIndex::FmIndex()
+: m_size(0), m_header(nullptr), m_bwt(nullptr), m_checkpoints(nullptr), m_sampledBits(nullptr),
+  m_sampledRanks(nullptr), m_samples(nullptr) {}
+
+FmIndex::FmIndex(FmIndex&&) noexcept = default;
+FmIndex& FmIndex::operator=(FmIndex&&) noexcept = default;
+FmIndex::~FmIndex() = default;
+
+/**
+ * @brief Builds the index of `text`.
+ *
+ * After SA-IS, every pass over the suffix array is split into chunks of rows on
+ * ThreadPool::Get(): the BWT and the sample bitvector in one pass, then the samples,
+ * then the rank checkpoints, which each chunk counts locally before the chunk totals
+ * are scanned and added back.
+ *
+ * @param text     The corpus, at most INT32_MAX - 1 bytes.
+ * @param options  Sampling rates.
+ *
+ * @throws std::invalid_argument if the text is too long or a sampling rate is 0.
+ */
+FmIndex FmIndex::build(std::string_view text, const FmIndexOptions& options) {
+    PROFILE_FUNCTION();
+    if (text.size() >= static_cast<std::size_t>(INT32_MAX)) {
+        throw std::invalid_argument("Text is too long for a 32-bit FM-index.");
+    }
+    if (options.saSampleRate == 0 || options.occSampleRate == 0) {
+        throw std::invalid_argument("Sampling rates must be positive.");
+    }
+
+    ThreadPool& pool = ThreadPool::Get();
+    const auto* bytes = reinterpret_cast<const unsigned char*>(text.data());
+    const std::uint64_t n = text.size();
+    const std::uint64_t rows = n + 1;
+    const std::size_t chunks = (rows + buildChunkRows - 1) / buildChunkRows;
+
+    Header header {};
+    std::memcpy(header.magic, indexMagic, sizeof(indexMagic));
+    header.version = indexVersion;
+    header.saSampleRate = options.saSampleRate;
+    header.occSampleRate = options.occSampleRate;
+    header.textLength = n;
+
+    // byte histogram, then the dense alphabet and the bucket starts
+    std::vector<std::array<std::uint64_t, 256>> histograms(chunks);
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        auto& histogram = histograms[chunk];
+        histogram.fill(0);
+        std::uint64_t end = std::min<std::uint64_t>((chunk + 1) * buildChunkRows, n);
+        for (std::uint64_t i = chunk * buildChunkRows; i < end; i++) {
+            histogram[bytes[i]]++;
+        }
+    });
+    header.smaller[0] = 1;
+    for (int c = 0; c < 256; c++) {
+        std::uint64_t total = 0;
+        for (const auto& histogram: histograms) {
+            total += histogram[c];
+        }
+        if (total > 0) {
+            header.symbol[c] = header.sigma++;
+        }
+        header.smaller[c + 1] = header.smaller[c] + total;
+    }
+
+    Timer saTimer("Suffix Array");
+    std::vector<std::int32_t> sa = suffixArray(bytes, static_cast<std::int32_t>(n), 255);
+    saTimer.stop();
+
+    Layout layout = layoutOf(n, header.sigma, options.saSampleRate, options.occSampleRate, sizeof(Header));
+    header.sampleCount = n / options.saSampleRate + 1;
+    header.bwtOffset = layout.bwt;
+    header.checkpointOffset = layout.checkpoints;
+    header.sampledBitsOffset = layout.sampledBits;
+    header.sampledRanksOffset = layout.sampledRanks;
+    header.samplesOffset = layout.samples;
+    header.imageSize = layout.size;
+
+    FmIndex index;
+    index.m_image.assign(layout.size / sizeof(std::uint64_t), 0);
+    auto* image = reinterpret_cast<unsigned char*>(index.m_image.data());
+    auto* bwt = image + layout.bwt;
+    auto* checkpoints = reinterpret_cast<std::uint32_t*>(image + layout.checkpoints);
+    auto* sampledBits = reinterpret_cast<std::uint64_t*>(image + layout.sampledBits);
+    auto* sampledRanks = reinterpret_cast<std::uint32_t*>(image + layout.sampledRanks);
+    auto* samples = reinterpret_cast<std::uint32_t*>(image + layout.samples);
+
+    // row 0 holds the empty suffix, row r > 0 the suffix at sa[r - 1]
+    auto suffixAt = [&](std::uint64_t row) -> std::uint64_t {
+        return row == 0 ? n : sa[row - 1];
+    };
+
+    Timer bwtTimer("BWT");
+    std::uint64_t sentinelRow = 0;
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::uint64_t end = std::min<std::uint64_t>((chunk + 1) * buildChunkRows, rows);
+        for (std::uint64_t row = chunk * buildChunkRows; row < end; row++) {
+            std::uint64_t suffix = suffixAt(row);
+            if (suffix == 0) {
+                sentinelRow = row;
+            } else {
+                bwt[row] = bytes[suffix - 1];
+            }
+            if (suffix % options.saSampleRate == 0) {
+                sampledBits[row / 64] |= std::uint64_t(1) << (row % 64);
+            }
+        }
+    });
+    header.sentinelRow = sentinelRow;
+    bwtTimer.stop();
+
+    Timer samplesTimer("Samples");
+    std::uint64_t words = (rows + 63) / 64;
+    std::uint32_t sampled = 0;
+    for (std::uint64_t w = 0; w < words; w++) {
+        sampledRanks[w] = sampled;
+        sampled += std::popcount(sampledBits[w]);
+    }
+    pool.parallelFor(chunks, [&](std::size_t chunk) {
+        std::uint64_t begin = chunk * buildChunkRows;
+        std::uint64_t end = std::min<std::uint64_t>(begin + buildChunkRows, rows);
+        std::uint32_t next = sampledRanks[begin / 64];
+        for (std::uint64_t row = begin; row < end; row++) {
+            if (sampledBits[row / 64] >> (row % 64) & 1) {
+                samples[next++] = suffixAt(row);
+            }
+        }
+    });
+    samplesTimer.stop();
+
+    // the suffix array is not needed anymore, release it before counting
+    sa = std::vector<std::int32_t>();
+
+    Timer checkpointTimer("Checkpoints");
+    // group g fills checkpoints [g * perGroup, (g + 1) * perGroup) with counts relative
+    // to its first row; the group totals are then scanned and added back
+    const std::uint32_t sigma = header.sigma;
+    const std::uint64_t occ = options.occSampleRate;
+    const std::uint64_t lastCheckpoint = rows / occ;
+    const std::uint64_t perGroup = std::max<std::uint64_t>(1, buildChunkRows / occ);
+    const std::size_t groups = lastCheckpoint / perGroup + 1;
+    std::vector<std::uint32_t> groupTotals(groups * sigma);
+    pool.parallelFor(groups, [&](std::size_t group) {
+        std::uint32_t* counts = groupTotals.data() + group * sigma;
+        std::uint64_t firstCheckpoint = group * perGroup;
+        std::uint64_t endCheckpoint = std::min(firstCheckpoint + perGroup, lastCheckpoint + 1);
+        for (std::uint64_t k = firstCheckpoint; k < endCheckpoint; k++) {
+            std::copy(counts, counts + sigma, checkpoints + k * sigma);
+            std::uint64_t end = std::min(k * occ + occ, rows);
+            for (std::uint64_t row = k * occ; row < end; row++) {
+                if (row != sentinelRow) {
+                    counts[header.symbol[bwt[row]]]++;
+                }
+            }
+        }
+    });
+    std::vector<std::uint32_t> offset(sigma, 0);
+    for (std::size_t group = 0; group < groups; group++) {
+        std::uint32_t* counts = groupTotals.data() + group * sigma;
+        for (std::uint32_t c = 0; c < sigma; c++) {
+            std::swap(counts[c], offset[c]);
+            offset[c] += counts[c];
+        }
+    }
+    pool.parallelFor(groups, [&](std::size_t group) {
+        const std::uint32_t* base = groupTotals.data() + group * sigma;
+        std::uint64_t firstCheckpoint = group * perGroup;
+        std::uint64_t endCheckpoint = std::min(firstCheckpoint + perGroup, lastCheckpoint + 1);
+        for (std::uint64_t k = firstCheckpoint; k < endCheckpoint; k++) {
+            for (std::uint32_t c = 0; c < sigma; c++) {
+                checkpoints[k * sigma + c] += base[c];
+            }
+        }
+    });
+    checkpointTimer.stop();
+
+    std::memcpy(image, &header, sizeof(Header));
+    index.attach(image, layout.size);
+    return index;
+}
+
+/**
+ * @brief Memory-maps an index written by save().
+ *
+ * @param fileName The index file.
+ *
+ * @throws std::runtime_error if the file cannot be mapped or is not a valid index.
+ */
+FmIndex FmIndex::load(const std::string& fileName) {
+    PROFILE_FUNCTION();
+    FmIndex index;
+    index.m_file = std::make_unique<MappedFile>(fileName, MappedFile::Access::Random);
+    index.attach(reinterpret_cast<const unsigned char*>(index.m_file->data()), index.m_file->size());
+    return index;
+}
+
+/**
+ * @brief Writes the index image to `fileName`.
+ *
+ * @throws std::runtime_error if the file cannot be written.
+ */
+void FmIndex::save(const std::string& fileName) const {
+    PROFILE_FUNCTION();
+    std::ofstream out(fileName, std::ios::binary);
+    if (!out) {
+        throw std::runtime_error("Failed to open file: " + fileName);
+    }
+    out.write(reinterpret_cast<const char*>(m_header), static_cast<std::streamsize>(m_size));
+    out.close();
+    if (!out) {
+        throw std::runtime_error("Failed to write file: " + fileName);
+    }
+}
+
+/**
+ * @brief Points the section pointers into the image at `data` after validating its header.
+ *
+ * @throws std::runtime_error if the image is truncated or was not written by this version.
+ */
+void FmIndex::attach(const unsigned char* data, std::size_t size) {
+    if (size < sizeof(Header)) {
+        throw std::runtime_error("Invalid FM-index: truncated header.");
+    }
+    const auto* header = reinterpret_cast<const Header*>(data);
+    if (std::memcmp(header->magic, indexMagic, sizeof(indexMagic)) != 0 || header->version != indexVersion) {
+        throw std::runtime_error("Invalid FM-index: unknown format or version.");
+    }
+    if (header->saSampleRate == 0 || header->occSampleRate == 0 || header->sigma > 256 ||
+        header->textLength >= static_cast<std::uint64_t>(INT32_MAX)) {
+        throw std::runtime_error("Invalid FM-index: corrupt header.");
+    }
+    Layout layout = layoutOf(header->textLength, header->sigma, header->saSampleRate, header->occSampleRate, sizeof(Header));
+    if (layout.size != size || header->imageSize != size || header->bwtOffset != layout.bwt ||
+        header->checkpointOffset != layout.checkpoints || header->sampledBitsOffset != layout.sampledBits ||
+        header->sampledRanksOffset != layout.sampledRanks || header->samplesOffset != layout.samples) {
+        throw std::runtime_error("Invalid FM-index: section layout does not match the file size.");
+    }
+
+    m_size = size;
+    m_options.saSampleRate = header->saSampleRate;
+    m_options.occSampleRate = header->occSampleRate;
+    m_header = header;
+    m_bwt = data + layout.bwt;
+    m_checkpoints = reinterpret_cast<const std::uint32_t*>(data + layout.checkpoints);
+    m_sampledBits = reinterpret_cast<const std::uint64_t*>(data + layout.sampledBits);
+    m_sampledRanks = reinterpret_cast<const std::uint32_t*>(data + layout.sampledRanks);
+    m_samples = reinterpret_cast<const std::uint32_t*>(data + layout.samples);
+}
+
+/**
+ * @brief Returns the length of the indexed text in bytes.
+ */
+std::uint64_t FmIndex::textLength() const {
+    return m_header->textLength;
+}
+
+/**
+ * @brief Returns the number of occurrences of `c` in BWT rows [0, row).
+ *
+ * Starts from whichever checkpoint is closer, so at most occSampleRate / 2 BWT bytes
+ * are scanned. The sentinel row holds a placeholder byte that is not counted.
+ */
+std::uint64_t FmIndex::rank(unsigned char c, std::uint64_t row) const {
+    const std::uint64_t occ = m_header->occSampleRate;
+    const std::uint64_t rows = m_header->textLength + 1;
+    const std::uint64_t sentinel = m_header->sentinelRow;
+    const std::uint32_t symbol = m_header->symbol[c];
+
+    std::uint64_t k = row / occ;
+    std::uint64_t from = k * occ;
+    std::uint64_t to = from + occ;
+    if (row - from <= occ / 2 || to > rows) {
+        std::uint64_t count = m_checkpoints[k * m_header->sigma + symbol];
+        for (std::uint64_t i = from; i < row; i++) {
+            count += m_bwt[i] == c;
+        }
+        return count - (sentinel >= from && sentinel < row && m_bwt[sentinel] == c);
+    }
+
+    std::uint64_t count = m_checkpoints[(k + 1) * m_header->sigma + symbol];
+    for (std::uint64_t i = row; i < to; i++) {
+        count -= m_bwt[i] == c;
+    }
+    return count + (sentinel >= row && sentinel < to && m_bwt[sentinel] == c);
+}
+
+/**
+ * @brief Runs backward search and returns the half-open range of BWT rows prefixed by `pattern`.
+ */
+std::pair<std::uint64_t, std::uint64_t> FmIndex::rowRange(std::string_view pattern) const {
+    std::uint64_t first = 0;
+    std::uint64_t last = m_header->textLength + 1;
+    if (pattern.empty()) {
+        return {0, 0};
+    }
+    for (auto it = pattern.rbegin(); it != pattern.rend() && first < last; ++it) {
+        unsigned char c = *it;
+        if (m_header->smaller[c + 1] == m_header->smaller[c]) {
+            return {0, 0};
+        }
+        first = m_header->smaller[c] + rank(c, first);
+        last = m_header->smaller[c] + rank(c, last);
+    }
+    return {first, std::max(first, last)};
+}
+
+/**
+ * @brief Returns the text position of the suffix in `row`.
+ *
+ * Applies LF, which moves to the row of the suffix one position to the left, until
+ * a sampled row is reached; the sampled position plus the number of steps is the
+ * answer.
+ */
+std::uint64_t FmIndex::position(std::uint64_t row) const {
+    std::uint64_t steps = 0;
+    while (!(m_sampledBits[row / 64] >> (row % 64) & 1)) {
+        unsigned char c = m_bwt[row];
+        row = m_header->smaller[c] + rank(c, row);
+        steps++;
+    }
+    std::uint64_t below = m_sampledBits[row / 64] & ((std::uint64_t(1) << (row % 64)) - 1);
+    return m_samples[m_sampledRanks[row / 64] + std::popcount(below)] + steps;
+}
+
+/**
+ * @brief Counts the occurrences of `pattern`, overlapping ones included.
+ *
+ * @param pattern The pattern to count; an empty pattern has no occurrences.
+ *
+ * @return The number of occurrences.
+ */
+std::uint64_t FmIndex::count(std::string_view pattern) const {
+    auto [first, last] = rowRange(pattern);
+    return last - first;
+}
+
+/**
+ * @brief Finds all occurrences of `pattern`.
+ *
+ * @param pattern The pattern to search for; an empty pattern has no occurrences.
+ *
+ * @return The starting indices of all occurrences in ascending order, like standardFindAll.
+ */
+std::vector<int> FmIndex::locate(std::string_view pattern) const {
+    PROFILE_FUNCTION();
+    auto [first, last] = rowRange(pattern);
+    std::vector<int> results(last - first);
+
+    auto resolve = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) {
+            results[i] = static_cast<int>(position(first + i));
+        }
+    };
+    if (results.size() > locateChunk) {
+        std::size_t tasks = (results.size() + locateChunk - 1) / locateChunk;
+        ThreadPool::Get().parallelFor(tasks, [&](std::size_t task) {
+            resolve(task * locateChunk, std::min((task + 1) * locateChunk, results.size()));
+        });
+    } else {
+        resolve(0, results.size());
+    }
+
+    // rows are in suffix order, not text order
+    std::sort(results.begin(), results.end());
+    return results;
+}
@@ -0,0 +1,156 @@
+#ifndef FM_INDEX_HPP
+#define FM_INDEX_HPP
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+class MappedFile;
+
+/**
+ * @brief Space/time trade-offs of an FmIndex.
+ */
+struct FmIndexOptions {
+    // every saSampleRate-th text position keeps its suffix array entry; locate walks at
+    // most saSampleRate - 1 LF steps per occurrence and the samples take 4 / saSampleRate
+    // bytes per text byte
+    unsigned int saSampleRate = 32;
+    // symbol counts are checkpointed every occSampleRate BWT rows; a rank query scans at
+    // most occSampleRate / 2 bytes and the checkpoints take 4 * alphabet / occSampleRate
+    // bytes per text byte
+    unsigned int occSampleRate = 128;
+};
+
+/**
+ * @brief FM-index over a static byte corpus, answering count and locate queries
+ * without rescanning the text.
+ *
+ * The suffix array is built with SA-IS, turned into the Burrows-Wheeler transform,
+ * and then reduced to what queries need: the BWT, rank checkpoints over the symbols
+ * that occur in the text, and suffix array samples at every saSampleRate-th text
+ * position with a rank bitvector marking their rows. The suffix array itself is
+ * dropped after the build.
+ *
+ * All of that lives in a single flat image with a fixed header, so save() writes it
+ * as is and load() memory-maps it back without parsing or copying; the OS pages in
+ * only the parts queries touch.
+ *
+ * count() runs backward search, two rank queries per pattern byte, so it takes
+ * O(m) rank queries independent of the corpus size. locate() additionally walks each
+ * occurrence back to the nearest sample.
+ */
+class FmIndex {
+public:
+    /**
+     * @brief Builds the index of `text`.
+     *
+     * SA-IS runs on the calling thread; deriving the BWT, the checkpoints and the
+     * samples from the suffix array runs in parallel on ThreadPool::Get(). Peak memory
+     * is about 9 bytes per text byte for the suffix array construction.
+     *
+     * @param text     The corpus, at most INT32_MAX - 1 bytes.
+     * @param options  Sampling rates.
+     *
+     * @throws std::invalid_argument if the text is too long or a sampling rate is 0.
+     */
+    static FmIndex build(std::string_view text, const FmIndexOptions& options = {});
+
+    /**
+     * @brief Memory-maps an index written by save().
+     *
+     * @param fileName The index file.
+     *
+     * @throws std::runtime_error if the file cannot be mapped or is not a valid index.
+     */
+    static FmIndex load(const std::string& fileName);
+
+    /**
+     * @brief Writes the index image to `fileName`.
+     *
+     * @throws std::runtime_error if the file cannot be written.
+     */
+    void save(const std::string& fileName) const;
+
+    /**
+     * @brief Counts the occurrences of `pattern`, overlapping ones included.
+     *
+     * @param pattern The pattern to count; an empty pattern has no occurrences.
+     *
+     * @return The number of occurrences.
+     */
+    std::uint64_t count(std::string_view pattern) const;
+
+    /**
+     * @brief Finds all occurrences of `pattern`.
+     *
+     * Large result sets are resolved in parallel on ThreadPool::Get().
+     *
+     * @param pattern The pattern to search for; an empty pattern has no occurrences.
+     *
+     * @return The starting indices of all occurrences in ascending order, like standardFindAll.
+     */
+    std::vector<int> locate(std::string_view pattern) const;
+
+    /**
+     * @brief Returns the length of the indexed text in bytes.
+     */
+    std::uint64_t textLength() const;
+
+    /**
+     * @brief Returns the size of the index image in bytes, i.e. its memory and file footprint.
+     */
+    std::size_t sizeBytes() const { return m_size; }
+
+    const FmIndexOptions& options() const { return m_options; }
+
+    FmIndex(FmIndex&&) noexcept;
+    FmIndex& operator=(FmIndex&&) noexcept;
+    ~FmIndex();
+
+private:
+    struct Header;
+
+    FmIndex();
+
+    /**
+     * @brief Points the section pointers into the image at `data` after validating its header.
+     *
+     * @throws std::runtime_error if the image is truncated or was not written by this version.
+     */
+    void attach(const unsigned char* data, std::size_t size);
+
+    /**
+     * @brief Runs backward search and returns the half-open range of BWT rows prefixed by `pattern`.
+     */
+    std::pair<std::uint64_t, std::uint64_t> rowRange(std::string_view pattern) const;
+
+    /**
+     * @brief Returns the number of occurrences of `c` in BWT rows [0, row).
+     */
+    std::uint64_t rank(unsigned char c, std::uint64_t row) const;
+
+    /**
+     * @brief Returns the text position of the suffix in `row`.
+     */
+    std::uint64_t position(std::uint64_t row) const;
+
+private:
+    // owned image of a freshly built index
+    std::vector<std::uint64_t> m_image;
+    // mapped image of a loaded index
+    std::unique_ptr<MappedFile> m_file;
+    std::size_t m_size;
+
+    FmIndexOptions m_options;
+    const Header* m_header;
+    const unsigned char* m_bwt;
+    const std::uint32_t* m_checkpoints;
+    const std::uint64_t* m_sampledBits;
+    const std::uint32_t* m_sampledRanks;
+    const std::uint32_t* m_samples;
+};
+
+#endif // FM_INDEX_HPP
@@ -0,0 +1,106 @@
+#include "hybridSearch.hpp"
+#include "cl.hpp"
+#include "parallelFunctions.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Constructs a searcher that starts from an even split.
+ *
+ * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+ *
+ * @throws std::invalid_argument if `smoothing` is outside (0, 1].
+ */
+HybridSearcher::HybridSearcher(double smoothing)
+: m_balancer(2, smoothing, minShare) {
+    if (!(smoothing > 0 && smoothing <= 1)) {
+        throw std::invalid_argument("Hybrid smoothing must be in (0, 1].");
+    }
+}
+
+/**
+ * @brief Returns the process-wide searcher, creating it on first use.
+ */
+HybridSearcher& HybridSearcher::Get() {
+    static HybridSearcher searcher;
+    return searcher;
+}
+
+/**
+ * @brief Finds all occurrences of a substring on the device and the CPU together.
+ *
+ * The device side runs on its own thread, because its call blocks until the results
+ * are read back; the calling thread runs the CPU side on the pool meanwhile. Each
+ * side is timed on its own thread, from its start to its last result.
+ *
+ * @param str The input text to search in.
+ * @param substr The pattern to search for.
+ *
+ * @return The ascending indices of all occurrences of the substring.
+ *
+ * @throws cl::Error if an OpenCL call fails.
+ */
+std::vector<int> HybridSearcher::findAll(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    if (substr.empty() || substr.length() > str.length()) {
+        return {};
+    }
+
+    using Clock = std::chrono::steady_clock;
+    std::size_t positions = str.length() - substr.length() + 1;
+    // the device searches start positions [0, split), the CPU [split, positions)
+    std::size_t split = static_cast<std::size_t>(positions * gpuShare());
+
+    double gpuSeconds = 0;
+    auto gpuSide = std::async(std::launch::async, [&]() {
+        PROFILE_SCOPE("Hybrid GPU Side");
+        auto start = Clock::now();
+        std::vector<int> occurrences;
+        if (split > 0) {
+            occurrences = ClSearchEngine::Get().findAll(str.substr(0, split + substr.length() - 1), substr);
+        }
+        gpuSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+        return occurrences;
+    });
+
+    double cpuSeconds = 0;
+    std::vector<int> cpuOccurrences;
+    {
+        PROFILE_SCOPE("Hybrid CPU Side");
+        auto start = Clock::now();
+        if (split < positions) {
+            cpuOccurrences = parallelFindAll(str.substr(split), substr);
+        }
+        cpuSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    std::vector<int> occurrences = gpuSide.get();
+    occurrences.reserve(occurrences.size() + cpuOccurrences.size());
+    for (int position: cpuOccurrences) {
+        occurrences.push_back(split + position);
+    }
+
+    PROFILE_CUSTOM_TIME("Hybrid GPU", gpuSeconds * 1e6f);
+    PROFILE_CUSTOM_TIME("Hybrid CPU", cpuSeconds * 1e6f);
+
+    m_balancer.update({split, positions - split}, {gpuSeconds, cpuSeconds});
+
+    return occurrences;
+}
+
+/*
+ * heterogeneous search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> hybridFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return HybridSearcher::Get().findAll(str, subStr);
+}
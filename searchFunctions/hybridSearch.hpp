@@ -0,0 +1,72 @@
+#ifndef HYBRID_SEARCH_HPP
+#define HYBRID_SEARCH_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+#include "throughputBalancer.hpp"
+
+/**
+ * @brief Splits one find-all between the OpenCL device and the CPU thread pool.
+ *
+ * The start positions are cut in two: the front goes to ClSearchEngine::Get(), the
+ * rest to parallelFindAll() on ThreadPool::Get(), and both run at the same time. The
+ * device's range is uploaded with `substr.length() - 1` bytes past the cut, so a match
+ * straddling the cut belongs to the device side and is reported exactly once.
+ *
+ * A ThroughputBalancer moves the cut after every call, so both sides finish together.
+ * Each side's time is reported to the profiler as "Hybrid GPU" and "Hybrid CPU".
+ */
+class HybridSearcher {
+public:
+    /**
+     * @brief Constructs a searcher that starts from an even split.
+     *
+     * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+     *
+     * @throws std::invalid_argument if `smoothing` is outside (0, 1].
+     */
+    explicit HybridSearcher(double smoothing = 0.5);
+
+    /**
+     * @brief Returns the process-wide searcher, creating it on first use.
+     */
+    static HybridSearcher& Get();
+
+    /**
+     * @brief Finds all occurrences of a substring on the device and the CPU together.
+     *
+     * @param str The input text to search in.
+     * @param substr The pattern to search for.
+     *
+     * @return The ascending indices of all occurrences of the substring.
+     *
+     * @throws cl::Error if an OpenCL call fails.
+     */
+    std::vector<int> findAll(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Returns the fraction of start positions the next call gives to the device.
+     */
+    double gpuShare() const { return m_balancer.shares()[0]; }
+
+    // the share never leaves [minShare, 1 - minShare], so both sides keep being measured
+    static constexpr double minShare = 0.01;
+
+private:
+    // worker 0 is the device, worker 1 the CPU
+    ThroughputBalancer m_balancer;
+};
+
+/*
+ * heterogeneous search that returns the index of every occurrence of the substring in the string
+ *
+ * Thin wrapper around HybridSearcher::Get().findAll(), so the split adapts across calls.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> hybridFindAll(std::string_view str, std::string_view subStr);
+
+#endif // HYBRID_SEARCH_HPP
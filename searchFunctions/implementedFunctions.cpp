@@ -8,14 +8,14 @@
  * @param str : the string to search in
  * @param subStr : the substring to search for
  *
- * @return the index of the first occurrence of the substring in the string
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
  */
-int stringSearch(const std::string &str, const std::string &subStr) {
+int stringSearch(std::string_view str, std::string_view subStr) {
     PROFILE_FUNCTION();
 
     int strLen = str.length();
     int subStrLen = subStr.length();
-    for (int i = 0; i < strLen - subStrLen; i++) {
+    for (int i = 0; i <= strLen - subStrLen; i++) {
         int j = 0;
         while (j < subStrLen && str[i + j] == subStr[j]) {
             j++;
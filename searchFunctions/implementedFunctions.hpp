@@ -1,4 +1,5 @@
 #include <string>
+#include <string_view>
 
 /*
  * string search function that returns the index of the first occurrence of the substring in the string
@@ -8,4 +9,4 @@
  *
  * @return the index of the first occurrence of the substring in the string
  */
-int stringSearch(const std::string &str, const std::string &subStr);
+int stringSearch(std::string_view str, std::string_view subStr);
@@ -0,0 +1,181 @@
+#include "multiPattern.hpp"
+#include "simdFunctions.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Orders matches by offset, then pattern id.
+ */
+bool operator<(const PatternMatch& lhs, const PatternMatch& rhs) {
+    if (lhs.offset != rhs.offset) {
+        return lhs.offset < rhs.offset;
+    }
+    return lhs.patternId < rhs.patternId;
+}
+
+/**
+ * @brief Builds the automaton.
+ *
+ * Inserts every pattern into the trie, then completes it breadth-first: a missing
+ * transition of state s copies the transition of s's failure state, and every state
+ * inherits the outputs of its failure state.
+ *
+ * @param patterns The needles; a pattern's index is its id in every match.
+ *
+ * @throws std::invalid_argument if `patterns` is empty or contains an empty pattern.
+ */
+AhoCorasick::AhoCorasick(const std::vector<std::string>& patterns)
+: m_stateCount(1), m_classCount(1), m_maxPatternLength(0), m_byteClass{} {
+    if (patterns.empty()) {
+        throw std::invalid_argument("Pattern set cannot be empty.");
+    }
+
+    // byte classes in order of first appearance, class 0 for bytes no pattern uses
+    for (const auto& pattern: patterns) {
+        if (pattern.empty()) {
+            throw std::invalid_argument("Patterns cannot be empty.");
+        }
+        for (unsigned char c: pattern) {
+            if (m_byteClass[c] == 0) {
+                m_byteClass[c] = m_classCount++;
+            }
+        }
+        m_patternLengths.push_back(pattern.length());
+        m_maxPatternLength = std::max<int>(m_maxPatternLength, pattern.length());
+    }
+
+    // trie
+    std::vector<std::vector<std::int32_t>> exact(1);
+    m_trie.assign(m_classCount, -1);
+    for (std::size_t id = 0; id < patterns.size(); id++) {
+        int state = 0;
+        for (unsigned char c: patterns[id]) {
+            std::size_t edge = state * m_classCount + m_byteClass[c];
+            if (m_trie[edge] < 0) {
+                m_trie[edge] = m_stateCount++;
+                m_trie.resize(m_stateCount * m_classCount, -1);
+                exact.emplace_back();
+            }
+            state = m_trie[edge];
+        }
+        exact[state].push_back(id);
+    }
+
+    // failure links and the completed transition table, breadth-first
+    m_transitions = m_trie;
+    std::vector<std::int32_t> failure(m_stateCount, 0);
+    std::vector<std::vector<std::int32_t>> outputs = exact;
+    std::vector<std::int32_t> queue;
+    queue.reserve(m_stateCount);
+
+    for (int c = 0; c < m_classCount; c++) {
+        std::int32_t& next = m_transitions[c];
+        if (next < 0) {
+            next = 0;
+        } else {
+            queue.push_back(next);
+        }
+    }
+
+    for (std::size_t head = 0; head < queue.size(); head++) {
+        int state = queue[head];
+        // the failure state is shallower, so its outputs are already complete
+        const auto& inherited = outputs[failure[state]];
+        outputs[state].insert(outputs[state].end(), inherited.begin(), inherited.end());
+
+        for (int c = 0; c < m_classCount; c++) {
+            std::int32_t& next = m_transitions[state * m_classCount + c];
+            std::int32_t fallback = m_transitions[failure[state] * m_classCount + c];
+            if (next < 0) {
+                next = fallback;
+            } else {
+                failure[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+
+    // flatten the per-state id lists
+    auto flatten = [this](std::vector<std::vector<std::int32_t>>& lists,
+                          std::vector<std::int32_t>& start, std::vector<std::int32_t>& ids) {
+        start.assign(1, 0);
+        for (auto& list: lists) {
+            std::sort(list.begin(), list.end());
+            ids.insert(ids.end(), list.begin(), list.end());
+            start.push_back(ids.size());
+        }
+    };
+    flatten(outputs, m_outputStart, m_outputIds);
+    flatten(exact, m_exactStart, m_exactIds);
+}
+
+/**
+ * @brief Finds every occurrence of every pattern in a single pass over `str`.
+ *
+ * @param str The text to search in.
+ *
+ * @return All matches, ordered by offset, then pattern id.
+ */
+std::vector<PatternMatch> AhoCorasick::findAll(std::string_view str) const {
+    std::vector<PatternMatch> matches;
+    const std::int32_t* transitions = m_transitions.data();
+    const std::uint16_t* byteClass = m_byteClass.data();
+
+    std::int32_t state = 0;
+    int length = str.length();
+    for (int i = 0; i < length; i++) {
+        state = transitions[state * m_classCount + byteClass[static_cast<unsigned char>(str[i])]];
+        for (std::int32_t o = m_outputStart[state]; o < m_outputStart[state + 1]; o++) {
+            std::int32_t id = m_outputIds[o];
+            matches.push_back({id, i - m_patternLengths[id] + 1});
+        }
+    }
+
+    // matches were produced by end position
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
+
+/*
+ * multi-pattern search that returns every (pattern id, offset) pair in one pass over the string
+ *
+ * @param str : the string to search in
+ * @param patterns : the substrings to search for
+ *
+ * @return all matches ordered by offset, then pattern id
+ */
+std::vector<PatternMatch> ahoCorasickFindAll(std::string_view str, const std::vector<std::string> &patterns) {
+    PROFILE_FUNCTION();
+
+    Timer buildTimer("Build Automaton");
+    AhoCorasick automaton(patterns);
+    buildTimer.stop();
+
+    return automaton.findAll(str);
+}
+
+/*
+ * multi-pattern baseline that rescans the string once per pattern with simdFindAll
+ *
+ * @param str : the string to search in
+ * @param patterns : the substrings to search for
+ *
+ * @return all matches ordered by offset, then pattern id
+ */
+std::vector<PatternMatch> repeatedFindAll(std::string_view str, const std::vector<std::string> &patterns) {
+    PROFILE_FUNCTION();
+    std::vector<PatternMatch> matches;
+    std::vector<int> occurrences;
+    for (std::size_t id = 0; id < patterns.size(); id++) {
+        occurrences.clear();
+        simdFindRange(str, patterns[id], 0, str.length(), false, occurrences);
+        for (int offset: occurrences) {
+            matches.push_back({static_cast<int>(id), offset});
+        }
+    }
+    std::sort(matches.begin(), matches.end());
+    return matches;
+}
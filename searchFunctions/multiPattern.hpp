@@ -0,0 +1,111 @@
+#ifndef MULTI_PATTERN_HPP
+#define MULTI_PATTERN_HPP
+#include <array>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief One occurrence of one pattern of a multi-pattern search.
+ *
+ * Layout matches an OpenCL int2, so device results can be read back directly.
+ */
+struct PatternMatch {
+    int patternId;
+    int offset;
+
+    bool operator==(const PatternMatch&) const = default;
+};
+
+/**
+ * @brief Orders matches by offset, then pattern id. All multi-pattern backends return this order.
+ */
+bool operator<(const PatternMatch& lhs, const PatternMatch& rhs);
+
+/**
+ * @brief Cache-compact Aho-Corasick automaton over a set of patterns.
+ *
+ * Bytes are first mapped to classes: every byte that occurs in some pattern gets its
+ * own class, all other bytes share class 0. Transitions are then stored as one flat
+ * table of `stateCount() * classCount()` ints, which for typical needle sets is small
+ * enough to stay in cache while the text is streamed through it.
+ *
+ * Besides the full automaton (failure links folded into the table) the plain trie is
+ * kept in the same flat layout. The OpenCL backend walks the trie from every start
+ * position independently (the failure-less "PFAC" formulation), which needs no
+ * sequential state and so parallelizes over offsets.
+ */
+class AhoCorasick {
+public:
+    /**
+     * @brief Builds the automaton.
+     *
+     * @param patterns The needles; a pattern's index is its id in every match.
+     *
+     * @throws std::invalid_argument if `patterns` is empty or contains an empty pattern.
+     */
+    explicit AhoCorasick(const std::vector<std::string>& patterns);
+
+    /**
+     * @brief Finds every occurrence of every pattern in a single pass over `str`.
+     *
+     * @param str The text to search in.
+     *
+     * @return All matches, ordered by offset, then pattern id.
+     */
+    std::vector<PatternMatch> findAll(std::string_view str) const;
+
+    int stateCount() const { return m_stateCount; }
+    int classCount() const { return m_classCount; }
+    int patternCount() const { return m_patternLengths.size(); }
+    int maxPatternLength() const { return m_maxPatternLength; }
+
+    // byte -> class map, 256 entries
+    const std::array<std::uint16_t, 256>& byteClasses() const { return m_byteClass; }
+    // trie without failure links, state * classCount + class -> next state or -1
+    const std::vector<std::int32_t>& trie() const { return m_trie; }
+    // per state, [exactStart[s], exactStart[s + 1]) indexes the ids of patterns spelled by the path to s
+    const std::vector<std::int32_t>& exactStart() const { return m_exactStart; }
+    const std::vector<std::int32_t>& exactIds() const { return m_exactIds; }
+
+private:
+    int m_stateCount;
+    int m_classCount;
+    int m_maxPatternLength;
+    std::array<std::uint16_t, 256> m_byteClass;
+
+    std::vector<std::int32_t> m_transitions;
+    std::vector<std::int32_t> m_trie;
+
+    // patterns ending at a state including those reached through failure links
+    std::vector<std::int32_t> m_outputStart;
+    std::vector<std::int32_t> m_outputIds;
+
+    std::vector<std::int32_t> m_exactStart;
+    std::vector<std::int32_t> m_exactIds;
+
+    std::vector<int> m_patternLengths;
+};
+
+/*
+ * multi-pattern search that returns every (pattern id, offset) pair in one pass over the string
+ *
+ * @param str : the string to search in
+ * @param patterns : the substrings to search for
+ *
+ * @return all matches ordered by offset, then pattern id
+ */
+std::vector<PatternMatch> ahoCorasickFindAll(std::string_view str, const std::vector<std::string> &patterns);
+
+/*
+ * multi-pattern baseline that rescans the string once per pattern with simdFindAll
+ *
+ * @param str : the string to search in
+ * @param patterns : the substrings to search for
+ *
+ * @return all matches ordered by offset, then pattern id
+ */
+std::vector<PatternMatch> repeatedFindAll(std::string_view str, const std::vector<std::string> &patterns);
+
+#endif // MULTI_PATTERN_HPP
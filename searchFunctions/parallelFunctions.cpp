@@ -0,0 +1,63 @@
+#include "parallelFunctions.hpp"
+#include "simdFunctions.hpp"
+#include "threadPool.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+/*
+ * multi-threaded search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> parallelFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return parallelFindAllThreads(str, subStr, ThreadPool::Get().size());
+}
+
+/*
+ * multi-threaded search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param threadCount : number of ranges searched concurrently
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> parallelFindAllThreads(std::string_view str, std::string_view subStr, unsigned threadCount) {
+    std::string scopeName = "parallelFindAll x" + std::to_string(threadCount);
+    PROFILE_SCOPE(scopeName.c_str());
+
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return {};
+    }
+
+    std::size_t positions = str.length() - subStr.length() + 1;
+    std::size_t ranges = std::clamp<std::size_t>(threadCount, 1, positions);
+    std::size_t rangeSize = (positions + ranges - 1) / ranges;
+
+    // every range owns the matches that start inside it
+    std::vector<std::vector<int>> rangeResults(ranges);
+    ThreadPool::Get().parallelFor(ranges, [&](std::size_t range) {
+        std::size_t begin = range * rangeSize;
+        std::size_t end = std::min(begin + rangeSize, positions);
+        simdFindRange(str, subStr, begin, end, false, rangeResults[range]);
+    });
+
+    // each range copies into its own slice of the output, so no lock is needed
+    std::vector<std::size_t> offsets(ranges + 1, 0);
+    for (std::size_t range = 0; range < ranges; range++) {
+        offsets[range + 1] = offsets[range] + rangeResults[range].size();
+    }
+
+    std::vector<int> occurrences(offsets.back());
+    ThreadPool::Get().parallelFor(ranges, [&](std::size_t range) {
+        std::copy(rangeResults[range].begin(), rangeResults[range].end(), occurrences.begin() + offsets[range]);
+    });
+
+    return occurrences;
+}
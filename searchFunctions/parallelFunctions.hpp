@@ -0,0 +1,35 @@
+#ifndef PARALLEL_FUNCTIONS_HPP
+#define PARALLEL_FUNCTIONS_HPP
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * multi-threaded search that returns the index of every occurrence of the substring in the string
+ *
+ * Uses every thread of ThreadPool::Get().
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> parallelFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * multi-threaded search that returns the index of every occurrence of the substring in the string
+ *
+ * The start positions are split into `threadCount` contiguous ranges. Each range is
+ * searched on its own, reading up to subStr.length() - 1 bytes past its end, so a match
+ * straddling a range boundary is reported exactly once, by the range it starts in.
+ * Per-range results are merged into one ascending vector at precomputed offsets.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param threadCount : number of ranges searched concurrently, at most ThreadPool::Get().size() run at once
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> parallelFindAllThreads(std::string_view str, std::string_view subStr, unsigned threadCount);
+
+#endif // PARALLEL_FUNCTIONS_HPP
@@ -0,0 +1,99 @@
+#ifndef RESULT_SINK_HPP
+#define RESULT_SINK_HPP
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+ * Result sinks receive the occurrences of a search one at a time instead of a returned
+ * std::vector<int>. The *FindAllInto functions take the sink as a template parameter, so
+ * the call per occurrence is resolved and inlined at compile time. Offsets are 64-bit,
+ * so texts past 2 GiB are reported correctly.
+ */
+
+// offset of an occurrence from the start of the searched text
+using MatchOffset = std::uint64_t;
+
+/*
+ * a sink is called with every occurrence in ascending order and returns whether the
+ * search should go on; returning false stops it after the current occurrence
+ */
+template<typename Sink>
+concept ResultSink = requires(Sink& sink, MatchOffset offset) {
+    { sink(offset) } -> std::same_as<bool>;
+};
+
+/*
+ * appends every occurrence to a caller-owned buffer
+ *
+ * The buffer is not cleared, so a caller that clears it between searches keeps its
+ * capacity and stops allocating once it has grown to the largest result.
+ */
+class VectorSink {
+public:
+    explicit VectorSink(std::vector<MatchOffset>& buffer) : m_buffer(buffer) {}
+
+    bool operator()(MatchOffset offset) {
+        m_buffer.push_back(offset);
+        return true;
+    }
+
+    std::vector<MatchOffset>& buffer() { return m_buffer; }
+
+private:
+    std::vector<MatchOffset>& m_buffer;
+};
+
+/*
+ * counts the occurrences without storing them
+ */
+struct CountSink {
+    std::uint64_t count = 0;
+
+    bool operator()(MatchOffset) {
+        count++;
+        return true;
+    }
+};
+
+/*
+ * keeps the first occurrence and stops the search
+ */
+struct FirstSink {
+    bool found = false;
+    MatchOffset offset = 0;
+
+    bool operator()(MatchOffset occurrence) {
+        found = true;
+        offset = occurrence;
+        return false;
+    }
+};
+
+/*
+ * calls `callback` with every occurrence
+ *
+ * A callback returning bool decides whether the search goes on, any other callback
+ * sees every occurrence.
+ */
+template<typename Callback>
+class CallbackSink {
+public:
+    explicit CallbackSink(Callback callback) : m_callback(std::move(callback)) {}
+
+    bool operator()(MatchOffset offset) {
+        if constexpr (std::is_same_v<std::invoke_result_t<Callback&, MatchOffset>, bool>) {
+            return m_callback(offset);
+        } else {
+            m_callback(offset);
+            return true;
+        }
+    }
+
+private:
+    Callback m_callback;
+};
+
+#endif // RESULT_SINK_HPP
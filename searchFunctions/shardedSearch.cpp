@@ -0,0 +1,129 @@
+#include "shardedSearch.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Creates one engine per device and weighs the first cut by compute units times clock rate.
+ *
+ * @param devices The devices to shard across.
+ * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+ *
+ * @throws std::invalid_argument if `devices` is empty or `smoothing` is outside (0, 1].
+ * @throws cl::Error if an engine cannot be created.
+ */
+ShardedSearcher::ShardedSearcher(const std::vector<cl::Device>& devices, double smoothing)
+: m_balancer(devices.size(), smoothing, minShare / std::max<size_t>(devices.size(), 1)) {
+    if (devices.empty()) {
+        throw std::invalid_argument("Sharding needs at least one device.");
+    }
+    if (!(smoothing > 0 && smoothing <= 1)) {
+        throw std::invalid_argument("Shard smoothing must be in (0, 1].");
+    }
+
+    std::vector<double> weights;
+    for (const auto& device: devices) {
+        m_engines.push_back(std::make_unique<ClSearchEngine>(device));
+        double computeUnits = device.getInfo<CL_DEVICE_MAX_COMPUTE_UNITS>();
+        double clockMHz = device.getInfo<CL_DEVICE_MAX_CLOCK_FREQUENCY>();
+        weights.push_back(std::max(computeUnits, 1.0) * std::max(clockMHz, 1.0));
+    }
+    m_balancer.setShares(weights);
+}
+
+/**
+ * @brief Returns the process-wide searcher, creating it on first use.
+ *
+ * @throws std::runtime_error if no device matches the selection.
+ */
+ShardedSearcher& ShardedSearcher::Get() {
+    static ShardedSearcher searcher([]() {
+        std::vector<cl::Device> devices = findClDevices(clDeviceSelection().value_or(ClDeviceSelector{}));
+        if (devices.empty()) {
+            throw std::runtime_error("No OpenCL device matches the selection.");
+        }
+        return devices;
+    }());
+    return searcher;
+}
+
+/**
+ * @brief Finds all occurrences of a substring with every device searching one shard.
+ *
+ * Each shard runs on its own thread, because an engine's call blocks until its
+ * results are read back, and is timed there from its start to its last result.
+ *
+ * @param str The input text to search in.
+ * @param substr The pattern to search for.
+ *
+ * @return The ascending indices of all occurrences of the substring.
+ *
+ * @throws cl::Error if an OpenCL call fails.
+ */
+std::vector<int> ShardedSearcher::findAll(std::string_view str, std::string_view substr) {
+    PROFILE_FUNCTION();
+    if (substr.empty() || substr.length() > str.length()) {
+        return {};
+    }
+
+    using Clock = std::chrono::steady_clock;
+    size_t positions = str.length() - substr.length() + 1;
+    size_t devices = m_engines.size();
+
+    // device i searches start positions [cuts[i], cuts[i + 1])
+    std::vector<size_t> cuts(devices + 1, 0);
+    double cumulative = 0;
+    for (size_t i = 0; i + 1 < devices; i++) {
+        cumulative += shares()[i];
+        cuts[i + 1] = std::clamp(static_cast<size_t>(positions * cumulative), cuts[i], positions);
+    }
+    cuts[devices] = positions;
+
+    std::vector<double> seconds(devices, 0);
+    std::vector<std::future<std::vector<int>>> shards;
+    for (size_t i = 0; i < devices; i++) {
+        shards.push_back(std::async(std::launch::async, [&, i]() {
+            PROFILE_SCOPE("Shard");
+            auto start = Clock::now();
+            std::vector<int> occurrences;
+            if (cuts[i + 1] > cuts[i]) {
+                occurrences = m_engines[i]->findAll(str.substr(cuts[i], cuts[i + 1] - cuts[i] + substr.length() - 1), substr);
+            }
+            seconds[i] = std::chrono::duration<double>(Clock::now() - start).count();
+            return occurrences;
+        }));
+    }
+
+    std::vector<int> occurrences;
+    for (size_t i = 0; i < devices; i++) {
+        std::vector<int> shardOccurrences = shards[i].get();
+        for (int position: shardOccurrences) {
+            occurrences.push_back(cuts[i] + position);
+        }
+    }
+
+    std::vector<size_t> bytes(devices);
+    for (size_t i = 0; i < devices; i++) {
+        bytes[i] = cuts[i + 1] - cuts[i];
+    }
+    m_balancer.update(bytes, seconds);
+
+    return occurrences;
+}
+
+/*
+ * multi-device search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> clShardedSearch(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    return ShardedSearcher::Get().findAll(str, subStr);
+}
@@ -0,0 +1,86 @@
+#ifndef SHARDED_SEARCH_HPP
+#define SHARDED_SEARCH_HPP
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "cl.hpp"
+#include "throughputBalancer.hpp"
+
+/**
+ * @brief Splits one find-all across several OpenCL devices.
+ *
+ * Every device gets a ClSearchEngine of its own, with its own context, queues and
+ * buffers. The start positions are cut into one contiguous shard per device; each
+ * shard is uploaded with `substr.length() - 1` bytes past its end, so a match
+ * straddling a cut belongs to the shard it starts in and is reported exactly once.
+ * The shards run at the same time, one host thread per device, and their results are
+ * concatenated in shard order, which keeps them ascending.
+ *
+ * The first cut weighs each device by compute units times clock rate. A
+ * ThroughputBalancer then moves the cuts after every call, so a fast GPU next to an
+ * integrated GPU or a CPU device is not held back by them.
+ */
+class ShardedSearcher {
+public:
+    /**
+     * @brief Creates one engine per device.
+     *
+     * @param devices The devices to shard across, e.g. from findClDevices().
+     * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+     *
+     * @throws std::invalid_argument if `devices` is empty or `smoothing` is outside (0, 1].
+     * @throws cl::Error if an engine cannot be created.
+     */
+    explicit ShardedSearcher(const std::vector<cl::Device>& devices, double smoothing = 0.5);
+
+    /**
+     * @brief Returns the process-wide searcher over the devices of clDeviceSelection(), or every device.
+     *
+     * @throws std::runtime_error if no device matches.
+     */
+    static ShardedSearcher& Get();
+
+    /**
+     * @brief Finds all occurrences of a substring with every device searching one shard.
+     *
+     * @param str The input text to search in.
+     * @param substr The pattern to search for.
+     *
+     * @return The ascending indices of all occurrences of the substring.
+     *
+     * @throws cl::Error if an OpenCL call fails.
+     */
+    std::vector<int> findAll(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Returns the number of devices searched.
+     */
+    size_t deviceCount() const { return m_engines.size(); }
+
+    /**
+     * @brief Returns the fraction of start positions the next call gives to each device.
+     */
+    const std::vector<double>& shares() const { return m_balancer.shares(); }
+
+    // no share drops below minShare / deviceCount(), so every device keeps being measured
+    static constexpr double minShare = 0.01;
+
+private:
+    std::vector<std::unique_ptr<ClSearchEngine>> m_engines;
+    ThroughputBalancer m_balancer;
+};
+
+/*
+ * multi-device search that returns the index of every occurrence of the substring in the string
+ *
+ * Thin wrapper around ShardedSearcher::Get().findAll(), so the shares adapt across calls.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> clShardedSearch(std::string_view str, std::string_view subStr);
+
+#endif // SHARDED_SEARCH_HPP
@@ -0,0 +1,218 @@
+#include "simdFunctions.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define SIMD_X86 1
+#include <immintrin.h>
+#else
+#define SIMD_X86 0
+#endif
+
+namespace {
+
+// Searches the start positions [begin, end) and appends matches to `out`.
+// Returns true if it stopped early because `firstOnly` was set and a match was found.
+using RangeKernel = bool (*)(const char* text, const char* needle, std::size_t needleLen,
+                             std::size_t begin, std::size_t end, bool firstOnly, std::vector<int>& out);
+
+/*
+ * checks the inner bytes of a candidate whose first and last bytes already matched
+ */
+inline bool verifyCandidate(const char* text, const char* needle, std::size_t needleLen, std::size_t pos) {
+    return needleLen <= 2 || std::memcmp(text + pos + 1, needle + 1, needleLen - 2) == 0;
+}
+
+bool scalarRange(const char* text, const char* needle, std::size_t needleLen,
+                 std::size_t begin, std::size_t end, bool firstOnly, std::vector<int>& out) {
+    std::size_t pos = begin;
+    while (pos < end) {
+        const void* hit = std::memchr(text + pos, needle[0], end - pos);
+        if (hit == nullptr) {
+            return false;
+        }
+        pos = static_cast<const char*>(hit) - text;
+        if (text[pos + needleLen - 1] == needle[needleLen - 1] && verifyCandidate(text, needle, needleLen, pos)) {
+            out.push_back(pos);
+            if (firstOnly) {
+                return true;
+            }
+        }
+        pos++;
+    }
+    return false;
+}
+
+#if SIMD_X86
+// Each block compares the first needle byte at pos + k and the last needle byte at
+// pos + k + needleLen - 1; a block is only loaded while all its start positions are
+// below `end`, so the second load never reads past the string.
+
+bool sse2Range(const char* text, const char* needle, std::size_t needleLen,
+               std::size_t begin, std::size_t end, bool firstOnly, std::vector<int>& out) {
+    const __m128i first = _mm_set1_epi8(needle[0]);
+    const __m128i last = _mm_set1_epi8(needle[needleLen - 1]);
+
+    std::size_t pos = begin;
+    for (; pos + 16 <= end; pos += 16) {
+        __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos));
+        __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(text + pos + needleLen - 1));
+        unsigned mask = _mm_movemask_epi8(_mm_and_si128(_mm_cmpeq_epi8(first, blockFirst),
+                                                        _mm_cmpeq_epi8(last, blockLast)));
+        while (mask != 0) {
+            std::size_t candidate = pos + __builtin_ctz(mask);
+            if (verifyCandidate(text, needle, needleLen, candidate)) {
+                out.push_back(candidate);
+                if (firstOnly) {
+                    return true;
+                }
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarRange(text, needle, needleLen, pos, end, firstOnly, out);
+}
+
+__attribute__((target("avx2")))
+bool avx2Range(const char* text, const char* needle, std::size_t needleLen,
+               std::size_t begin, std::size_t end, bool firstOnly, std::vector<int>& out) {
+    const __m256i first = _mm256_set1_epi8(needle[0]);
+    const __m256i last = _mm256_set1_epi8(needle[needleLen - 1]);
+
+    std::size_t pos = begin;
+    for (; pos + 32 <= end; pos += 32) {
+        __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos));
+        __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(text + pos + needleLen - 1));
+        unsigned mask = _mm256_movemask_epi8(_mm256_and_si256(_mm256_cmpeq_epi8(first, blockFirst),
+                                                              _mm256_cmpeq_epi8(last, blockLast)));
+        while (mask != 0) {
+            std::size_t candidate = pos + __builtin_ctz(mask);
+            if (verifyCandidate(text, needle, needleLen, candidate)) {
+                out.push_back(candidate);
+                if (firstOnly) {
+                    return true;
+                }
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarRange(text, needle, needleLen, pos, end, firstOnly, out);
+}
+
+__attribute__((target("avx512f,avx512bw")))
+bool avx512Range(const char* text, const char* needle, std::size_t needleLen,
+                 std::size_t begin, std::size_t end, bool firstOnly, std::vector<int>& out) {
+    const __m512i first = _mm512_set1_epi8(needle[0]);
+    const __m512i last = _mm512_set1_epi8(needle[needleLen - 1]);
+
+    std::size_t pos = begin;
+    for (; pos + 64 <= end; pos += 64) {
+        __m512i blockFirst = _mm512_loadu_si512(text + pos);
+        __m512i blockLast = _mm512_loadu_si512(text + pos + needleLen - 1);
+        __mmask64 mask = _mm512_mask_cmpeq_epi8_mask(_mm512_cmpeq_epi8_mask(first, blockFirst), last, blockLast);
+        while (mask != 0) {
+            std::size_t candidate = pos + __builtin_ctzll(mask);
+            if (verifyCandidate(text, needle, needleLen, candidate)) {
+                out.push_back(candidate);
+                if (firstOnly) {
+                    return true;
+                }
+            }
+            mask &= mask - 1;
+        }
+    }
+    return scalarRange(text, needle, needleLen, pos, end, firstOnly, out);
+}
+#endif
+
+struct Implementation {
+    RangeKernel kernel;
+    const char* name;
+};
+
+/*
+ * picks the widest kernel the running CPU (and OS, for the AVX register state) supports
+ */
+Implementation selectImplementation() {
+#if SIMD_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512bw")) {
+        return {avx512Range, "avx512bw"};
+    }
+    if (__builtin_cpu_supports("avx2")) {
+        return {avx2Range, "avx2"};
+    }
+    return {sse2Range, "sse2"};
+#else
+    return {scalarRange, "scalar"};
+#endif
+}
+
+const Implementation& implementation() {
+    static const Implementation selected = selectImplementation();
+    return selected;
+}
+
+} // namespace
+
+/*
+ * vectorized search restricted to the start positions [begin, end)
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param begin : first start position to test
+ * @param end : one past the last start position to test
+ * @param firstOnly : stop after the first occurrence
+ * @param out : receives the occurrences
+ */
+void simdFindRange(std::string_view str, std::string_view subStr,
+                   std::size_t begin, std::size_t end, bool firstOnly, std::vector<int> &out) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    end = std::min(end, str.length() - subStr.length() + 1);
+    if (begin >= end) {
+        return;
+    }
+    implementation().kernel(str.data(), subStr.data(), subStr.length(), begin, end, firstOnly, out);
+}
+
+/*
+ * vectorized search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int simdFind(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    std::vector<int> occurrences;
+    simdFindRange(str, subStr, 0, str.length(), true, occurrences);
+    return occurrences.empty() ? -1 : occurrences.front();
+}
+
+/*
+ * vectorized search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> simdFindAll(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    std::vector<int> occurrences;
+    simdFindRange(str, subStr, 0, str.length(), false, occurrences);
+    return occurrences;
+}
+
+/*
+ * @return the name of the instruction set selected at runtime
+ */
+const char* simdImplementationName() {
+    return implementation().name;
+}
@@ -0,0 +1,58 @@
+#ifndef SIMD_FUNCTIONS_HPP
+#define SIMD_FUNCTIONS_HPP
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/*
+ * Vectorized string search. The first and last bytes of the substring are broadcast
+ * into vector registers and compared against a block of the string; every set bit of
+ * the combined mask is a candidate that is verified with memcmp. The widest of
+ * AVX-512BW (64 bytes), AVX2 (32 bytes) and SSE2 (16 bytes) supported by the running
+ * CPU is selected once through CPUID, so one binary runs on any x86-64 host. Other
+ * architectures use a memchr based scalar loop.
+ */
+
+/*
+ * vectorized search that returns the index of the first occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the index of the first occurrence of the substring in the string, -1 if there is none
+ */
+int simdFind(std::string_view str, std::string_view subStr);
+
+/*
+ * vectorized search that returns the index of every occurrence of the substring in the string
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the ascending indices of all occurrences of the substring
+ */
+std::vector<int> simdFindAll(std::string_view str, std::string_view subStr);
+
+/*
+ * vectorized search restricted to the start positions [begin, end)
+ *
+ * Occurrences may extend past `end`, but never past the end of the string. Matches are
+ * appended to `out` in ascending order.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param begin : first start position to test
+ * @param end : one past the last start position to test
+ * @param firstOnly : stop after the first occurrence
+ * @param out : receives the occurrences
+ */
+void simdFindRange(std::string_view str, std::string_view subStr,
+                   std::size_t begin, std::size_t end, bool firstOnly, std::vector<int> &out);
+
+/*
+ * @return the name of the instruction set selected at runtime ("avx512bw", "avx2", "sse2" or "scalar")
+ */
+const char* simdImplementationName();
+
+#endif // SIMD_FUNCTIONS_HPP
@@ -0,0 +1,325 @@
+#ifndef SINK_SEARCH_HPP
+#define SINK_SEARCH_HPP
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <utility>
+#include <vector>
+#include "resultSink.hpp"
+#include "algorithmFunctions.hpp"
+#include "simdFunctions.hpp"
+
+/*
+ * Find-all variants that hand every occurrence to a ResultSink instead of returning a
+ * std::vector<int>. They are templates on the sink, so each backend is compiled once
+ * per sink type with the per-occurrence call inlined, and a VectorSink over a reused
+ * buffer, a CountSink or a FirstSink searches without allocating. Occurrences are
+ * reported in ascending order, overlapping ones included, like standardFindAll, and
+ * as 64-bit offsets. The *FindAll functions of algorithmFunctions.hpp are built on these.
+ */
+
+/*
+ * bad-character shift of Horspool: distance from the last occurrence of a byte in
+ * needle[0, m - 1) to the end of the needle, m for bytes that do not occur there
+ */
+inline std::array<std::size_t, 256> badCharacterShifts(const unsigned char* needle, std::size_t m) {
+    std::array<std::size_t, 256> shifts;
+    shifts.fill(m);
+    for (std::size_t i = 0; i + 1 < m; i++) {
+        shifts[needle[i]] = m - 1 - i;
+    }
+    return shifts;
+}
+
+/*
+ * start of the maximal suffix of the needle under the byte order (or its reverse) and
+ * the period of that suffix; -1 stands for the empty prefix
+ */
+inline std::ptrdiff_t maximalSuffix(const unsigned char* needle, std::ptrdiff_t m, bool reversed, std::ptrdiff_t& period) {
+    std::ptrdiff_t suffix = -1;
+    std::ptrdiff_t j = 0;
+    std::ptrdiff_t k = 1;
+    period = 1;
+    while (j + k < m) {
+        unsigned char a = needle[j + k];
+        unsigned char b = needle[suffix + k];
+        if (reversed ? a > b : a < b) {
+            j += k;
+            k = 1;
+            period = j - suffix;
+        } else if (a == b) {
+            if (k != period) {
+                k++;
+            } else {
+                j += period;
+                k = 1;
+            }
+        } else {
+            suffix = j;
+            j = suffix + 1;
+            k = period = 1;
+        }
+    }
+    return suffix;
+}
+
+/*
+ * std::string_view::find search that passes every occurrence of the substring to the sink
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void standardFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    for (std::size_t pos = str.find(subStr); pos != std::string_view::npos; pos = str.find(subStr, pos + 1)) {
+        if (!sink(pos)) {
+            return;
+        }
+    }
+}
+
+/*
+ * Boyer-Moore-Horspool search that passes every occurrence of the substring to the sink
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void horspoolFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    const auto* text = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* needle = reinterpret_cast<const unsigned char*>(subStr.data());
+    const std::size_t n = str.length();
+    const std::size_t m = subStr.length();
+
+    const auto shifts = badCharacterShifts(needle, m);
+    const unsigned char last = needle[m - 1];
+
+    for (std::size_t pos = 0; pos <= n - m;) {
+        unsigned char c = text[pos + m - 1];
+        if (c == last && std::memcmp(text + pos, needle, m - 1) == 0 && !sink(pos)) {
+            return;
+        }
+        pos += shifts[c];
+    }
+}
+
+/*
+ * Raita search (Horspool shifts, last, first and middle byte checked before the rest)
+ * that passes every occurrence of the substring to the sink
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void raitaFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    const auto* text = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* needle = reinterpret_cast<const unsigned char*>(subStr.data());
+    const std::size_t n = str.length();
+    const std::size_t m = subStr.length();
+
+    const auto shifts = badCharacterShifts(needle, m);
+    const unsigned char first = needle[0];
+    const unsigned char middle = needle[m / 2];
+    const unsigned char last = needle[m - 1];
+
+    for (std::size_t pos = 0; pos <= n - m;) {
+        unsigned char c = text[pos + m - 1];
+        if (c == last && text[pos] == first && text[pos + m / 2] == middle &&
+            (m <= 2 || std::memcmp(text + pos + 1, needle + 1, m - 2) == 0) && !sink(pos)) {
+            return;
+        }
+        pos += shifts[c];
+    }
+}
+
+/*
+ * Crochemore-Perrin Two-Way search that passes every occurrence of the substring to the sink
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void twoWayFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    const auto* text = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* needle = reinterpret_cast<const unsigned char*>(subStr.data());
+    const std::ptrdiff_t len = subStr.length();
+    const std::ptrdiff_t last = str.length() - subStr.length();
+
+    // critical factorization needle = needle[0, ell] needle[ell + 1, m)
+    std::ptrdiff_t period;
+    std::ptrdiff_t reversedPeriod;
+    std::ptrdiff_t suffix = maximalSuffix(needle, len, false, period);
+    std::ptrdiff_t reversedSuffix = maximalSuffix(needle, len, true, reversedPeriod);
+    std::ptrdiff_t ell = suffix;
+    if (suffix <= reversedSuffix) {
+        ell = reversedSuffix;
+        period = reversedPeriod;
+    }
+
+    if (std::memcmp(needle, needle + period, ell + 1) == 0) {
+        // periodic needle: after a shift by the period the prefix that already matched is remembered
+        std::ptrdiff_t memory = -1;
+        for (std::ptrdiff_t pos = 0; pos <= last;) {
+            std::ptrdiff_t i = std::max(ell, memory) + 1;
+            while (i < len && needle[i] == text[pos + i]) {
+                i++;
+            }
+            if (i < len) {
+                pos += i - ell;
+                memory = -1;
+                continue;
+            }
+            i = ell;
+            while (i > memory && needle[i] == text[pos + i]) {
+                i--;
+            }
+            if (i <= memory && !sink(pos)) {
+                return;
+            }
+            pos += period;
+            memory = len - period - 1;
+        }
+    } else {
+        // the period is longer than either half, so shifting past the larger half is safe
+        std::ptrdiff_t shift = std::max(ell + 1, len - ell - 1) + 1;
+        for (std::ptrdiff_t pos = 0; pos <= last;) {
+            std::ptrdiff_t i = ell + 1;
+            while (i < len && needle[i] == text[pos + i]) {
+                i++;
+            }
+            if (i < len) {
+                pos += i - ell;
+                continue;
+            }
+            i = ell;
+            while (i >= 0 && needle[i] == text[pos + i]) {
+                i--;
+            }
+            if (i < 0 && !sink(pos)) {
+                return;
+            }
+            pos += shift;
+        }
+    }
+}
+
+/*
+ * bit-parallel Shift-Or search that passes every occurrence of the substring to the sink
+ *
+ * Needles longer than 64 bytes are filtered on their first 64 bytes and then verified.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void shiftOrFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    const auto* text = reinterpret_cast<const unsigned char*>(str.data());
+    const auto* needle = reinterpret_cast<const unsigned char*>(subStr.data());
+    const std::size_t n = str.length();
+    const std::size_t m = subStr.length();
+
+    // a cleared bit i of the state means needle[0, i] ends at the current byte
+    const std::size_t filterLen = std::min<std::size_t>(m, 64);
+    std::array<std::uint64_t, 256> masks;
+    masks.fill(~std::uint64_t(0));
+    for (std::size_t i = 0; i < filterLen; i++) {
+        masks[needle[i]] &= ~(std::uint64_t(1) << i);
+    }
+    const std::uint64_t found = std::uint64_t(1) << (filterLen - 1);
+
+    // the filter prefix has to end early enough for the whole needle to fit
+    const std::size_t lastEnd = n - m + filterLen;
+    std::uint64_t state = ~std::uint64_t(0);
+    for (std::size_t end = 0; end < lastEnd; end++) {
+        state = (state << 1) | masks[text[end]];
+        if ((state & found) == 0) {
+            std::size_t pos = end + 1 - filterLen;
+            if ((m == filterLen || std::memcmp(text + pos + filterLen, needle + filterLen, m - filterLen) == 0) &&
+                !sink(pos)) {
+                return;
+            }
+        }
+    }
+}
+
+// start positions simdFindAllInto searches per simdFindRange call, far below the int range of its offsets
+inline constexpr std::size_t simdSinkBlock = std::size_t(1) << 20;
+
+/*
+ * SIMD first/last byte filter search that passes every occurrence of the substring to the sink
+ *
+ * simdFindRange reports int offsets, so the start positions are searched in blocks of
+ * simdSinkBlock and the block's offsets are widened before they reach the sink. The
+ * block buffer is kept per thread and reused across calls.
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+
+template<ResultSink Sink>
+void simdFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    if (subStr.empty() || subStr.length() > str.length()) {
+        return;
+    }
+    // taken out while in use, so a sink that searches again gets a buffer of its own
+    thread_local std::vector<int> spare;
+    std::vector<int> block = std::move(spare);
+
+    const std::size_t positions = str.length() - subStr.length() + 1;
+    bool stopped = false;
+    for (std::size_t begin = 0; begin < positions && !stopped; begin += simdSinkBlock) {
+        std::size_t count = std::min(simdSinkBlock, positions - begin);
+        block.clear();
+        simdFindRange(str.substr(begin, count + subStr.length() - 1), subStr, 0, count, false, block);
+        for (int offset: block) {
+            if (!sink(begin + offset)) {
+                stopped = true;
+                break;
+            }
+        }
+    }
+
+    spare = std::move(block);
+}
+
+/*
+ * search that passes every occurrence of the substring to the sink with the algorithm
+ * chosen by selectAlgorithm
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ * @param sink : receives the offsets of the occurrences
+ */
+template<ResultSink Sink>
+void adaptiveFindAllInto(std::string_view str, std::string_view subStr, Sink& sink) {
+    switch (selectAlgorithm(subStr)) {
+    case SearchAlgorithm::Horspool: return horspoolFindAllInto(str, subStr, sink);
+    case SearchAlgorithm::Raita: return raitaFindAllInto(str, subStr, sink);
+    case SearchAlgorithm::TwoWay: return twoWayFindAllInto(str, subStr, sink);
+    case SearchAlgorithm::ShiftOr: return shiftOrFindAllInto(str, subStr, sink);
+    case SearchAlgorithm::Simd: return simdFindAllInto(str, subStr, sink);
+    }
+}
+
+#endif // SINK_SEARCH_HPP
@@ -11,7 +11,7 @@
  *
  * @return the index of the first occurrence of the substring in the string
  */
-int standardFind(const std::string &str, const std::string &subStr) {
+int standardFind(std::string_view str, std::string_view subStr) {
     PROFILE_FUNCTION();
     return str.find(subStr);
 }
@@ -24,7 +24,7 @@ int standardFind(const std::string &str, const std::string &subStr) {
  *
  * @return 1 if the substring is found in the string, 0 otherwise
  */
- int standardContains(const std::string &str, const std::string &subStr) {
+ int standardContains(std::string_view str, std::string_view subStr) {
     PROFILE_FUNCTION();
     return str.contains(subStr); ;
  }
@@ -38,14 +38,14 @@ int standardFind(const std::string &str, const std::string &subStr) {
  *
  * @return the occurrences of a substring
  */
-std::vector<int> standardFindAll(const std::string &str, const std::string &subStr) {
+std::vector<int> standardFindAll(std::string_view str, std::string_view subStr) {
     PROFILE_FUNCTION();
    // Find the first occurrence of target in text
     size_t pos = str.find(subStr);
 
     std::vector<int> occurrences;
     // Continue finding until no more occurrences are found
-    while (pos != std::string::npos) {
+    while (pos != std::string_view::npos) {
         occurrences.push_back(pos); 
         // Find the next occurrence, starting just after the current one
         pos = str.find(subStr, pos + 1);
@@ -54,3 +54,23 @@ std::vector<int> standardFindAll(const std::string &str, const std::string &subS
     return occurrences;
 }
 
+/*
+ * Standard string search function that returns the number of occurrences of a substring, overlapping ones included
+ *
+ * @param str : the string to search in
+ * @param subStr : the substring to search for
+ *
+ * @return the number of occurrences of the substring
+ */
+int standardCount(std::string_view str, std::string_view subStr) {
+    PROFILE_FUNCTION();
+    if (subStr.empty()) {
+        return 0;
+    }
+
+    int occurrences = 0;
+    for (size_t pos = str.find(subStr); pos != std::string_view::npos; pos = str.find(subStr, pos + 1)) {
+        occurrences++;
+    }
+    return occurrences;
+}
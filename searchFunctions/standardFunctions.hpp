@@ -1,7 +1,9 @@
 #include <string>
+#include <string_view>
 #include <vector>
 
 
-int standardFind(const std::string &str, const std::string &subStr);
-int standardContains(const std::string &str, const std::string &subStr);
-std::vector<int> standardFindAll(const std::string &str, const std::string& subStr);
+int standardFind(std::string_view str, std::string_view subStr);
+int standardContains(std::string_view str, std::string_view subStr);
+std::vector<int> standardFindAll(std::string_view str, std::string_view subStr);
+int standardCount(std::string_view str, std::string_view subStr);
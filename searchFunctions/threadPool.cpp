@@ -0,0 +1,250 @@
+#include "threadPool.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+#if defined(__linux__)
+#include <sched.h>
+#define THREADPOOL_AFFINITY 1
+#else
+#define THREADPOOL_AFFINITY 0
+#endif
+
+namespace {
+
+// pool installed by the innermost ScopedThreadPool, nullptr for the process-wide pool
+std::atomic<ThreadPool*> currentPool {nullptr};
+
+} // namespace
+
+/**
+ * @brief Starts the pool.
+ *
+ * @param threadCount Total number of threads running a job, including the caller.
+ *                    0 selects std::thread::hardware_concurrency().
+ */
+ThreadPool::ThreadPool(unsigned threadCount)
+: m_task(nullptr), m_taskCount(0), m_nextTask(0), m_oncePerThread(false), m_finishedWorkers(0), m_generation(0),
+  m_stop(false) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 1; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+/**
+ * @brief Starts a pool of cpus.size() threads, worker i pinned to cpus[i].
+ *
+ * @param cpus CPU numbers, one per thread; must not be empty.
+ *
+ * @throws std::invalid_argument if `cpus` is empty.
+ */
+ThreadPool::ThreadPool(const std::vector<unsigned>& cpus)
+: m_task(nullptr), m_taskCount(0), m_nextTask(0), m_oncePerThread(false), m_finishedWorkers(0), m_generation(0),
+  m_stop(false) {
+    if (cpus.empty()) {
+        throw std::invalid_argument("A pinned thread pool needs at least one CPU.");
+    }
+    for (std::size_t i = 1; i < cpus.size(); i++) {
+        m_workers.emplace_back([this, cpu = cpus[i]]() {
+            pinCurrentThread({cpu});
+            workerLoop();
+        });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto& worker: m_workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Returns the pool installed by the innermost ScopedThreadPool, or else the
+ *        process-wide pool sized to the hardware concurrency.
+ */
+ThreadPool& ThreadPool::Get() {
+    if (ThreadPool* pool = currentPool.load(std::memory_order_acquire)) {
+        return *pool;
+    }
+    static ThreadPool pool;
+    return pool;
+}
+
+/**
+ * @brief Restricts the calling thread to `cpus`.
+ *
+ * @return false if the platform does not support pinning or the CPUs are not available.
+ */
+bool ThreadPool::pinCurrentThread(const std::vector<unsigned>& cpus) {
+#if THREADPOOL_AFFINITY
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (unsigned cpu: cpus) {
+        if (cpu >= CPU_SETSIZE) {
+            return false;
+        }
+        CPU_SET(cpu, &set);
+    }
+    return !cpus.empty() && sched_setaffinity(0, sizeof(set), &set) == 0;
+#else
+    (void)cpus;
+    return false;
+#endif
+}
+
+/**
+ * @brief Returns the CPUs the calling thread may run on, ascending.
+ */
+std::vector<unsigned> ThreadPool::currentAffinity() {
+    std::vector<unsigned> cpus;
+#if THREADPOOL_AFFINITY
+    cpu_set_t set;
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (unsigned cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+        return cpus;
+    }
+#endif
+    for (unsigned cpu = 0; cpu < std::max(1u, std::thread::hardware_concurrency()); cpu++) {
+        cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+/**
+ * @brief Returns the number of threads that run a job, including the caller.
+ */
+unsigned ThreadPool::size() const {
+    return m_workers.size() + 1;
+}
+
+/**
+ * @brief Runs task(i) for every i in [0, taskCount) and waits for all of them.
+ *
+ * Every worker checks in once per job, even if no task is left for it, so no worker
+ * can still hold a pointer to `task` after this returns.
+ *
+ * @param taskCount Number of tasks.
+ * @param task      Callable invoked with each task index.
+ */
+void ThreadPool::parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task) {
+    if (taskCount == 0) {
+        return;
+    }
+    if (m_workers.empty() || taskCount == 1) {
+        for (std::size_t i = 0; i < taskCount; i++) {
+            task(i);
+        }
+        return;
+    }
+    runJob(taskCount, task, false);
+}
+
+/**
+ * @brief Runs task(i) once on every thread of the pool, the caller included, and waits for all of them.
+ *
+ * Every worker checks in once per job and the caller runs one task too, so with one
+ * task per thread and at most one claim each, every thread runs exactly one index.
+ *
+ * @param task Callable invoked with each thread's index.
+ */
+void ThreadPool::runOnEveryThread(const std::function<void(std::size_t)>& task) {
+    if (m_workers.empty()) {
+        task(0);
+        return;
+    }
+    runJob(size(), task, true);
+}
+
+/**
+ * @brief Hands `task` to the workers, helps run it and waits until every worker has checked in.
+ *
+ * @param taskCount     Number of tasks.
+ * @param task          Callable invoked with each task index.
+ * @param oncePerThread Whether every thread stops after its first task.
+ */
+void ThreadPool::runJob(std::size_t taskCount, const std::function<void(std::size_t)>& task, bool oncePerThread) {
+    std::lock_guard<std::mutex> submitLock(m_submitMutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_task = &task;
+        m_taskCount = taskCount;
+        m_nextTask = 0;
+        m_oncePerThread = oncePerThread;
+        m_finishedWorkers = 0;
+        m_error = nullptr;
+        m_generation++;
+    }
+    m_wake.notify_all();
+
+    runTasks();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_done.wait(lock, [this] { return m_finishedWorkers == m_workers.size(); });
+    m_task = nullptr;
+
+    if (m_error) {
+        std::rethrow_exception(m_error);
+    }
+}
+
+/**
+ * @brief Worker main loop: waits for a new job generation and helps run it.
+ */
+void ThreadPool::workerLoop() {
+    std::uint64_t seenGeneration = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [&] { return m_stop || m_generation != seenGeneration; });
+            if (m_stop) {
+                return;
+            }
+            seenGeneration = m_generation;
+        }
+
+        runTasks();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (++m_finishedWorkers == m_workers.size()) {
+            m_done.notify_one();
+        }
+    }
+}
+
+/**
+ * @brief Claims and runs task indices of the current job until none are left.
+ */
+void ThreadPool::runTasks() {
+    std::size_t index;
+    while ((index = m_nextTask.fetch_add(1)) < m_taskCount) {
+        try {
+            (*m_task)(index);
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (!m_error) {
+                m_error = std::current_exception();
+            }
+        }
+        if (m_oncePerThread) {
+            return;
+        }
+    }
+}
+
+ScopedThreadPool::ScopedThreadPool(ThreadPool& pool)
+: m_previous(currentPool.exchange(&pool, std::memory_order_acq_rel)) {}
+
+ScopedThreadPool::~ScopedThreadPool() {
+    currentPool.store(m_previous, std::memory_order_release);
+}
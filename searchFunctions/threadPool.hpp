@@ -0,0 +1,149 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Fixed-size pool of persistent worker threads.
+ *
+ * Workers are started once and sleep between jobs, so parallel search functions do
+ * not pay thread creation on every call. A job is a parallelFor over task indices;
+ * the calling thread takes part in the job, so a pool of size N runs N - 1 workers.
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Starts the pool.
+     *
+     * @param threadCount Total number of threads running a job, including the caller.
+     *                    0 selects std::thread::hardware_concurrency().
+     */
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    /**
+     * @brief Starts a pool of cpus.size() threads, worker i pinned to cpus[i].
+     *
+     * The calling thread runs as thread 0 of every job and is not pinned here; pin it
+     * to cpus[0] with pinCurrentThread() for a fully pinned job. Where pinning is not
+     * supported the workers run unpinned.
+     *
+     * @param cpus CPU numbers, one per thread; must not be empty.
+     *
+     * @throws std::invalid_argument if `cpus` is empty.
+     */
+    explicit ThreadPool(const std::vector<unsigned>& cpus);
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Returns the pool installed by the innermost ScopedThreadPool, or else the
+     *        process-wide pool sized to the hardware concurrency.
+     */
+    static ThreadPool& Get();
+
+    /**
+     * @brief Restricts the calling thread to `cpus`.
+     *
+     * @return false if the platform does not support pinning or the CPUs are not available.
+     */
+    static bool pinCurrentThread(const std::vector<unsigned>& cpus);
+
+    /**
+     * @brief Returns the CPUs the calling thread may run on, ascending.
+     *
+     * Where affinity is not supported this is 0 to hardware_concurrency() - 1.
+     */
+    static std::vector<unsigned> currentAffinity();
+
+    /**
+     * @brief Returns the number of threads that run a job, including the caller.
+     */
+    unsigned size() const;
+
+    /**
+     * @brief Runs task(i) for every i in [0, taskCount) and waits for all of them.
+     *
+     * Tasks are handed out dynamically, so uneven tasks balance across threads. The
+     * first exception thrown by a task is rethrown here once every thread has stopped.
+     * Tasks must not call parallelFor on the same pool.
+     *
+     * @param taskCount Number of tasks.
+     * @param task      Callable invoked with each task index.
+     */
+    void parallelFor(std::size_t taskCount, const std::function<void(std::size_t)>& task);
+
+    /**
+     * @brief Runs task(i) once on every thread of the pool, the caller included, and waits for all of them.
+     *
+     * Each index in [0, size()) is run by a different thread; which thread gets which
+     * index is unspecified. Meant for per-thread state such as hardware counters.
+     *
+     * @param task Callable invoked with each thread's index.
+     */
+    void runOnEveryThread(const std::function<void(std::size_t)>& task);
+
+private:
+    /**
+     * @brief Hands `task` to the workers, helps run it and waits until every worker has checked in.
+     */
+    void runJob(std::size_t taskCount, const std::function<void(std::size_t)>& task, bool oncePerThread);
+
+    /**
+     * @brief Worker main loop: waits for a new job generation and helps run it.
+     */
+    void workerLoop();
+
+    /**
+     * @brief Claims and runs task indices of the current job until none are left.
+     */
+    void runTasks();
+
+private:
+    std::vector<std::thread> m_workers;
+
+    std::mutex m_submitMutex;
+    std::mutex m_mutex;
+    std::condition_variable m_wake;
+    std::condition_variable m_done;
+
+    const std::function<void(std::size_t)>* m_task;
+    std::size_t m_taskCount;
+    std::atomic<std::size_t> m_nextTask;
+    // every thread claims at most one task of the current job
+    bool m_oncePerThread;
+    std::size_t m_finishedWorkers;
+    std::uint64_t m_generation;
+    std::exception_ptr m_error;
+    bool m_stop;
+};
+
+/**
+ * @brief Makes ThreadPool::Get() return `pool` while it lives.
+ *
+ * Lets the parallel backends, which all run on ThreadPool::Get(), be run on a pool of
+ * another size or pinning without changing their signatures. Scopes nest, and the
+ * override is process-wide, so it must not be changed while another thread runs a job.
+ */
+class ScopedThreadPool {
+public:
+    explicit ScopedThreadPool(ThreadPool& pool);
+    ~ScopedThreadPool();
+
+    ScopedThreadPool(const ScopedThreadPool&) = delete;
+    ScopedThreadPool& operator=(const ScopedThreadPool&) = delete;
+
+private:
+    ThreadPool* m_previous;
+};
+
+#endif // THREAD_POOL_HPP
@@ -0,0 +1,71 @@
+#include "throughputBalancer.hpp"
+#include <algorithm>
+
+/**
+ * @brief Starts from an even split.
+ *
+ * @param workers Number of workers, at least 1.
+ * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+ * @param floor Smallest share of a worker, at most 1 / `workers`.
+ */
+ThroughputBalancer::ThroughputBalancer(std::size_t workers, double smoothing, double floor)
+: m_smoothing(smoothing), m_floor(floor), m_shares(workers, 1.0 / std::max<std::size_t>(workers, 1)),
+  m_throughputs(workers, 0) {}
+
+/**
+ * @brief Sets the shares proportional to `weights`, keeping every share at or above the floor.
+ *
+ * A worker whose proportional share falls below the floor is held at the floor, and
+ * the rest is split again among the others in proportion to their weights, until no
+ * share falls below the floor.
+ *
+ * @param weights One non-negative weight per worker, not all zero.
+ */
+void ThroughputBalancer::setShares(const std::vector<double>& weights) {
+    std::vector<bool> atFloor(weights.size(), false);
+    for (bool changed = true; changed; ) {
+        changed = false;
+        double remaining = 1;
+        double total = 0;
+        for (std::size_t i = 0; i < weights.size(); i++) {
+            if (atFloor[i]) {
+                remaining -= m_floor;
+            } else {
+                total += weights[i];
+            }
+        }
+        for (std::size_t i = 0; i < weights.size(); i++) {
+            if (atFloor[i]) {
+                m_shares[i] = m_floor;
+                continue;
+            }
+            m_shares[i] = total > 0 ? remaining * weights[i] / total : m_floor;
+            if (m_shares[i] < m_floor) {
+                atFloor[i] = true;
+                changed = true;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Blends the latest run of every worker into its estimate and rebalances the shares.
+ *
+ * @param bytes Start positions each worker searched; a worker that searched none keeps its estimate.
+ * @param seconds Time each worker took.
+ */
+void ThroughputBalancer::update(const std::vector<std::size_t>& bytes, const std::vector<double>& seconds) {
+    for (std::size_t i = 0; i < m_throughputs.size(); i++) {
+        if (bytes[i] == 0 || seconds[i] <= 0) {
+            continue;
+        }
+        double throughput = bytes[i] / seconds[i];
+        m_throughputs[i] = m_throughputs[i] == 0 ? throughput
+                                                 : m_smoothing * throughput + (1 - m_smoothing) * m_throughputs[i];
+    }
+
+    // all workers finish together when their shares follow their throughputs
+    if (std::all_of(m_throughputs.begin(), m_throughputs.end(), [](double t) { return t > 0; })) {
+        setShares(m_throughputs);
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef THROUGHPUT_BALANCER_HPP
+#define THROUGHPUT_BALANCER_HPP
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Splits the start positions of a search between workers that run side by side.
+ *
+ * After every call the throughput of each worker (bytes searched per second) is
+ * blended into a running estimate, and once every worker has been measured the next
+ * split gives each one a share proportional to its estimate, so all of them finish
+ * together. No share drops below a floor, so every worker keeps being measured.
+ * Used by HybridSearcher for the device and the CPU, and by ShardedSearcher for its
+ * devices.
+ */
+class ThroughputBalancer {
+public:
+    /**
+     * @brief Starts from an even split.
+     *
+     * @param workers Number of workers, at least 1.
+     * @param smoothing Weight of the latest run in the throughput estimates, in (0, 1].
+     * @param floor Smallest share of a worker, at most 1 / `workers`.
+     */
+    ThroughputBalancer(std::size_t workers, double smoothing, double floor);
+
+    /**
+     * @brief Returns the fraction of start positions the next call gives to each worker.
+     */
+    const std::vector<double>& shares() const { return m_shares; }
+
+    /**
+     * @brief Sets the shares proportional to `weights`, keeping every share at or above the floor.
+     *
+     * @param weights One non-negative weight per worker, not all zero.
+     */
+    void setShares(const std::vector<double>& weights);
+
+    /**
+     * @brief Blends the latest run of every worker into its estimate and rebalances the shares.
+     *
+     * @param bytes Start positions each worker searched; a worker that searched none keeps its estimate.
+     * @param seconds Time each worker took.
+     */
+    void update(const std::vector<std::size_t>& bytes, const std::vector<double>& seconds);
+
+private:
+    double m_smoothing;
+    double m_floor;
+    std::vector<double> m_shares;
+    // smoothed bytes per second of each worker, 0 until first measured
+    std::vector<double> m_throughputs;
+};
+
+#endif // THROUGHPUT_BALANCER_HPP
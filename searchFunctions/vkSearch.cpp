@@ -1,20 +1,594 @@
-#include <vulkan/vulkan.h>
-#include <cstring>
-#include <cassert>
 #include "performance-analyzer/performance-analyzer.hpp"
 #include "vkSearch.hpp"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
 // Helper macro for error checking.
-#define VK_CHECK(x) do { VkResult err = x; if (err) { \
-    std::cerr << "Detected Vulkan error: " << err << std::endl; \
-    throw std::runtime_error("Vulkan error"); } } while(0)
+#define VK_CHECK(x) do { VkResult err = x; if (err != VK_SUCCESS) { \
+    std::cerr << "Detected Vulkan error: " << err << " in " << #x << std::endl; \
+    throw std::runtime_error("Vulkan error: " + std::to_string(err)); } } while(0)
+
+namespace {
+
+// SPIR-V of shaders/findAll.comp, generated by glslc at build time
+const std::uint32_t findAllSpirv[] = {
+#include "findAll.spv.inc"
+};
+
+// must match the push constant block of findAll.comp
+struct PushConstants {
+    std::uint32_t textLen;
+    std::uint32_t patternLen;
+    std::uint32_t capacity;
+    std::uint32_t collect;
+};
+
+// count and first precede the match array in the result buffer
+constexpr VkDeviceSize resultHeaderSize = 2 * sizeof(std::uint32_t);
+constexpr std::uint32_t noMatch = UINT32_MAX;
+
+// caps a chunk so a single upload stays a reasonable size even when the device allows more
+constexpr VkDeviceSize maxChunkBytes = 256ull * 1024 * 1024;
+
+// matches the result buffer starts with room for
+constexpr std::uint32_t initialResultCapacity = 4096;
+
+VkDeviceSize roundUp4(VkDeviceSize size) {
+    return (size + 3) & ~VkDeviceSize(3);
+}
+
+// lower is better
+int deviceTypeRank(VkPhysicalDeviceType type) {
+    switch (type) {
+        case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU: return 0;
+        case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU: return 1;
+        case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU: return 2;
+        case VK_PHYSICAL_DEVICE_TYPE_CPU: return 3;
+        default: return 4;
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Creates the instance and device and builds the compute pipeline.
+ *
+ * Discrete GPUs are preferred over integrated, virtual and CPU devices.
+ *
+ * @throws std::runtime_error if no device with a compute queue exists or a Vulkan call fails.
+ */
+VkSearchEngine::VkSearchEngine() {
+    PROFILE_FUNCTION();
+    try {
+        Timer setupTimer("Setup Instance and Device");
+
+        VkApplicationInfo appInfo {};
+
+        appInfo.sType = VK_STRUCTURE_TYPE_APPLICATION_INFO;
+        appInfo.pApplicationName = "ss_analytics";
+        appInfo.apiVersion = VK_API_VERSION_1_0;
+
+        VkInstanceCreateInfo instanceInfo {};
+
+        instanceInfo.sType = VK_STRUCTURE_TYPE_INSTANCE_CREATE_INFO;
+        instanceInfo.pApplicationInfo = &appInfo;
+        VK_CHECK(vkCreateInstance(&instanceInfo, nullptr, &m_instance));
+
+        std::uint32_t deviceCount = 0;
+        VK_CHECK(vkEnumeratePhysicalDevices(m_instance, &deviceCount, nullptr));
+        std::vector<VkPhysicalDevice> devices(deviceCount);
+        VK_CHECK(vkEnumeratePhysicalDevices(m_instance, &deviceCount, devices.data()));
+
+        int bestRank = INT_MAX;
+        std::uint32_t timestampBits = 0;
+        for (VkPhysicalDevice device: devices) {
+            VkPhysicalDeviceProperties properties;
+            vkGetPhysicalDeviceProperties(device, &properties);
+
+            std::uint32_t familyCount = 0;
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, nullptr);
+            std::vector<VkQueueFamilyProperties> families(familyCount);
+            vkGetPhysicalDeviceQueueFamilyProperties(device, &familyCount, families.data());
+
+            for (std::uint32_t i = 0; i < familyCount; i++) {
+                if (!(families[i].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
+                    continue;
+                }
+                int rank = deviceTypeRank(properties.deviceType);
+                if (rank < bestRank) {
+                    bestRank = rank;
+                    m_physicalDevice = device;
+                    m_properties = properties;
+                    m_queueFamily = i;
+                    timestampBits = families[i].timestampValidBits;
+                }
+                break;
+            }
+        }
+        if (m_physicalDevice == VK_NULL_HANDLE) {
+            throw std::runtime_error("No Vulkan device with a compute queue found.");
+        }
+        vkGetPhysicalDeviceMemoryProperties(m_physicalDevice, &m_memoryProperties);
+
+        m_timestamps = timestampBits > 0 && m_properties.limits.timestampPeriod > 0;
+        m_timestampMask = timestampBits >= 64 ? UINT64_MAX : (std::uint64_t(1) << timestampBits) - 1;
+
+        float priority = 1.0f;
+        VkDeviceQueueCreateInfo queueInfo {};
+        queueInfo.sType = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
+        queueInfo.queueFamilyIndex = m_queueFamily;
+        queueInfo.queueCount = 1;
+        queueInfo.pQueuePriorities = &priority;
 
+        VkDeviceCreateInfo deviceInfo {};
+
+        deviceInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        deviceInfo.queueCreateInfoCount = 1;
+        deviceInfo.pQueueCreateInfos = &queueInfo;
+        VK_CHECK(vkCreateDevice(m_physicalDevice, &deviceInfo, nullptr, &m_device));
+        vkGetDeviceQueue(m_device, m_queueFamily, 0, &m_queue);
+        setupTimer.stop();
+
+        Timer pipelineTimer("Create Pipeline");
+
+        VkShaderModuleCreateInfo shaderInfo {};
+
+        shaderInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+        shaderInfo.codeSize = sizeof(findAllSpirv);
+        shaderInfo.pCode = findAllSpirv;
+        VK_CHECK(vkCreateShaderModule(m_device, &shaderInfo, nullptr, &m_shader));
+
+        // text, pattern, result
+        VkDescriptorSetLayoutBinding bindings[3] {};
+        for (std::uint32_t i = 0; i < 3; i++) {
+            bindings[i].binding = i;
+            bindings[i].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+            bindings[i].descriptorCount = 1;
+            bindings[i].stageFlags = VK_SHADER_STAGE_COMPUTE_BIT;
+        }
+        VkDescriptorSetLayoutCreateInfo setLayoutInfo {};
+        setLayoutInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        setLayoutInfo.bindingCount = 3;
+        setLayoutInfo.pBindings = bindings;
+        VK_CHECK(vkCreateDescriptorSetLayout(m_device, &setLayoutInfo, nullptr, &m_descriptorSetLayout));
+
+        VkPushConstantRange pushRange {VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PushConstants)};
+        VkPipelineLayoutCreateInfo pipelineLayoutInfo {};
+        pipelineLayoutInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipelineLayoutInfo.setLayoutCount = 1;
+        pipelineLayoutInfo.pSetLayouts = &m_descriptorSetLayout;
+        pipelineLayoutInfo.pushConstantRangeCount = 1;
+        pipelineLayoutInfo.pPushConstantRanges = &pushRange;
+        VK_CHECK(vkCreatePipelineLayout(m_device, &pipelineLayoutInfo, nullptr, &m_pipelineLayout));
+
+        // the work-group size is specialization constant 0 of the shader
+        const VkPhysicalDeviceLimits& limits = m_properties.limits;
+        m_workGroupSize = std::min({256u, limits.maxComputeWorkGroupSize[0], limits.maxComputeWorkGroupInvocations});
+        VkSpecializationMapEntry specEntry {0, 0, sizeof(std::uint32_t)};
+        VkSpecializationInfo specInfo {1, &specEntry, sizeof(std::uint32_t), &m_workGroupSize};
+
+        VkComputePipelineCreateInfo pipelineInfo {};
+
+        pipelineInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+        pipelineInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+        pipelineInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+        pipelineInfo.stage.module = m_shader;
+        pipelineInfo.stage.pName = "main";
+        pipelineInfo.stage.pSpecializationInfo = &specInfo;
+        pipelineInfo.layout = m_pipelineLayout;
+        VK_CHECK(vkCreateComputePipelines(m_device, VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_pipeline));
+
+        VkDescriptorPoolSize poolSize {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 3};
+        VkDescriptorPoolCreateInfo poolInfo {};
+        poolInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+        poolInfo.maxSets = 1;
+        poolInfo.poolSizeCount = 1;
+        poolInfo.pPoolSizes = &poolSize;
+        VK_CHECK(vkCreateDescriptorPool(m_device, &poolInfo, nullptr, &m_descriptorPool));
+
+        VkDescriptorSetAllocateInfo setInfo {};
+
+        setInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+        setInfo.descriptorPool = m_descriptorPool;
+        setInfo.descriptorSetCount = 1;
+        setInfo.pSetLayouts = &m_descriptorSetLayout;
+        VK_CHECK(vkAllocateDescriptorSets(m_device, &setInfo, &m_descriptorSet));
+
+        VkCommandPoolCreateInfo commandPoolInfo {};
+
+        commandPoolInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+        commandPoolInfo.flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT;
+        commandPoolInfo.queueFamilyIndex = m_queueFamily;
+        VK_CHECK(vkCreateCommandPool(m_device, &commandPoolInfo, nullptr, &m_commandPool));
+
+        VkCommandBufferAllocateInfo commandBufferInfo {};
+
+        commandBufferInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+        commandBufferInfo.commandPool = m_commandPool;
+        commandBufferInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+        commandBufferInfo.commandBufferCount = 1;
+        VK_CHECK(vkAllocateCommandBuffers(m_device, &commandBufferInfo, &m_commandBuffer));
+
+        VkFenceCreateInfo fenceInfo {};
+
+        fenceInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+        VK_CHECK(vkCreateFence(m_device, &fenceInfo, nullptr, &m_fence));
+
+        if (m_timestamps) {
+            VkQueryPoolCreateInfo queryInfo {};
+            queryInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+            queryInfo.queryType = VK_QUERY_TYPE_TIMESTAMP;
+            queryInfo.queryCount = 2;
+            VK_CHECK(vkCreateQueryPool(m_device, &queryInfo, nullptr, &m_queryPool));
+        }
+
+        // A chunk must fit the storage buffer range, and so must a result buffer in which
+        // every position of the chunk matched.
+        VkDeviceSize range = limits.maxStorageBufferRange;
+        m_maxChunkSize = std::min((range - resultHeaderSize) / sizeof(std::uint32_t), maxChunkBytes) & ~VkDeviceSize(3);
+
+        ensureCapacity(m_pattern, 1, 64);
+        ensureCapacity(m_result, 2, resultHeaderSize + initialResultCapacity * sizeof(std::uint32_t));
+        m_resultCapacity = initialResultCapacity;
+        pipelineTimer.stop();
+    } catch (...) {
+        release();
+        throw;
+    }
+}
+
+VkSearchEngine::~VkSearchEngine() {
+    release();
+}
 
-// This function takes a full string ("haystack") and a substring ("needle"),
-// then uses a Vulkan compute shader to search for the first occurrence of needle.
-int vulkanStringSearch(const std::string &haystack, const std::string &needle) {
-    PROFILE_SCOPE("VkSearch");
-    int foundIndex = -1;
-    return foundIndex;
+/**
+ * @brief Returns the process-wide engine, creating it on first use.
+ */
+VkSearchEngine& VkSearchEngine::Get() {
+    static VkSearchEngine engine;
+    return engine;
 }
 
+/**
+ * @brief Destroys every Vulkan object created so far; safe on a partially constructed engine.
+ */
+void VkSearchEngine::release() {
+    if (m_device != VK_NULL_HANDLE) {
+        vkDeviceWaitIdle(m_device);
 
+        destroyBuffer(m_result);
+        destroyBuffer(m_pattern);
+        destroyBuffer(m_text);
+
+        vkDestroyQueryPool(m_device, m_queryPool, nullptr);
+        vkDestroyFence(m_device, m_fence, nullptr);
+        // frees the command buffer and descriptor set with them
+        vkDestroyCommandPool(m_device, m_commandPool, nullptr);
+        vkDestroyDescriptorPool(m_device, m_descriptorPool, nullptr);
+        vkDestroyPipeline(m_device, m_pipeline, nullptr);
+        vkDestroyPipelineLayout(m_device, m_pipelineLayout, nullptr);
+        vkDestroyDescriptorSetLayout(m_device, m_descriptorSetLayout, nullptr);
+        vkDestroyShaderModule(m_device, m_shader, nullptr);
+        vkDestroyDevice(m_device, nullptr);
+        m_device = VK_NULL_HANDLE;
+    }
+    if (m_instance != VK_NULL_HANDLE) {
+        vkDestroyInstance(m_instance, nullptr);
+        m_instance = VK_NULL_HANDLE;
+    }
+}
+
+/**
+ * @brief Returns the name of the selected physical device.
+ */
+std::string VkSearchEngine::deviceName() const {
+    return m_properties.deviceName;
+}
+
+/**
+ * @brief Finds all occurrences of a substring with the compute shader.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return A vector of all starting indices where `substr` was found in `str`, in
+ *         ascending order.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws std::runtime_error if a Vulkan call fails.
+ */
+std::vector<int> VkSearchEngine::findAll(std::string_view str, std::string_view substr) {
+    std::vector<int> results;
+    search(str, substr, false, results);
+    return results;
+}
+
+/**
+ * @brief Finds the first occurrence of a substring with the compute shader.
+ *
+ * @param[in] str     The input text to search in.
+ * @param[in] substr  The pattern to search for.
+ *
+ * @return The index of the first occurrence, or -1 if `substr` does not occur.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+ * @throws std::runtime_error if a Vulkan call fails.
+ */
+int VkSearchEngine::findFirst(std::string_view str, std::string_view substr) {
+    std::vector<int> unused;
+    return search(str, substr, true, unused);
+}
+
+/**
+ * @brief Searches `str` chunk by chunk, appending matches to `out` unless `firstOnly` is set.
+ *
+ * Each chunk is copied into the mapped text buffer and searched with one dispatch. When
+ * a chunk holds more matches than the result buffer has room for, the buffer grows to
+ * the reported count and the chunk is searched again.
+ *
+ * @return The first match, or -1 if there is none.
+ *
+ * @throws std::invalid_argument if `str` is longer than INT_MAX bytes or the pattern does
+ *         not fit in half a chunk.
+ */
+int VkSearchEngine::search(std::string_view str, std::string_view substr, bool firstOnly, std::vector<int>& out) {
+    if (str.length() > static_cast<std::size_t>(INT_MAX)) {
+        throw std::invalid_argument("Text must be at most INT_MAX bytes.");
+    }
+    if (substr.empty() || substr.length() > str.length()) {
+        return -1;
+    }
+    if (substr.length() > m_maxChunkSize / 2) {
+        throw std::invalid_argument("Pattern is too long for the device's storage buffer range.");
+    }
+
+    std::size_t overlap = substr.length() - 1;
+    std::size_t positions = str.length() - overlap;
+    std::size_t chunkPositions = m_maxChunkSize - overlap;
+
+    ensureCapacity(m_pattern, 1, roundUp4(substr.length()));
+    std::memcpy(m_pattern.mapped, substr.data(), substr.length());
+
+    int first = -1;
+    for (std::size_t start = 0; start < positions; start += chunkPositions) {
+        std::size_t chunkLength = std::min(chunkPositions, positions - start) + overlap;
+
+        Timer uploadTimer("Upload Text");
+        ensureCapacity(m_text, 0, roundUp4(chunkLength));
+        std::memcpy(m_text.mapped, str.data() + start, chunkLength);
+        uploadTimer.stop();
+
+        std::uint32_t found = dispatch(chunkLength, substr.length(), !firstOnly);
+        if (found == 0) {
+            continue;
+        }
+
+        const auto* header = static_cast<const std::uint32_t*>(m_result.mapped);
+        if (first < 0) {
+            first = static_cast<int>(start + header[1]);
+        }
+        if (firstOnly) {
+            break;
+        }
+
+        if (found > m_resultCapacity) {
+            ensureCapacity(m_result, 2, resultHeaderSize + VkDeviceSize(found) * sizeof(std::uint32_t));
+            m_resultCapacity = found;
+            dispatch(chunkLength, substr.length(), true);
+        }
+
+        Timer readTimer("Read Result");
+        // growing the result buffer remapped it, so `header` may be stale
+        const std::uint32_t* matches = static_cast<const std::uint32_t*>(m_result.mapped) + 2;
+        std::size_t offset = out.size();
+        out.resize(offset + found);
+        for (std::uint32_t i = 0; i < found; i++) {
+            out[offset + i] = static_cast<int>(start + matches[i]);
+        }
+        // appends arrive in no particular order
+        std::sort(out.begin() + offset, out.end());
+        readTimer.stop();
+    }
+
+    return first;
+}
+
+/**
+ * @brief Runs the shader over one chunk held in m_text and waits for it.
+ *
+ * Groups are laid out in two dimensions when the chunk needs more than
+ * maxComputeWorkGroupCount[0] of them. The device time between the two timestamps
+ * around the dispatch goes to the profiler as "GPU Exec".
+ *
+ * @return The number of matches the shader found, which may exceed the result capacity.
+ */
+std::uint32_t VkSearchEngine::dispatch(std::uint32_t textLen, std::uint32_t patternLen, bool collect) {
+    auto* header = static_cast<std::uint32_t*>(m_result.mapped);
+    header[0] = 0;
+    header[1] = noMatch;
+
+    PushConstants params {textLen, patternLen, m_resultCapacity, collect ? 1u : 0u};
+    std::uint32_t positions = textLen - patternLen + 1;
+    std::uint32_t groups = (positions + m_workGroupSize - 1) / m_workGroupSize;
+    std::uint32_t groupsX = std::min(groups, m_properties.limits.maxComputeWorkGroupCount[0]);
+    std::uint32_t groupsY = (groups + groupsX - 1) / groupsX;
+
+    VK_CHECK(vkResetCommandBuffer(m_commandBuffer, 0));
+    VkCommandBufferBeginInfo beginInfo {};
+    beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+    beginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+    VK_CHECK(vkBeginCommandBuffer(m_commandBuffer, &beginInfo));
+
+    if (m_timestamps) {
+        vkCmdResetQueryPool(m_commandBuffer, m_queryPool, 0, 2);
+        vkCmdWriteTimestamp(m_commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, m_queryPool, 0);
+    }
+    vkCmdBindPipeline(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipeline);
+    vkCmdBindDescriptorSets(m_commandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_pipelineLayout, 0, 1,
+                            &m_descriptorSet, 0, nullptr);
+    vkCmdPushConstants(m_commandBuffer, m_pipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(params), &params);
+    vkCmdDispatch(m_commandBuffer, groupsX, groupsY, 1);
+    if (m_timestamps) {
+        vkCmdWriteTimestamp(m_commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT, m_queryPool, 1);
+    }
+
+    // make the shader's writes to the result buffer visible to the host
+    VkMemoryBarrier barrier {};
+    barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+    barrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+    barrier.dstAccessMask = VK_ACCESS_HOST_READ_BIT;
+    vkCmdPipelineBarrier(m_commandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_HOST_BIT, 0,
+                         1, &barrier, 0, nullptr, 0, nullptr);
+    VK_CHECK(vkEndCommandBuffer(m_commandBuffer));
+
+    VkSubmitInfo submitInfo {};
+
+    submitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+    submitInfo.commandBufferCount = 1;
+    submitInfo.pCommandBuffers = &m_commandBuffer;
+    VK_CHECK(vkResetFences(m_device, 1, &m_fence));
+    VK_CHECK(vkQueueSubmit(m_queue, 1, &submitInfo, m_fence));
+    VK_CHECK(vkWaitForFences(m_device, 1, &m_fence, VK_TRUE, UINT64_MAX));
+
+    if (m_timestamps) {
+        std::uint64_t timestamps[2] {};
+        VK_CHECK(vkGetQueryPoolResults(m_device, m_queryPool, 0, 2, sizeof(timestamps), timestamps,
+                                       sizeof(std::uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT));
+        // only timestampValidBits are meaningful, so take the difference modulo that width
+        std::uint64_t ticks = (timestamps[1] - timestamps[0]) & m_timestampMask;
+        record_vk_time(0, ticks, m_properties.limits.timestampPeriod);
+    }
+
+    return header[0];
+}
+
+/**
+ * @brief Reallocates `buffer` when it holds fewer than `size` bytes and rebinds the descriptor set.
+ *
+ * The new buffer is mapped for its whole lifetime. Old contents are not preserved.
+ *
+ * @param[in,out] buffer   The buffer to grow.
+ * @param[in]     binding  The shader binding the buffer is attached to.
+ * @param[in]     size     The minimum size in bytes.
+ */
+void VkSearchEngine::ensureCapacity(Buffer& buffer, std::uint32_t binding, VkDeviceSize size) {
+    if (size <= buffer.capacity) {
+        return;
+    }
+    destroyBuffer(buffer);
+
+    VkBufferCreateInfo bufferInfo {};
+
+    bufferInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+    bufferInfo.size = size;
+    bufferInfo.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    bufferInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    VK_CHECK(vkCreateBuffer(m_device, &bufferInfo, nullptr, &buffer.buffer));
+
+    VkMemoryRequirements requirements;
+    vkGetBufferMemoryRequirements(m_device, buffer.buffer, &requirements);
+
+    VkMemoryAllocateInfo allocInfo {};
+
+    allocInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocInfo.allocationSize = requirements.size;
+    allocInfo.memoryTypeIndex = memoryTypeIndex(requirements.memoryTypeBits);
+    VK_CHECK(vkAllocateMemory(m_device, &allocInfo, nullptr, &buffer.memory));
+    VK_CHECK(vkBindBufferMemory(m_device, buffer.buffer, buffer.memory, 0));
+    VK_CHECK(vkMapMemory(m_device, buffer.memory, 0, VK_WHOLE_SIZE, 0, &buffer.mapped));
+    buffer.capacity = size;
+
+    VkDescriptorBufferInfo descriptorInfo {buffer.buffer, 0, VK_WHOLE_SIZE};
+    VkWriteDescriptorSet write {};
+    write.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    write.dstSet = m_descriptorSet;
+    write.dstBinding = binding;
+    write.descriptorCount = 1;
+    write.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+    write.pBufferInfo = &descriptorInfo;
+    vkUpdateDescriptorSets(m_device, 1, &write, 0, nullptr);
+}
+
+/**
+ * @brief Frees the buffer and its memory.
+ */
+void VkSearchEngine::destroyBuffer(Buffer& buffer) {
+    if (buffer.mapped) {
+        vkUnmapMemory(m_device, buffer.memory);
+    }
+    vkDestroyBuffer(m_device, buffer.buffer, nullptr);
+    vkFreeMemory(m_device, buffer.memory, nullptr);
+    buffer = Buffer {};
+}
+
+/**
+ * @brief Returns a memory type index with the required properties, preferring device-local memory.
+ *
+ * Buffers need host-visible, host-coherent memory so they can stay mapped without
+ * explicit flushes. Device-local host-visible memory (resizable BAR, unified memory)
+ * is taken when available.
+ *
+ * @throws std::runtime_error if no memory type is host-visible and host-coherent.
+ */
+std::uint32_t VkSearchEngine::memoryTypeIndex(std::uint32_t typeBits) const {
+    const VkMemoryPropertyFlags required = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT;
+    const VkMemoryPropertyFlags preferred = required | VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT;
+
+    for (VkMemoryPropertyFlags flags: {preferred, required}) {
+        for (std::uint32_t i = 0; i < m_memoryProperties.memoryTypeCount; i++) {
+            if ((typeBits & (1u << i)) && (m_memoryProperties.memoryTypes[i].propertyFlags & flags) == flags) {
+                return i;
+            }
+        }
+    }
+    throw std::runtime_error("No host-visible, host-coherent Vulkan memory type found.");
+}
+
+/**
+ * @brief Records the device time between two Vulkan timestamps.
+ *
+ * Converts the tick difference with the device's timestamp period and feeds it into
+ * the custom profiler as "GPU Exec", like record_cl_time does for OpenCL events.
+ *
+ * @param[in] start            First timestamp in ticks.
+ * @param[in] end              Second timestamp in ticks.
+ * @param[in] timestampPeriod  Nanoseconds per tick.
+ */
+void record_vk_time(std::uint64_t start, std::uint64_t end, float timestampPeriod) {
+    // microseconds, like record_cl_time
+    PROFILE_CUSTOM_TIME("GPU Exec", (end - start) * timestampPeriod / 1000.0f);
+}
+
+/**
+ * @brief Searches for the first occurrence of a substring using the Vulkan compute shader.
+ *
+ * Thin wrapper around VkSearchEngine::Get().findFirst().
+ *
+ * @param[in] haystack  The input text to search in.
+ * @param[in] needle    The pattern to search for.
+ *
+ * @return The index of the first occurrence, or -1 if `needle` does not occur.
+ */
+int vulkanStringSearch(std::string_view haystack, std::string_view needle) {
+    PROFILE_FUNCTION();
+    return VkSearchEngine::Get().findFirst(haystack, needle);
+}
+
+/**
+ * @brief Searches for all occurrences of a substring using the Vulkan compute shader.
+ *
+ * Thin wrapper around VkSearchEngine::Get().findAll().
+ *
+ * @param[in] haystack  The input text to search in.
+ * @param[in] needle    The pattern to search for.
+ *
+ * @return A vector of all starting indices where `needle` was found, in ascending order.
+ */
+std::vector<int> vulkanFindAll(std::string_view haystack, std::string_view needle) {
+    PROFILE_FUNCTION();
+    return VkSearchEngine::Get().findAll(haystack, needle);
+}
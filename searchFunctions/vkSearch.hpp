@@ -1,3 +1,190 @@
+#ifndef VK_SEARCH_HPP
+#define VK_SEARCH_HPP
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <vector>
+#include <vulkan/vulkan.h>
 
-int vulkanStringSearch(const std::string &haystack, const std::string &needle);
+/**
+ * @brief Long-lived Vulkan compute search engine.
+ *
+ * Creates the instance, device, compute pipeline, descriptor set, command buffer and
+ * timestamp query pool once and reuses them across calls. The find-all shader
+ * (searchFunctions/shaders/findAll.comp) is compiled to SPIR-V at build time and
+ * embedded in the binary. All buffers live in host-visible memory and stay mapped, so
+ * a query copies the text straight into the device buffer, records one dispatch and
+ * waits on a fence, with no staging copies. Any conformant driver works, including
+ * Mesa's lavapipe CPU implementation (select it with VK_ICD_FILENAMES on machines
+ * without a GPU).
+ *
+ * Texts larger than the device's storage buffer range are searched in chunks that
+ * overlap by the pattern length minus one. Offsets are returned as int, so texts are
+ * limited to INT_MAX bytes.
+ */
+class VkSearchEngine {
+public:
+    /**
+     * @brief Creates the instance and device and builds the compute pipeline.
+     *
+     * Discrete GPUs are preferred over integrated, virtual and CPU devices.
+     *
+     * @throws std::runtime_error if no device with a compute queue exists or a Vulkan call fails.
+     */
+    VkSearchEngine();
+
+    ~VkSearchEngine();
+
+    VkSearchEngine(const VkSearchEngine&) = delete;
+    VkSearchEngine& operator=(const VkSearchEngine&) = delete;
+
+    /**
+     * @brief Returns the process-wide engine, creating it on first use.
+     */
+    static VkSearchEngine& Get();
+
+    /**
+     * @brief Finds all occurrences of a substring with the compute shader.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     *
+     * @return A vector of all starting indices where `substr` was found in `str`, in
+     *         ascending order.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     * @throws std::runtime_error if a Vulkan call fails.
+     */
+    std::vector<int> findAll(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Finds the first occurrence of a substring with the compute shader.
+     *
+     * @param[in] str     The input text to search in.
+     * @param[in] substr  The pattern to search for.
+     *
+     * @return The index of the first occurrence, or -1 if `substr` does not occur.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     * @throws std::runtime_error if a Vulkan call fails.
+     */
+    int findFirst(std::string_view str, std::string_view substr);
+
+    /**
+     * @brief Returns the name of the selected physical device.
+     */
+    std::string deviceName() const;
+
+private:
+    struct Buffer {
+        VkBuffer buffer = VK_NULL_HANDLE;
+        VkDeviceMemory memory = VK_NULL_HANDLE;
+        void* mapped = nullptr;
+        VkDeviceSize capacity = 0;
+    };
+
+    /**
+     * @brief Destroys every Vulkan object created so far; safe on a partially constructed engine.
+     */
+    void release();
+
+    /**
+     * @brief Searches `str` chunk by chunk, appending matches to `out` unless `firstOnly` is set.
+     *
+     * @return The first match, or -1 if there is none.
+     *
+     * @throws std::invalid_argument if `str` is longer than INT_MAX bytes.
+     */
+    int search(std::string_view str, std::string_view substr, bool firstOnly, std::vector<int>& out);
+
+    /**
+     * @brief Runs the shader over one chunk held in m_text and waits for it.
+     *
+     * @return The number of matches the shader found, which may exceed the result capacity.
+     */
+    std::uint32_t dispatch(std::uint32_t textLen, std::uint32_t patternLen, bool collect);
+
+    /**
+     * @brief Reallocates `buffer` when it holds fewer than `size` bytes and rebinds the descriptor set.
+     */
+    void ensureCapacity(Buffer& buffer, std::uint32_t binding, VkDeviceSize size);
+
+    /**
+     * @brief Frees the buffer and its memory.
+     */
+    void destroyBuffer(Buffer& buffer);
+
+    /**
+     * @brief Returns a memory type index with the required properties, preferring device-local memory.
+     */
+    std::uint32_t memoryTypeIndex(std::uint32_t typeBits) const;
+
+private:
+    VkInstance m_instance = VK_NULL_HANDLE;
+    VkPhysicalDevice m_physicalDevice = VK_NULL_HANDLE;
+    VkPhysicalDeviceProperties m_properties {};
+    VkPhysicalDeviceMemoryProperties m_memoryProperties {};
+    VkDevice m_device = VK_NULL_HANDLE;
+    std::uint32_t m_queueFamily = 0;
+    VkQueue m_queue = VK_NULL_HANDLE;
+    bool m_timestamps = false;
+    std::uint64_t m_timestampMask = 0;
+
+    VkShaderModule m_shader = VK_NULL_HANDLE;
+    VkDescriptorSetLayout m_descriptorSetLayout = VK_NULL_HANDLE;
+    VkPipelineLayout m_pipelineLayout = VK_NULL_HANDLE;
+    VkPipeline m_pipeline = VK_NULL_HANDLE;
+    VkDescriptorPool m_descriptorPool = VK_NULL_HANDLE;
+    VkDescriptorSet m_descriptorSet = VK_NULL_HANDLE;
+    VkCommandPool m_commandPool = VK_NULL_HANDLE;
+    VkCommandBuffer m_commandBuffer = VK_NULL_HANDLE;
+    VkFence m_fence = VK_NULL_HANDLE;
+    VkQueryPool m_queryPool = VK_NULL_HANDLE;
+    std::uint32_t m_workGroupSize = 0;
+    VkDeviceSize m_maxChunkSize = 0;
+
+    Buffer m_text;
+    Buffer m_pattern;
+    Buffer m_result;
+    // matches the result buffer has room for, behind its two header words
+    std::uint32_t m_resultCapacity = 0;
+};
+
+/**
+ * @brief Records the device time between two Vulkan timestamps.
+ *
+ * Converts the tick difference with the device's timestamp period and feeds it into
+ * the custom profiler as "GPU Exec", like record_cl_time does for OpenCL events.
+ *
+ * @param[in] start            First timestamp in ticks.
+ * @param[in] end              Second timestamp in ticks.
+ * @param[in] timestampPeriod  Nanoseconds per tick.
+ */
+void record_vk_time(std::uint64_t start, std::uint64_t end, float timestampPeriod);
+
+/**
+ * @brief Searches for the first occurrence of a substring using the Vulkan compute shader.
+ *
+ * Thin wrapper around VkSearchEngine::Get().findFirst().
+ *
+ * @param[in] haystack  The input text to search in.
+ * @param[in] needle    The pattern to search for.
+ *
+ * @return The index of the first occurrence, or -1 if `needle` does not occur.
+ */
+int vulkanStringSearch(std::string_view haystack, std::string_view needle);
+
+/**
+ * @brief Searches for all occurrences of a substring using the Vulkan compute shader.
+ *
+ * Thin wrapper around VkSearchEngine::Get().findAll().
+ *
+ * @param[in] haystack  The input text to search in.
+ * @param[in] needle    The pattern to search for.
+ *
+ * @return A vector of all starting indices where `needle` was found, in ascending order.
+ */
+std::vector<int> vulkanFindAll(std::string_view haystack, std::string_view needle);
+
+#endif // VK_SEARCH_HPP
@@ -0,0 +1,137 @@
+/**
+ * @file streamSearch.cpp
+ * @brief Implementation file for the StreamSearcher class.
+ */
+
+#include "streamSearch.hpp"
+#include "readAhead.hpp"
+#include "performance-analyzer/performance-analyzer.hpp"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+
+// block buffers and sizes are aligned for O_DIRECT, which needs logical block alignment
+const std::size_t ioAlignment = 4096;
+
+/**
+ * @brief Rounds `value` up to the next multiple of `multiple`.
+ */
+std::size_t roundUp(std::size_t value, std::size_t multiple) {
+    return ((value + multiple - 1) / multiple) * multiple;
+}
+
+/**
+ * @brief Frees memory allocated with the aligned operator new[].
+ */
+struct AlignedDelete {
+    void operator()(char* data) const {
+        ::operator delete[](data, std::align_val_t(ioAlignment));
+    }
+};
+
+} // namespace
+
+/**
+ * @brief Constructs a searcher running `search` on every block.
+ *
+ * @param search Find-all function returning ascending match positions in its input.
+ * @param options Block layout and I/O hints.
+ *
+ * @throws std::invalid_argument if the block size is 0 or there are fewer than 2 blocks.
+ */
+StreamSearcher::StreamSearcher(SearchFunction search, StreamSearchOptions options)
+: m_search(std::move(search)), m_options(options) {
+    if (m_options.blockSize == 0 || m_options.blockCount < 2) {
+        throw std::invalid_argument("Stream search needs a non-zero block size and at least 2 blocks.");
+    }
+    m_options.blockSize = roundUp(m_options.blockSize, ioAlignment);
+}
+
+/**
+ * @brief Searches a file, a named pipe or, for "-", stdin.
+ *
+ * @param fileName The input to search.
+ * @param needle The pattern to search for; an empty needle has no matches.
+ * @param onMatch Called with the absolute offset of every match, in ascending order.
+ *
+ * @return The number of matches.
+ *
+ * @throws std::runtime_error if the input cannot be opened or read.
+ */
+std::uint64_t StreamSearcher::searchFile(const std::string& fileName, std::string_view needle,
+                                         const MatchCallback& onMatch) const {
+    PROFILE_FUNCTION();
+    if (needle.empty()) {
+        return 0;
+    }
+
+    InputFile input(fileName, InputFileOptions{m_options.directIo, true});
+    return search([&input](char* buffer, std::size_t size) { return input.read(buffer, size); },
+                  needle, onMatch);
+}
+
+/**
+ * @brief Runs the reader thread and the block searches over one input.
+ *
+ * Block k lives in slot k % blockCount of a readAhead() ring. Each slot reserves room
+ * in front of its block for the carried bytes, so the carry is prepended with one small
+ * copy and the block is searched in place. A short block ends the input.
+ *
+ * @param read Fills up to the given number of bytes, returning fewer only at the end of the input.
+ * @param needle The pattern to search for, not empty.
+ * @param onMatch Called with the absolute offset of every match, in ascending order.
+ *
+ * @return The number of matches.
+ */
+std::uint64_t StreamSearcher::search(const ReadFunction& read, std::string_view needle,
+                                     const MatchCallback& onMatch) const {
+    const std::size_t blockSize = m_options.blockSize;
+    const std::size_t blockCount = m_options.blockCount;
+    const std::size_t carryLength = needle.length() - 1;
+    // the carry area keeps every block start aligned
+    const std::size_t carryCapacity = roundUp(carryLength, ioAlignment);
+    const std::size_t slotSize = carryCapacity + blockSize;
+
+    std::unique_ptr<char[], AlignedDelete> storage(
+        static_cast<char*>(::operator new[](slotSize * blockCount, std::align_val_t(ioAlignment))));
+    auto blockData = [&](std::size_t block) {
+        return storage.get() + (block % blockCount) * slotSize + carryCapacity;
+    };
+    // written by the reader before a block is handed over, read by the search after
+    std::vector<std::size_t> lengths(blockCount, 0);
+
+    std::uint64_t matchCount = 0;
+    std::string carry;
+    // absolute offset of the first byte of the current window, carry included
+    std::uint64_t windowStart = 0;
+    readAhead(blockCount, [&](std::size_t block) {
+        std::size_t length = read(blockData(block), blockSize);
+        lengths[block % blockCount] = length;
+        return length == blockSize;
+    }, [&](std::size_t block) {
+        std::size_t length = lengths[block % blockCount];
+        char* window = blockData(block) - carry.length();
+        std::memcpy(window, carry.data(), carry.length());
+        std::string_view view(window, carry.length() + length);
+
+        if (view.length() >= needle.length()) {
+            std::vector<int> positions = m_search(view, needle);
+            for (int position: positions) {
+                onMatch(windowStart + position);
+            }
+            matchCount += positions.size();
+        }
+
+        // no match fits in the carried bytes alone, so none is reported twice
+        std::size_t keep = std::min(carryLength, view.length());
+        carry.assign(view.substr(view.length() - keep));
+        windowStart += view.length() - keep;
+    });
+    return matchCount;
+}
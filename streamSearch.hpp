@@ -0,0 +1,88 @@
+/*
+ * streamSearch.hpp declares StreamSearcher, which runs a find-all function over files,
+ * pipes and stdin block by block, so inputs of any size are searched in constant memory.
+ */
+
+#ifndef STREAMSEARCH_HPP
+#define STREAMSEARCH_HPP
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+/**
+ * @brief Block layout and I/O hints of a StreamSearcher.
+ */
+struct StreamSearchOptions {
+    // bytes read per block, rounded up to a multiple of the 4 KiB I/O alignment
+    std::size_t blockSize = 16 * 1024 * 1024;
+    // blocks in the ring buffer; the reader runs up to blockCount - 1 blocks ahead of the search
+    std::size_t blockCount = 3;
+    // read regular files with O_DIRECT, bypassing the page cache; falls back to buffered
+    // reads where the platform or file system does not support it
+    bool directIo = false;
+};
+
+/**
+ * @brief Streams an input through a ring of fixed-size blocks and searches each block.
+ *
+ * A reader thread fills the blocks while the calling thread searches the previous
+ * ones, so reading and searching overlap. Every block is preceded in memory by the
+ * last `needle.length() - 1` bytes of the data before it, so matches straddling a
+ * block boundary are found exactly once. Matches are reported as they are found,
+ * with their absolute offset in the input.
+ *
+ * Memory use is blockCount blocks plus the carried bytes and the result list of one
+ * block, independent of the input size. Buffered reads advise the kernel that the
+ * input is read sequentially and drop the consumed pages from the page cache.
+ */
+class StreamSearcher {
+public:
+    // any find-all function, e.g. one registered as a MultiReturnFunction
+    using SearchFunction = std::function<std::vector<int>(std::string_view, std::string_view)>;
+    using MatchCallback = std::function<void(std::uint64_t)>;
+
+    /**
+    * @brief Constructs a searcher running `search` on every block.
+    *
+    * @param search Find-all function returning ascending match positions in its input.
+    * @param options Block layout and I/O hints.
+    *
+    * @throws std::invalid_argument if the block size is 0 or there are fewer than 2 blocks.
+    */
+    explicit StreamSearcher(SearchFunction search, StreamSearchOptions options = {});
+
+    /**
+    * @brief Searches a file, a named pipe or, for "-", stdin.
+    *
+    * @param fileName The input to search.
+    * @param needle The pattern to search for; an empty needle has no matches.
+    * @param onMatch Called with the absolute offset of every match, in ascending order.
+    *
+    * @return The number of matches.
+    *
+    * @throws std::runtime_error if the input cannot be opened or read.
+    */
+    std::uint64_t searchFile(const std::string& fileName, std::string_view needle,
+                             const MatchCallback& onMatch) const;
+
+    const StreamSearchOptions& options() const { return m_options; }
+
+private:
+    using ReadFunction = std::function<std::size_t(char*, std::size_t)>;
+
+    /**
+    * @brief Runs the reader thread and the block searches over one input.
+    *
+    * @param read Fills up to the given number of bytes, returning fewer only at the end of the input.
+    */
+    std::uint64_t search(const ReadFunction& read, std::string_view needle, const MatchCallback& onMatch) const;
+
+private:
+    SearchFunction m_search;
+    StreamSearchOptions m_options;
+};
+
+#endif // STREAMSEARCH_HPP